@@ -28,10 +28,12 @@
 #include <iostream>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <boost/filesystem.hpp>
 
 #include "utils/data_collector.hpp"
 #include "dmrg/utils/DmrgOptions.h"
 #include "dmrg/utils/DmrgParameters.h"
+#include "dmrg/utils/parallel/utils.hpp"
 #include "utils/timings.h"
 
 #include "simulation.h"
@@ -39,6 +41,8 @@
 
 int main(int argc, char ** argv)
 {
+    parallel::environment mpi_env(argc, argv);
+
     std::cout << "  QCMaquis - Quantum Chemical Density Matrix Renormalization group\n"
               << "  available from http://www.reiher.ethz.ch/software\n"
               << "  based on the ALPS MPS codes from http://alps.comp-phys.org/\n"
@@ -51,6 +55,11 @@ int main(int argc, char ** argv)
     DmrgOptions opt(argc, argv);
     if (opt.valid) {
         maquis::cout.precision(10);
+
+        // all ranks run the same simulation, only the master writes the result file
+        std::string rfile = opt.parms["resultfile"].str();
+        if (!parallel::master())
+            opt.parms.set("resultfile", rfile + ".rank" + parallel::rank_str());
         
         DCOLLECTOR_SET_SIZE(gemm_collector, opt.parms["max_bond_dimension"]+1)
         DCOLLECTOR_SET_SIZE(svd_collector, opt.parms["max_bond_dimension"]+1)
@@ -74,6 +83,9 @@ int main(int argc, char ** argv)
         DCOLLECTOR_SAVE_TO_FILE(svd_collector, "collectors.h5", "/results")
         
         maquis::cout << "Task took " << elapsed << " seconds." << std::endl;
+
+        if (!parallel::master())
+            boost::filesystem::remove(opt.parms["resultfile"].str());
     }
 }
 
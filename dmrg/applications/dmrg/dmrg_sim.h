@@ -38,6 +38,8 @@
 
 #include "dmrg/sim/sim.h"
 #include "dmrg/optimize/optimize.h"
+#include "dmrg/utils/tracing.h"
+#include "dmrg/utils/parallel/utils.hpp"
 #include "dmrg/models/chem/measure_transform.hpp"
 
 #include "dmrg_sim.fwd.h"
@@ -76,13 +78,29 @@ public:
                             std::shared_ptr<sim<Matrix, SymmGroup>> bra_ptr = NULL
                            );
 
+    /// Streams the labelled results to visit, without a copy and without writing the result file
+    void measure_observable(std::string const& name_,
+                            typename measurement<Matrix, SymmGroup>::visitor_type const& visit,
+                            std::shared_ptr<sim<Matrix, SymmGroup>> bra_ptr = NULL
+                           );
+
     double get_energy();
 
 private:
     std::string results_archive_path(int sweep) const;
+    entanglement_spectrum_type const* recorded_spectra() const;
+    double energy(MPO<Matrix, SymmGroup> const& mpoc);
+    template <class Extract>
+    void evaluate_observable(std::string const& name_, std::string const& bra,
+                             std::shared_ptr<sim<Matrix, SymmGroup>> bra_ptr, Extract extract);
     void checkpoint_simulation(MPS<Matrix, SymmGroup> const& state, int sweep, int site);
 
     double emin;
+
+    // optimizer of the last run, kept to measure the energy from its final boundaries
+    boost::shared_ptr<opt_base_t> optimizer;
+    // spectra of the last sweep while measure_all evaluates them without the optimizer
+    entanglement_spectrum_type final_spectra;
 };
 
 #endif
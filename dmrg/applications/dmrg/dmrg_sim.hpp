@@ -43,8 +43,14 @@ void dmrg_sim<Matrix, SymmGroup>::run()
     // turn of output for boundary init and ts_mpo
     if (parms["verbosity"] == 0) maquis::silence();
     
+    // every rank traces its own work, into its own file
+    std::string trace_file = parms["trace_file"].str();
+    tracing::enable(!trace_file.empty());
+    if (!trace_file.empty() && parallel::size() > 1)
+        trace_file += ".rank" + parallel::rank_str();
+
     /// Optimizer initialization
-    boost::shared_ptr<opt_base_t> optimizer;
+    optimizer.reset();
     if (parms["optimization"] == "singlesite")
     {
         optimizer.reset( new ss_optimize<Matrix, SymmGroup, storage::Controller>
@@ -77,6 +83,9 @@ void dmrg_sim<Matrix, SymmGroup>::run()
             optimizer->sweep(sweep, Both);
             storage::Controller::sync();
 
+            if (!trace_file.empty())
+                tracing::append_chrome_trace(trace_file, parallel::rank());
+
             emin          = minIterationEnergy(optimizer->iteration_results());
             double e_diff = std::abs(emin - emin_prev);
             emin_prev     = emin;
@@ -127,23 +136,32 @@ void dmrg_sim<Matrix, SymmGroup>::run()
             ar[results_archive_path(e.sweep()) + "/results"] << optimizer->iteration_results();
             // ar[results_archive_path(e.sweep()) + "/results/Runtime/mean/value"] << std::vector<double>(1, elapsed_sweep + elapsed_measure);
         }
+
+        // interrupted mid-sweep, the boundaries do not match the state
+        optimizer.reset();
     }
 }
 
 template <class Matrix, class SymmGroup>
 void dmrg_sim<Matrix, SymmGroup>::measure_all()
 {
-    this->measure("/spectrum/results/", all_measurements);
-
     /// MPO creation
     MPO<Matrix, SymmGroup> mpoc = mpo;
     if (parms["use_compressed"])
         mpoc.compress(1e-12);
 
-    double energy;
+    // the energy comes from the boundaries of the last sweep, the measurements re-gauge the MPS
+    double energy = 0.;
+    if (parms["MEASURE[Energy]"] || parms["MEASURE[EnergyVariance]"] > 0)
+        energy = this->energy(mpoc);
+    if (optimizer)
+        final_spectra = optimizer->bond_spectra();
+    optimizer.reset();
+
+    this->measure("/spectrum/results/", all_measurements);
+    final_spectra.clear();
 
     if (parms["MEASURE[Energy]"]) {
-        energy = maquis::real(expval(mps, mpoc)) + maquis::real(mpoc.getCoreEnergy());
         maquis::cout << "Energy: " << energy << std::endl;
         {
             storage::archive ar(rfile, "w");
@@ -152,11 +170,7 @@ void dmrg_sim<Matrix, SymmGroup>::measure_all()
     }
 
     if (parms["MEASURE[EnergyVariance]"] > 0) {
-        MPO<Matrix, SymmGroup> mpo2 = square_mpo(mpoc);
-        mpo2.compress(1e-12);
-
-        if (!parms["MEASURE[Energy]"]) energy = maquis::real(expval(mps, mpoc)) + maquis::real(mpoc.getCoreEnergy());
-        double energy2 = maquis::real(expval(mps, mpo2, true));
+        double energy2 = maquis::real(expval_square(mps, mpoc));
 
         maquis::cout << "Energy^2: " << energy2 << std::endl;
         maquis::cout << "Variance: " << energy2 - energy*energy << std::endl;
@@ -174,6 +188,15 @@ void dmrg_sim<Matrix, SymmGroup>::measure_all()
     #endif
 }
 
+template <class Matrix, class SymmGroup>
+entanglement_spectrum_type const* dmrg_sim<Matrix, SymmGroup>::recorded_spectra() const
+{
+    // the optimizer is dropped whenever the mps changes outside of a sweep
+    if (optimizer)
+        return &optimizer->bond_spectra();
+    return final_spectra.empty() ? NULL : &final_spectra;
+}
+
 template <class Matrix, class SymmGroup>
 dmrg_sim<Matrix, SymmGroup>::~dmrg_sim()
 {
@@ -181,12 +204,14 @@ dmrg_sim<Matrix, SymmGroup>::~dmrg_sim()
 }
 
 template <class Matrix, class SymmGroup>
-void dmrg_sim<Matrix, SymmGroup>::measure_observable(std::string const & name_,
-                                                     std::vector<typename Matrix::value_type> & results,
-                                                     std::vector<std::vector<Lattice::pos_t> > & labels,
-                                                     std::string const & bra,
-                                                     std::shared_ptr<sim<Matrix, SymmGroup>> bra_ptr)
+template <class Extract>
+void dmrg_sim<Matrix, SymmGroup>::evaluate_observable(std::string const & name_,
+                                                      std::string const & bra,
+                                                      std::shared_ptr<sim<Matrix, SymmGroup>> bra_ptr,
+                                                      Extract extract)
 {
+    // changes the gauge of the MPS, the boundaries of the optimizer become invalid
+    optimizer.reset();
     mps.normalize_left();
     for (typename measurements_type::iterator it = all_measurements.begin(); it != all_measurements.end(); ++it)
     {
@@ -197,17 +222,49 @@ void dmrg_sim<Matrix, SymmGroup>::measure_observable(std::string const & name_,
                 it->evaluate(mps, boost::none, bra, dynamic_cast<dmrg_sim<Matrix, SymmGroup>*>(bra_ptr.get())->mps);
             else
                 it->evaluate(mps, boost::none, bra);
-            it->extract(results, labels);
-
-            if (parms["keep_files"])
-            {
-                storage::archive ar(rfile, "w");
-                ar["/spectrum/results"] << *it;
-            }
+            extract(*it);
         }
     }
 }
 
+template <class Matrix, class SymmGroup>
+void dmrg_sim<Matrix, SymmGroup>::measure_observable(std::string const & name_,
+                                                     std::vector<typename Matrix::value_type> & results,
+                                                     std::vector<std::vector<Lattice::pos_t> > & labels,
+                                                     std::string const & bra,
+                                                     std::shared_ptr<sim<Matrix, SymmGroup>> bra_ptr)
+{
+    evaluate_observable(name_, bra, bra_ptr, [&](measurement<Matrix, SymmGroup> & meas)
+    {
+        meas.extract(results, labels);
+
+        if (parms["keep_files"])
+        {
+            storage::archive ar(rfile, "w");
+            ar["/spectrum/results"] << meas;
+        }
+    });
+}
+
+template <class Matrix, class SymmGroup>
+void dmrg_sim<Matrix, SymmGroup>::measure_observable(std::string const & name_,
+                                                     typename measurement<Matrix, SymmGroup>::visitor_type const & visit,
+                                                     std::shared_ptr<sim<Matrix, SymmGroup>> bra_ptr)
+{
+    evaluate_observable(name_, std::string(), bra_ptr,
+                        [&](measurement<Matrix, SymmGroup> & meas) { meas.extract(visit); });
+}
+
+template <class Matrix, class SymmGroup>
+double dmrg_sim<Matrix, SymmGroup>::energy(MPO<Matrix, SymmGroup> const& mpoc)
+{
+    // the boundaries of the optimizer belong to the uncompressed MPO
+    if (optimizer && !parms["use_compressed"])
+        return maquis::real(optimizer->boundary_expval()) + maquis::real(mpo.getCoreEnergy());
+    else
+        return maquis::real(expval(mps, mpoc)) + maquis::real(mpoc.getCoreEnergy());
+}
+
 template <class Matrix, class SymmGroup>
 double dmrg_sim<Matrix, SymmGroup>::get_energy()
 {
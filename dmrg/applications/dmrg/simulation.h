@@ -28,12 +28,15 @@
 #define MAQUIS_SIM_RUN_H
 
 #include <memory>
+#include <functional>
 
 #include "dmrg/sim/matrix.fwd.h"
 #include "../dmrg/dmrg_sim.fwd.h"
 
 class FrontEndBase {
 public:
+    typedef std::function<void(std::vector<int> const&, double)> visitor_type;
+
     virtual ~FrontEndBase() {}
     virtual void run() =0;
 
@@ -43,6 +46,10 @@ public:
                                     std::vector<double> & results, std::vector<std::vector<int> > & labels,
                                     std::string bra, std::shared_ptr<FrontEndBase> bra_ptr = NULL) =0;
 
+    /// Streams (labels, value) of each result to visit, skipping the result file
+    virtual void measure_observable(std::string name, visitor_type const & visit,
+                                    std::shared_ptr<FrontEndBase> bra_ptr = NULL) =0;
+
     virtual double get_energy() =0;
 
     virtual std::string getParm(const std::string&) =0;
@@ -66,6 +73,9 @@ public:
                             std::string bra,
                             std::shared_ptr<FrontEndBase> bra_ptr = NULL);
 
+    void measure_observable(std::string name, visitor_type const & visit,
+                            std::shared_ptr<FrontEndBase> bra_ptr = NULL);
+
     double get_energy();
 
     std::string getParm(const std::string& key);
@@ -68,6 +68,16 @@ void SimFrontEnd<Matrix, SymmGroup>::measure_observable(std::string name,
         sim_ptr->measure_observable(name, results, labels, bra);
 }
 
+template <class Matrix, class SymmGroup>
+void SimFrontEnd<Matrix, SymmGroup>::measure_observable(std::string name, visitor_type const & visit,
+                                                        std::shared_ptr<FrontEndBase> bra_ptr)
+{
+    if (bra_ptr)
+        sim_ptr->measure_observable(name, visit, std::dynamic_pointer_cast<SimFrontEnd<Matrix, SymmGroup>>(bra_ptr)->sim_ptr);
+    else
+        sim_ptr->measure_observable(name, visit);
+}
+
 template <class Matrix, class SymmGroup>
 double SimFrontEnd<Matrix, SymmGroup>::get_energy()
 {
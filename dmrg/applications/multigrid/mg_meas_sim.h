@@ -119,10 +119,7 @@ public:
         }
         
         if (parms["MEASURE[EnergyVariance]"] > 0) {
-            MPO<Matrix, SymmGroup> mpo2 = square_mpo(mpo);
-            mpo2.compress(1e-12);
-            
-            double energy2 = maquis::real(expval(mps, mpo2, true));
+            double energy2 = maquis::real(expval_square(mps, mpo));
             
             maquis::cout << "Energy^2: " << energy2 << std::endl;
             maquis::cout << "Variance: " << energy2 - energy*energy << std::endl;
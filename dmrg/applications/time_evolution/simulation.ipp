@@ -29,6 +29,7 @@
 #include "tevol_sim.h"
 #include "dmrg/evolve/tevol_nn_sim.h"
 #include "dmrg/evolve/tevol_mpo_sim.h"
+#include "dmrg/evolve/tevol_tdvp_sim.h"
 #include "dmrg/evolve/tevol_circuit_sim.h"
 #include "simulation.h"
 
@@ -45,6 +46,8 @@ void simulation<Matrix, SymmGroup>::run(DmrgParameters & parms)
         sim.reset(new tevol_sim<Matrix, SymmGroup, mpo_evolver<Matrix, SymmGroup> >(parms));
     else if (parms["te_type"] == "circuit")
         sim.reset(new tevol_sim<Matrix, SymmGroup, circuit_evolver<Matrix, SymmGroup> >(parms));
+    else if (parms["te_type"] == "tdvp")
+        sim.reset(new tevol_sim<Matrix, SymmGroup, tdvp_evolver<Matrix, SymmGroup> >(parms));
 
     /// Run
     sim->run();
@@ -32,6 +32,10 @@
 #include <iostream>
 
 #include <vector>
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+#include <iterator>
 #include <boost/lexical_cast.hpp>
 
 #include "dmrg/utils/DmrgParameters.h"
@@ -136,6 +140,133 @@ typename Matrix::value_type extract_coefficient(MPS<Matrix, SymmGroup> const & m
     return coeff(0,0);
 }
 
+/// Coefficients of many determinants. The row vector of partial products is kept for
+/// every site of the previous determinant, so a query only multiplies the sites after the
+/// prefix it shares with the previous one. Queries in lexicographic order walk the
+/// determinant trie depth first and touch every unique prefix once.
+template <class Matrix, class SymmGroup>
+class ci_extractor
+{
+    typedef typename SymmGroup::charge charge;
+    typedef typename Matrix::value_type value_type;
+
+public:
+    ci_extractor(MPS<Matrix, SymmGroup> const & mps_)
+    : mps(mps_)
+    , rows(mps_.length()+1)
+    , sectors(mps_.length()+1)
+    , valid(0)
+    {
+        for (std::size_t p = 0; p < mps.length(); ++p) {
+            mps[p].make_left_paired();
+            left_pb.push_back(ProductBasis<SymmGroup>(mps[p].site_dim(), mps[p].row_dim()));
+        }
+        rows[0] = std::vector<value_type>(1, 1.);
+        sectors[0] = mps[0].row_dim()[0].first;
+        target = mps[mps.length()-1].col_dim()[0].first;
+    }
+
+    value_type operator()(std::vector<charge> const & det)
+    {
+        std::size_t L = mps.length();
+        if (L != det.size())
+            throw std::runtime_error("extract_coefficient: length of mps != length of basis state\n");
+
+        charge total = std::accumulate(det.begin(), det.end(), SymmGroup::IdentityCharge);
+        if (total != target) {
+            std::stringstream ss;
+            std::copy(det.begin(), det.end(), std::ostream_iterator<charge>(ss, " "));
+            ss << " (Has: " << total << ", should be: " << target << ")\n";
+            throw std::runtime_error("Determinant has wrong number of up/down electrons: " + ss.str());
+        }
+
+        std::size_t p = 0;
+        while (p < valid && det[p] == prev[p]) ++p;
+
+        prev = det;
+        for (; p < L; ++p)
+            if (!step(p, det[p])) {
+                valid = p;
+                return 0.0;
+            }
+
+        valid = L;
+        return rows[L][0];
+    }
+
+private:
+    // rows[p+1] = rows[p] * (rows of site p selected by site_charge)
+    bool step(std::size_t p, charge site_charge)
+    {
+        MPSTensor<Matrix, SymmGroup> const & site = mps[p];
+        if (! site.site_dim().has(site_charge))
+            return false;
+
+        charge left_input = sectors[p];
+        charge sector = SymmGroup::fuse(left_input, site_charge);
+
+        // search the DualIndex directly, left_basis() would build a copy
+        DualIndex<SymmGroup> const & basis = site.data().basis();
+        typename DualIndex<SymmGroup>::const_iterator it = basis.left_lower_bound(sector);
+        if (it == basis.end() || it->lc != sector)
+            return false;
+        Matrix const & sector_matrix = site.data()[it - basis.begin()];
+
+        std::size_t voffset = left_pb[p](site_charge, left_input);
+        std::vector<value_type> const & in = rows[p];
+        std::vector<value_type> & out = rows[p+1];
+
+        out.resize(num_cols(sector_matrix));
+        for (std::size_t j = 0; j < out.size(); ++j) {
+            value_type sum = 0.;
+            for (std::size_t r = 0; r < in.size(); ++r)
+                sum += in[r] * sector_matrix(voffset+r, j);
+            out[j] = sum;
+        }
+        sectors[p+1] = sector;
+        return true;
+    }
+
+    MPS<Matrix, SymmGroup> const & mps;
+    std::vector<ProductBasis<SymmGroup> > left_pb;
+    charge target;
+
+    std::vector<charge> prev;
+    std::vector<std::vector<value_type> > rows;
+    std::vector<charge> sectors;
+    std::size_t valid; // rows[0..valid] belong to the prefix of prev
+};
+
+/// Coefficients of all determinants, in input order. The determinants are visited in
+/// lexicographic order, chunks of that order are distributed over the threads.
+template <class Matrix, class SymmGroup>
+std::vector<typename Matrix::value_type>
+extract_coefficients(MPS<Matrix, SymmGroup> const & mps,
+                     std::vector<std::vector<typename SymmGroup::charge> > const & dets)
+{
+    std::vector<std::size_t> order(dets.size());
+    for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(),
+              [&dets](std::size_t a, std::size_t b) { return dets[a] < dets[b]; });
+
+    for (std::size_t p = 0; p < mps.length(); ++p)
+        mps[p].make_left_paired();
+
+    std::vector<typename Matrix::value_type> ret(dets.size());
+    #ifdef MAQUIS_OPENMP
+    #pragma omp parallel
+    #endif
+    {
+        ci_extractor<Matrix, SymmGroup> coefficient(mps);
+        #ifdef MAQUIS_OPENMP
+        #pragma omp for schedule(dynamic, 256)
+        #endif
+        for (std::size_t i = 0; i < order.size(); ++i)
+            ret[order[i]] = coefficient(dets[order[i]]);
+    }
+    return ret;
+}
+
 template <class Matrix, class SymmGroup>
 void set_coefficient(MPS<Matrix, SymmGroup> & mps, std::vector<typename SymmGroup::charge> const & det, typename Matrix::value_type coefficient)
 {
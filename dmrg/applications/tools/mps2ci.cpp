@@ -52,18 +52,15 @@ using std::endl;
 typedef TwoU1PG grp; 
 
 /*
-    Small function to read determinants from a input file
+    Small function to read up to max_dets determinants from a input file
 */
 template<class Matrix, class SymmGroup>
 std::vector<std::vector<typename SymmGroup::charge> >
-parse_config(std::string file, std::vector<Index<SymmGroup> > const & site_dims)
+parse_config(std::istream & config_file, std::vector<Index<SymmGroup> > const & site_dims, std::size_t max_dets)
 {
-    std::ifstream config_file;
-    config_file.open(file.c_str());
-
     std::vector<std::vector<typename SymmGroup::charge> > configs;
 
-    for (std::string line; std::getline(config_file, line); ) {
+    for (std::string line; configs.size() < max_dets && std::getline(config_file, line); ) {
         std::vector<std::string> det_coeff;
         boost::split(det_coeff, line, boost::is_any_of(" "));
         
@@ -131,24 +128,35 @@ int main(int argc, char ** argv)
     for (pos_t q = 0; q < L; ++q)
         per_site.push_back(phys_dims[irreps[q]]);
     
-    // load the determinants
-    std::vector<std::vector<grp::charge> > determinants = parse_config<matrix, grp>(std::string(argv[2]), per_site);
-    // printout the determinants
-    for (pos_t q = 0;q < determinants.size(); ++q){
-       for (pos_t p = 0; p < L; ++p){
-           std::cout << determinants[q][p];
-       }   
-       std::cout << std::endl;
+    std::ifstream config_file(argv[2]);
+    if (!config_file) {
+        maquis::cerr << "Could not open the determinants file." << std::endl;
+        exit(1);
     }
 
-    // compute the CI coefficients for all determinants in the input
-    int i = 1;
-    for (std::vector< std::vector<grp::charge> >::iterator it = determinants.begin();
-        it != determinants.end(); ++it){
-        maquis::cout << "CI coefficient of det " << i <<": " << extract_coefficient(mps, *it) << std::endl;
-        i++;
+    // the determinants are streamed in batches, prefixes are shared within a batch
+    const std::size_t batch_size = 1 << 18;
+    std::size_t ndets = 0;
+    while (config_file) {
+        std::vector<std::vector<grp::charge> > determinants = parse_config<matrix, grp>(config_file, per_site, batch_size);
+        if (determinants.empty())
+            break;
+
+        // printout the determinants
+        for (pos_t q = 0;q < determinants.size(); ++q){
+           for (pos_t p = 0; p < L; ++p){
+               std::cout << determinants[q][p];
+           }
+           std::cout << std::endl;
         }
 
+        // compute the CI coefficients for the determinants of this batch
+        std::vector<matrix::value_type> coefficients = extract_coefficients(mps, determinants);
+        for (std::size_t i = 0; i < coefficients.size(); ++i)
+            maquis::cout << "CI coefficient of det " << ndets+i+1 <<": " << coefficients[i] << std::endl;
+        ndets += determinants.size();
+    }
+
     maquis::cout << std::endl;
 
     return 0;
@@ -164,6 +164,9 @@ struct Sampling
         typedef typename SymmGroup::charge charge;
         charge target = mps[mps.length()-1].col_dim()[0].first;
 
+// Reuses the partial products of the previous determinant, samples differ from it in a few sites only
+        ci_extractor<matrix, SymmGroup> extract(mps);
+
 // This part will be deleted, since the elements in NU1ChargePG could already be used.
 //        std::ifstream dets_file;
 //        dets_file.open(file.c_str());      
@@ -184,7 +187,7 @@ struct Sampling
         for (std::size_t c = 0; c < dets_mclr.size(); ++c)
            {
             det=dets_mclr[c];
-            ci0=extract_coefficient(mps, det); 	   
+            ci0=extract(det); 	   
             hash[det]=ci0;
 //            maquis::cout << "follow determinant " << c << " with coefficient " << ci0 << std::endl;
 //            for(int p = det_length-1; p >= 0; --p)            
@@ -278,7 +281,7 @@ struct Sampling
 //                maquis::cout << det_bee[p][0] << det_bee[p][1] << det_bee[p][2]  << std::endl;
 
 //        for(typename Determinants::iterator it = dets.begin();it != dets.end(); ++it)
-            ci=extract_coefficient(mps, det_bee); 	    
+            ci=extract(det_bee); 	    
             sum_ci2=sum_ci2+pow(ci,2.0); 
 //            maquis::cout << isample << "-th " << " CI coefficient: " << ci << std::endl;      
 
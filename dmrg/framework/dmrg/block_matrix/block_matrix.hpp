@@ -323,6 +323,7 @@ void block_matrix<Matrix, SymmGroup>::adjoint_inplace()
         std::swap(basis_[i].lc, basis_[i].rc);
         std::swap(basis_[i].ls, basis_[i].rs);
     }
+    basis_.invalidate_positions();
 }
 
 template<class Matrix, class SymmGroup>
@@ -29,6 +29,7 @@
 
 #include "dmrg/utils/logger.h"
 #include "dmrg/utils/utils.hpp"
+#include "dmrg/utils/memory_tracking.h"
 #include "utils/timings.h"
 #include "utils/traits.hpp"
 #include "utils/bindings.hpp"
@@ -104,6 +105,10 @@ void svd(block_matrix<Matrix, SymmGroup> const & M,
     V = block_matrix<Matrix, SymmGroup>(m, c);
     S = block_matrix<DiagMatrix, SymmGroup>(m, m);
     std::size_t loop_max = M.n_blocks();
+
+    // the LAPACK copy of M and the untruncated factors
+    memtrack::scoped_usage workspace(memtrack::svd, size_of(M) + size_of(U) + size_of(V)
+                                     + m.sum_of_sizes() * sizeof(typename DiagMatrix::value_type));
     
     omp_for(size_t k, parallel::range<size_t>(0,loop_max), {
         svd(M[k], U[k], V[k], S[k]);
@@ -119,6 +124,10 @@ void heev(block_matrix<Matrix, SymmGroup> const & M,
     evals = block_matrix<DiagMatrix, SymmGroup>(M.basis());
     std::size_t loop_max = M.n_blocks();
 
+    // the LAPACK copy of M and the eigenvectors
+    memtrack::scoped_usage workspace(memtrack::svd, 2 * size_of(M)
+                                     + M.left_basis().sum_of_sizes() * sizeof(typename DiagMatrix::value_type));
+
     omp_for(size_t k, parallel::range<size_t>(0,loop_max), {
         heev(M[k], evecs[k], evals[k]);
     });
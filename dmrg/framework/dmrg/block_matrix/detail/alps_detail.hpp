@@ -276,10 +276,12 @@ namespace maquis { namespace dmrg { namespace detail {
         return ret;
     }
     
+    // identity, an end index of dimension > 1 is traced over
     template <typename T, class A>
     void left_right_boundary_init(alps::numeric::matrix<T,A> & M){
-        //            memset((void*)&M(0,0),1,num_rows(M)*num_cols(M)*sizeof(T));
-        for_each(elements(M).first,elements(M).second, boost::lambda::_1 = 1); // boost::lambda ^^' because iterable matrix concept 
+        for_each(elements(M).first,elements(M).second, boost::lambda::_1 = 0); // boost::lambda ^^' because iterable matrix concept 
+        for (std::size_t i = 0; i < std::min(num_rows(M), num_cols(M)); ++i)
+            M(i,i) = 1;
     }
     
 } } } // namespace maquis::dmrg::detail
@@ -33,6 +33,8 @@
 #include <boost/serialization/nvp.hpp>
 #include <boost/preprocessor/repetition.hpp>
 
+#include "dmrg/block_matrix/position_table.h"
+
 namespace dual_index_detail
 {
     template <class SymmGroup>
@@ -93,6 +95,14 @@ namespace dual_index_detail
             return a.rc < b.rc;
     }
 
+    template<class SymmGroup>
+    struct charges_of {
+        std::pair<typename SymmGroup::charge, typename SymmGroup::charge> operator()(QnBlock<SymmGroup> const & x) const
+        {
+            return std::make_pair(x.lc, x.rc);
+        }
+    };
+
     //// simpler, and potentially faster since inlining is easier for the compiler
     template<class SymmGroup>
     class is_first_equal
@@ -169,6 +179,11 @@ public:
     
     std::size_t position(charge row, charge col) const
     {
+        std::size_t pos = table_.find(std::make_pair(row, col), data_.begin(), data_.size(),
+                                      dual_index_detail::charges_of<SymmGroup>());
+        if (pos != table_.npos)
+            return pos;
+
         const_iterator match;
         if (sorted_)
             match = std::lower_bound(data_.begin(), data_.end(), value_type(row,col,0,0), dual_index_detail::gt<SymmGroup>());
@@ -182,6 +197,11 @@ public:
 
     bool has(charge row, charge col) const
     {
+        std::size_t pos = table_.find(std::make_pair(row, col), data_.begin(), data_.size(),
+                                      dual_index_detail::charges_of<SymmGroup>());
+        if (pos != table_.npos)
+            return pos != data_.size();
+
         if (sorted_)
             return std::binary_search(data_.begin(), data_.end(), value_type(row,col,0,0), dual_index_detail::gt<SymmGroup>());
         else
@@ -213,10 +233,12 @@ public:
     {
         std::sort(data_.begin(), data_.end(), dual_index_detail::gt<SymmGroup>());
         sorted_ = true;
+        table_.invalidate();
     }
     
     std::size_t insert(value_type const & x)
     {
+        table_.invalidate();
         if (sorted_) {
             std::size_t d = destination(x);
             data_.insert(data_.begin() + d, x);
@@ -234,8 +256,11 @@ public:
             (*this)[k].lc = SymmGroup::fuse((*this)[k].lc, diff);
             (*this)[k].rc = SymmGroup::fuse((*this)[k].rc, diff);
         }
+        table_.invalidate();
     }
 
+    void invalidate_positions() { table_.invalidate(); }
+
     DualIndex transpose() const
     {
         DualIndex ret(*this);
@@ -299,6 +324,8 @@ public:
     }
 
     // This is mostly forwarding of the std::vector
+    // (element access keeps the lookup table, code that rewrites charges in place
+    //  has to call sort(), shift() or invalidate_positions() afterwards)
     iterator begin() { return data_.begin(); }
     iterator end() { return data_.end(); }
     const_iterator begin() const { return data_.begin(); }
@@ -319,28 +346,32 @@ public:
     qsize_type const & left_size(std::size_t k) const { return data_[k].ls; }
     qsize_type const & right_size(std::size_t k) const { return data_[k].rs; }
 
-    void resize(std::size_t sz) { data_.resize(sz); }
+    void resize(std::size_t sz) { table_.invalidate(); data_.resize(sz); }
     
     value_type & operator[](std::size_t p) { return data_[p]; }
     value_type const & operator[](std::size_t p) const { return data_[p]; }
     
     std::size_t size() const { return data_.size(); }
     
-    iterator erase(iterator p) { iterator r = data_.erase(p); return r; }
-    iterator erase(iterator a, iterator b) { iterator r = data_.erase(a,b); return r; }
+    iterator erase(iterator p) { table_.invalidate(); iterator r = data_.erase(p); return r; }
+    iterator erase(iterator a, iterator b) { table_.invalidate(); iterator r = data_.erase(a,b); return r; }
 
     friend void swap(DualIndex & a, DualIndex & b)
     {
         using std::swap;
         swap(a.data_,   b.data_);
         swap(a.sorted_, b.sorted_);
+        a.table_.invalidate();
+        b.table_.invalidate();
     }
     
 private:
     data_type data_;
     bool sorted_;
+    position_table<std::pair<charge, charge> > table_;
     
     void push_back(value_type const & x){
+        table_.invalidate();
         data_.push_back(x);
     }
     
@@ -356,6 +387,7 @@ public:
 #ifdef PYTHON_EXPORTS
     std::size_t py_insert(wrapped_pair<SymmGroup> p)
     {
+        table_.invalidate();
         return data_.insert(p.data_);
     }
 #endif /* PYTHON_EXPORTS */
@@ -364,6 +396,7 @@ public:
     void load(Archive & ar)
     {
         ar["DualIndex"] >> data_;
+        table_.invalidate();
     }
     template <class Archive>
     void save(Archive & ar) const
@@ -377,6 +410,7 @@ public:
     void load(Archive & ar, const unsigned int version)
     {
         ar & data_;
+        table_.invalidate();
     }
     template <class Archive>
     void save(Archive & ar, const unsigned int version) const
@@ -47,6 +47,7 @@
 #include <boost/serialization/utility.hpp>
 #include <boost/serialization/vector.hpp>
 
+#include "dmrg/block_matrix/position_table.h"
 
 namespace index_detail
 {
@@ -71,6 +72,14 @@ namespace index_detail
         return x.first;
     }
     
+    template<class SymmGroup>
+    struct charge_of {
+        typename SymmGroup::charge operator()(std::pair<typename SymmGroup::charge, std::size_t> const & x) const
+        {
+            return x.first;
+        }
+    };
+
     template<class SymmGroup>
     std::size_t get_second(std::pair<typename SymmGroup::charge, std::size_t> const & x)
     {
@@ -128,6 +137,10 @@ public:
     
     std::size_t position(charge c) const
     {
+        std::size_t pos = table_.find(c, data_.begin(), data_.size(), index_detail::charge_of<SymmGroup>());
+        if (pos != table_.npos)
+            return pos;
+
         const_iterator match;
         if (sorted_)
             match = std::lower_bound(data_.begin(), data_.end(), std::make_pair(c,0), index_detail::gt<SymmGroup>());
@@ -150,6 +163,10 @@ public:
     
     bool has(charge c) const
     {
+        std::size_t pos = table_.find(c, data_.begin(), data_.size(), index_detail::charge_of<SymmGroup>());
+        if (pos != table_.npos)
+            return pos != data_.size();
+
         if (sorted_)
             return std::binary_search(data_.begin(), data_.end(), std::make_pair(c,0), index_detail::gt<SymmGroup>());
         else
@@ -161,10 +178,12 @@ public:
     {
         std::sort(data_.begin(), data_.end(), index_detail::gt<SymmGroup>());
         sorted_ = true;
+        table_.invalidate();
     }
     
     std::size_t insert(value_type const & x)
     {
+        table_.invalidate();
         if (sorted_) {
             std::size_t d = destination(x.first);
             data_.insert(data_.begin() + d, x);
@@ -179,13 +198,17 @@ public:
     {
         data_.insert(data_.begin() + position, x);
         sorted_ = false;
+        table_.invalidate();
     }
     
     void shift(charge diff)
     {
         for (std::size_t k = 0; k < data_.size(); ++k)
             (*this)[k].first = SymmGroup::fuse((*this)[k].first, diff);
+        table_.invalidate();
     }
+
+    void invalidate_positions() { table_.invalidate(); }
     
     bool operator==(Index const & o) const
     {
@@ -218,6 +241,8 @@ public:
     }
 
     // This is mostly forwarding of the std::vector
+    // (element access keeps the lookup table, code that rewrites charges in place
+    //  has to call sort(), shift() or invalidate_positions() afterwards)
     iterator begin() { return data_.begin(); }
     iterator end() { return data_.end(); }
     const_iterator begin() const { return data_.begin(); }
@@ -243,21 +268,25 @@ public:
 
     std::size_t size() const { return data_.size(); }
     
-    iterator erase(iterator p) { iterator r = data_.erase(p); return r; }
-    iterator erase(iterator a, iterator b) { iterator r = data_.erase(a,b); return r; }
+    iterator erase(iterator p) { table_.invalidate(); iterator r = data_.erase(p); return r; }
+    iterator erase(iterator a, iterator b) { table_.invalidate(); iterator r = data_.erase(a,b); return r; }
     
     friend void swap(Index & a, Index & b)
     {
         using std::swap;
         swap(a.data_,   b.data_);
         swap(a.sorted_, b.sorted_);
+        a.table_.invalidate();
+        b.table_.invalidate();
     }
     
 private:
     data_type data_;
     bool sorted_;
+    position_table<charge> table_;
     
     void push_back(value_type const & x){
+        table_.invalidate();
         data_.push_back(x);
     }
     
@@ -273,6 +302,7 @@ public:
 #ifdef PYTHON_EXPORTS
     std::size_t py_insert(wrapped_pair<SymmGroup> p)
     {
+        table_.invalidate();
         return data_.insert(p.data_);
     }
 #endif /* PYTHON_EXPORTS */
@@ -281,6 +311,7 @@ public:
     void load(Archive & ar)
     {
         ar["Index"] >> data_;
+        table_.invalidate();
     }
     template <class Archive>
     void save(Archive & ar) const
@@ -294,6 +325,7 @@ public:
     void load(Archive & ar, const unsigned int version)
     {
         ar & data_;
+        table_.invalidate();
     }
     template <class Archive>
     void save(Archive & ar, const unsigned int version) const
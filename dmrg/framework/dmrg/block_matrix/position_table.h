@@ -0,0 +1,175 @@
+/*****************************************************************************
+ *
+ * ALPS MPS DMRG Project
+ *
+ * Copyright (C) 2014 Institute for Theoretical Physics, ETH Zurich
+ *
+ * This software is part of the ALPS Applications, published under the ALPS
+ * Application License; you can use, redistribute it and/or modify it under
+ * the terms of the license, either version 1 or (at your option) any later
+ * version.
+ *
+ * You should have received a copy of the ALPS Application License along with
+ * the ALPS Applications; see the file LICENSE.txt. If not, the license is also
+ * available from http://alps.comp-phys.org/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef TENSOR_POSITION_TABLE_H
+#define TENSOR_POSITION_TABLE_H
+
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+
+#include <boost/functional/hash.hpp>
+
+/// Flat open-addressing map from a charge key to its position in an Index or DualIndex.
+///
+/// The table is a cache: the owner calls invalidate() on every mutation and lookups
+/// rebuild it on demand. Plain element access must not invalidate, that would race
+/// with concurrent const lookups. Until it is worth building (small bases, or too few lookups
+/// since the last mutation) find() returns npos and the owner falls back to its
+/// binary search. Concurrent const lookups are safe: exactly one thread builds,
+/// the others keep using the fallback until the table is published.
+template <class Key, class Hash = boost::hash<Key> >
+class position_table
+{
+    typedef std::pair<Key, std::size_t> slot_type;
+    enum { invalid, building, ready };
+
+public:
+    static const std::size_t npos = std::size_t(-1);
+
+    // below this size a binary search over the index is just as fast
+    static const std::size_t min_size = 16;
+
+    position_table() : state_(invalid), lookups_(0), shift_(0) {}
+
+    position_table(position_table const & rhs) : state_(invalid), lookups_(0), shift_(0)
+    {
+        copy_from(rhs);
+    }
+
+    position_table & operator=(position_table const & rhs)
+    {
+        if (this != &rhs) {
+            invalidate();
+            copy_from(rhs);
+        }
+        return *this;
+    }
+
+    position_table(position_table && rhs) noexcept : state_(invalid), lookups_(0), shift_(0)
+    {
+        move_from(rhs);
+    }
+
+    position_table & operator=(position_table && rhs) noexcept
+    {
+        if (this != &rhs) {
+            invalidate();
+            move_from(rhs);
+        }
+        return *this;
+    }
+
+    void invalidate()
+    {
+        state_.store(invalid, std::memory_order_relaxed);
+        lookups_.store(0, std::memory_order_relaxed);
+    }
+
+    /// Position of k among the n keys in [first, first+n), n if absent, npos if the table is unavailable
+    template <class Iterator, class KeyOf>
+    std::size_t find(Key const & k, Iterator first, std::size_t n, KeyOf key_of) const
+    {
+        if (n < min_size)
+            return npos;
+
+        if (state_.load(std::memory_order_acquire) != ready && !try_build(first, n, key_of))
+            return npos;
+
+        for (std::size_t i = bucket(k); ; i = (i + 1) & (slots_.size() - 1)) {
+            if (slots_[i].second == npos) return n;
+            if (slots_[i].first == k) return slots_[i].second;
+        }
+    }
+
+private:
+    // building costs about as much as n/8 binary searches, so wait until it pays off
+    template <class Iterator, class KeyOf>
+    bool try_build(Iterator first, std::size_t n, KeyOf key_of) const
+    {
+        if (lookups_.fetch_add(1, std::memory_order_relaxed) < n / 8)
+            return false;
+
+        int expected = invalid;
+        if (!state_.compare_exchange_strong(expected, building, std::memory_order_acquire))
+            return false;
+
+        std::size_t cap = 2 * min_size;
+        shift_ = 64 - 5;
+        while (cap < 2 * n) { cap *= 2; --shift_; }
+
+        slots_.assign(cap, slot_type(Key(), npos));
+        for (std::size_t p = 0; p < n; ++p, ++first) {
+            Key k = key_of(*first);
+            std::size_t i = bucket(k);
+            while (slots_[i].second != npos && !(slots_[i].first == k))
+                i = (i + 1) & (cap - 1);
+            // keep the first occurrence, like the linear search does
+            if (slots_[i].second == npos)
+                slots_[i] = slot_type(k, p);
+        }
+
+        state_.store(ready, std::memory_order_release);
+        return true;
+    }
+
+    // Fibonacci hashing spreads the identity hash of U1 charges over the whole table
+    std::size_t bucket(Key const & k) const
+    {
+        return std::size_t((std::uint64_t(Hash()(k)) * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    void copy_from(position_table const & rhs)
+    {
+        if (rhs.state_.load(std::memory_order_acquire) == ready) {
+            slots_ = rhs.slots_;
+            shift_ = rhs.shift_;
+            state_.store(ready, std::memory_order_release);
+        }
+    }
+
+    // takes the slots of a ready table, rhs is left empty and invalid
+    void move_from(position_table & rhs) noexcept
+    {
+        if (rhs.state_.load(std::memory_order_acquire) == ready) {
+            slots_.swap(rhs.slots_);
+            shift_ = rhs.shift_;
+            state_.store(ready, std::memory_order_release);
+        }
+        rhs.invalidate();
+        std::vector<slot_type>().swap(rhs.slots_);
+    }
+
+    mutable std::atomic<int> state_;
+    mutable std::atomic<std::size_t> lookups_;
+    mutable std::vector<slot_type> slots_;
+    mutable unsigned shift_;
+};
+
+template <class Key, class Hash> const std::size_t position_table<Key, Hash>::npos;
+template <class Key, class Hash> const std::size_t position_table<Key, Hash>::min_size;
+
+#endif
@@ -27,6 +27,11 @@
 #ifndef GSL_COUPLING_H
 #define GSL_COUPLING_H
 
+#include <cstdint>
+#include <mutex>
+#include <memory>
+#include <unordered_map>
+
 extern "C" {
     double gsl_sf_coupling_3j(int two_ja, int two_jb, int two_jc, int two_ma, int two_mb, int two_mc);
     double gsl_sf_coupling_6j(int two_ja, int two_jb, int two_jc, int two_jd, int two_je, int two_jf);
@@ -187,9 +192,9 @@ namespace SU2 {
             }
         }
 
-        void set_scale(int A, int K, int Ap, int Jp, T scale, T couplings[])
+        void set_scale(int A, int K, int Ap, int Jp, T scale, T couplings[]) const
         {
-            T* c2 = &coefficients[4*hash(A,K,Ap) + 48 * (Jp-Jpmin)];
+            T const* c2 = &coefficients[4*hash(A,K,Ap) + 48 * (Jp-Jpmin)];
             std::transform(c2, c2+4, couplings, boost::lambda::_1*scale);
         }
 
@@ -206,21 +211,82 @@ namespace SU2 {
         std::vector<T> coefficients;
     };
 
+    // Process-wide table of Wigner9jCacheI, filled on first use of a (J, I, I') triple.
+    // Entries are never removed, so references stay valid. Each thread keeps its own
+    // index into the table and only takes the lock on a miss.
+    template <typename T>
+    class Wigner9jTable
+    {
+        typedef std::uint64_t key_type;
+        typedef std::unordered_map<key_type, Wigner9jCacheI<T> const*> index_type;
+
+    public:
+        static Wigner9jCacheI<T> const& get(int J, int I, int Ip)
+        {
+            thread_local index_type local;
+
+            key_type key = pack(J, I, Ip);
+            typename index_type::const_iterator match = local.find(key);
+            if (match != local.end())
+                return *match->second;
+
+            Wigner9jCacheI<T> const* entry = instance().lookup(key, J, I, Ip);
+            local[key] = entry;
+            return *entry;
+        }
+
+        static std::size_t size()
+        {
+            Wigner9jTable & table = instance();
+            std::lock_guard<std::mutex> lock(table.mutex);
+            return table.entries.size();
+        }
+
+    private:
+        // spin labels are twice the spin, far below 2^21
+        static key_type pack(int J, int I, int Ip)
+        {
+            return key_type(J) | (key_type(I) << 21) | (key_type(Ip) << 42);
+        }
+
+        static Wigner9jTable & instance()
+        {
+            static Wigner9jTable table;
+            return table;
+        }
+
+        // the coefficients are computed under the lock; a triple is evaluated
+        // only once per process and there are few distinct triples
+        Wigner9jCacheI<T> const* lookup(key_type key, int J, int I, int Ip)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            std::unique_ptr<Wigner9jCacheI<T> > & entry = entries[key];
+            if (!entry)
+                entry.reset(new Wigner9jCacheI<T>(J, I, Ip));
+            return entry.get();
+        }
+
+        std::mutex mutex;
+        std::unordered_map<key_type, std::unique_ptr<Wigner9jCacheI<T> > > entries;
+    };
+
     template <typename T, class SymmGroup, class SymmType = void>
-    class Wigner9jCache : public Wigner9jCacheI<T>
+    class Wigner9jCache
     {
         typedef typename SymmGroup::charge charge;
-        typedef Wigner9jCacheI<T> base;
 
     public:
 
         Wigner9jCache(charge lc, charge mc, charge rc)
-            : base(SymmGroup::spin(mc), SymmGroup::spin(lc), SymmGroup::spin(rc)) {}
+            : table(Wigner9jTable<T>::get(SymmGroup::spin(mc), SymmGroup::spin(lc), SymmGroup::spin(rc))) {}
 
-        void set_scale(int A, int K, int Ap, charge Jp, T scale, T couplings[])
+        void set_scale(int A, int K, int Ap, charge Jp, T scale, T couplings[]) const
         {
-            return base::set_scale(A, K, Ap, SymmGroup::spin(Jp), scale, couplings);
+            return table.set_scale(A, K, Ap, SymmGroup::spin(Jp), scale, couplings);
         }
+
+    private:
+        Wigner9jCacheI<T> const& table;
     };
 
     template <typename T, class SymmGroup>
@@ -232,7 +298,7 @@ namespace SU2 {
 
         Wigner9jCache(charge lc, charge mc, charge rc) {}
 
-        void set_scale(int A, int K, int Ap, charge Jp, T scale, T couplings[])
+        void set_scale(int A, int K, int Ap, charge Jp, T scale, T couplings[]) const
         {
             std::fill(couplings, couplings+4, scale);
         }
@@ -29,6 +29,8 @@
 
 #include <cmath>
 
+#include <boost/shared_ptr.hpp>
+
 #include "dmrg/utils/storage.h"
 #include "dmrg/evolve/te_utils.hpp"
 #include "dmrg/mp_tensors/mpo_contractor_ss.h"
@@ -75,6 +77,7 @@ public:
     {
         iteration_results_.clear();
         for (unsigned i=0; i < nsteps; ++i) evolve_time_step(sweep+i);
+        *mps = evolution->get_current_mps();
     }
     
     results_collector const& iteration_results() const
@@ -85,18 +88,29 @@ public:
 private:
     void evolve_time_step(unsigned sweep)
     {
+        int maxiter = (*parms)["te_fit_maxiter"];
+        double tol = (*parms)["te_fit_tol"];
         for (int which = 0; which < Uterms.size(); ++which)
         {
-            int maxiter = 6; double tol = 1e-6;
-            mpo_contractor_ss<Matrix, SymmGroup, storage::nop> evolution(*mps, Uterms[which], (*parms));
-            for (int k = 0; k < maxiter; ++k) {
-                std::pair<double,double> eps = evolution.sweep(sweep);
-                double rel_error = std::abs( (eps.first-eps.second) / eps.second );
+            // the contractor holds the evolving state between factors and steps
+            if (!evolution)
+                evolution.reset(new mpo_contractor_ss<Matrix, SymmGroup, storage::nop>(*mps, Uterms[which], (*parms)));
+            else
+                evolution->next(Uterms[which]);
+
+            int k = 0;
+            double rel_error = 0.;
+            while (k < maxiter) {
+                std::pair<double,double> eps = evolution->sweep(sweep);
+                rel_error = std::abs( (eps.first-eps.second) / eps.second );
+                ++k;
                 if (rel_error < tol)
                     break;
             }
-            evolution.finalize();
-            *mps = evolution.get_current_mps();
+            evolution->finalize();
+
+            iteration_results_["FitSweeps"] << k;
+            iteration_results_["FitRelativeChange"] << rel_error;
         }
     }
 
@@ -111,6 +125,9 @@ private:
     
     std::vector<std::vector<term_t> > hamils;
     std::vector<MPO<Matrix, SymmGroup> > Uterms;
+
+    // shared, so that copies of the evolver continue from the same fit
+    boost::shared_ptr<mpo_contractor_ss<Matrix, SymmGroup, storage::nop> > evolution;
 };
 
 #endif
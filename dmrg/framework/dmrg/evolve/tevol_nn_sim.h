@@ -33,6 +33,7 @@
 
 #include "dmrg/evolve/te_utils.hpp"
 #include "dmrg/utils/results_collector.h"
+#include "dmrg/utils/parallel.hpp"
 
 
 // ******     HELPER OBJECTS     ******
@@ -85,6 +86,7 @@ inline std::ostream& operator<< (std::ostream& os, tevol_order_tag o)
 template <class Matrix, class SymmGroup>
 class nearest_neighbors_evolver {
     typedef typename operator_selector<Matrix, SymmGroup>::type op_t;
+    typedef typename alps::numeric::associated_real_diagonal_matrix<Matrix>::type dmt;
 public:
     nearest_neighbors_evolver(DmrgParameters * parms_, MPS<Matrix, SymmGroup> * mps_,
                               Lattice const& lattice_, Model<Matrix, SymmGroup> const& model_,
@@ -102,6 +104,8 @@ public:
         maquis::cout << "Time evolution optimization is "
                      << (((*parms)["te_optim"]) ? "enabled" : "disabled")
                      << std::endl;
+        if ((*parms)["te_parallel"])
+            maquis::cout << "Gates of one layer are applied concurrently." << std::endl;
         
         /// alpha coeffiecients and set sequence of Uterms according to trotter order
         switch (trotter_order){
@@ -217,7 +221,8 @@ public:
     {
         double dt = (*parms)["dt"];
         typename Matrix::value_type I;
-        if (sweep < (*parms)["nsweeps_img"])
+        imaginary_time = (sweep < (*parms)["nsweeps_img"]);
+        if (imaginary_time)
             I = maquis::traits::real_identity<typename Matrix::value_type>::value;
         else
             I = maquis::traits::imag_identity<typename Matrix::value_type>::value;
@@ -241,6 +246,10 @@ public:
     void operator()(unsigned sweep, unsigned nsteps)
     {
         iteration_results_.clear();
+
+        // unitary layers keep the Schmidt form, so it is only built once per call
+        if ((*parms)["te_parallel"])
+            make_schmidt_form();
         
         if (nsteps < 2 || !static_cast<bool>((*parms)["te_optim"])) {
             // nsteps sweeps
@@ -254,6 +263,11 @@ public:
             // one sweep
             evolve_time_step(Useq_ameas);
         }
+
+        // imaginary-time layers only renormalize locally, the state is canonicalized
+        // once before it is measured or checkpointed
+        if ((*parms)["te_parallel"] && imaginary_time)
+            make_schmidt_form();
     }
     
     results_collector const& iteration_results() const
@@ -277,6 +291,12 @@ private:
     void evolve_time_step(std::vector<std::size_t> const & gates_i)
     {
         assert(gates_i.size() > 0);
+
+        if ((*parms)["te_parallel"]) {
+            for (size_t i=0; i<gates_i.size(); ++i)
+                evolve_layer(gates_i[i]);
+            return;
+        }
         
         for (size_t i=0; i<gates_i.size(); ++i) {
             if (mps->canonization(true) < mps->length()/2)
@@ -372,6 +392,141 @@ private:
         // maquis::cout << "Norm loss " << i << ": " << trace(t) << " " << -log(trace(t)) << std::endl;
     }
 
+    /// Right normalize all sites and store the Schmidt values of every bond, in the basis of
+    /// the left index of the site to its right (Vidal form, as in M. B. Hastings,
+    /// J. Math. Phys. 50, 095207 (2009)).
+    void make_schmidt_form()
+    {
+        std::size_t L = mps->length();
+        lambda.resize(L-1);
+
+        mps->canonize(0);
+        (*mps)[0].divide_by_scalar((*mps)[0].scalar_norm());
+
+        // center: the state with its norm at site p; rot: site p in the Schmidt basis of bond p-1
+        MPSTensor<Matrix, SymmGroup> center = (*mps)[0], rot = (*mps)[0];
+        for (std::size_t p = 0; p < L-1; ++p)
+        {
+            block_matrix<Matrix, SymmGroup> u, v, tmp;
+            center.make_left_paired();
+            svd(center.data(), u, v, lambda[p]);
+
+            rot.make_left_paired();
+            gemm(rot.data(), adjoint(v), tmp);
+            rot.replace_left_paired(tmp, Rnorm);
+            (*mps)[p] = rot;
+
+            gemm(lambda[p], v, tmp);
+            center = (*mps)[p+1];
+            center.multiply_from_left(tmp);
+            rot = (*mps)[p+1];
+            rot.multiply_from_left(v);
+        }
+        rot.make_right_paired();
+        block_matrix<Matrix, SymmGroup> last = rot.data();
+        rot.replace_right_paired(last, Rnorm);
+        (*mps)[L-1] = rot;
+    }
+
+    /// Apply all gates of one layer concurrently. They act on disjoint bonds and only read the
+    /// Schmidt values of the neighbouring bonds, which belong to the other layer.
+    void evolve_layer(std::size_t gate_index)
+    {
+        std::size_t L = mps->length();
+        std::vector<op_t> const & ops = Uterms[gate_index].vgates;
+        std::vector<long> const & idx = Uterms[gate_index].idx;
+        std::size_t Mmax=(*parms)["max_bond_dimension"];
+        double cutoff=(*parms)["truncation_final"];
+
+        std::vector<std::size_t> bonds;
+        for (std::size_t p = Uterms[gate_index].pfirst; p < L-1; p += 2)
+            if (idx[p] != -1) bonds.push_back(p);
+
+        // non-const MPS::operator[] resets the canonization, so take the sites up front
+        std::vector<MPSTensor<Matrix, SymmGroup>*> sites(L);
+        for (std::size_t p = 0; p < L; ++p)
+            sites[p] = &(*mps)[p];
+
+        std::vector<truncation_results> trunc(bonds.size());
+        omp_for(std::size_t b, parallel::range<std::size_t>(0, bonds.size()), {
+            std::size_t p = bonds[b];
+            trunc[b] = apply_gate(*sites[p], *sites[p+1], ops[idx[p]], p, Mmax, cutoff);
+        });
+
+        // bond order, independent of the thread schedule
+        for (std::size_t b = 0; b < bonds.size(); ++b) {
+            iteration_results_["BondDimension"]     << trunc[b].bond_dimension;
+            iteration_results_["TruncatedWeight"]   << trunc[b].truncated_weight;
+            iteration_results_["TruncatedFraction"] << trunc[b].truncated_fraction;
+            iteration_results_["SmallestEV"]        << trunc[b].smallest_ev;
+        }
+    }
+
+    // The SVD of lambda[p-1] * U * B_p B_p+1 gives the new Schmidt values and B_p+1; B_p is then
+    // U * B_p B_p+1 times the kept right singular vectors, which avoids dividing by lambda[p-1].
+    // In imaginary time the neighbouring bonds leave the Schmidt form, their lambda is only
+    // approximate until the next make_schmidt_form.
+    truncation_results apply_gate(MPSTensor<Matrix, SymmGroup> & bp, MPSTensor<Matrix, SymmGroup> & bq,
+                                  op_t const & op, std::size_t p, std::size_t Mmax, double cutoff)
+    {
+        bp.make_left_paired();
+        bq.make_right_paired();
+
+        block_matrix<Matrix, SymmGroup> phi, theta;
+        gemm(bp.data(), bq.data(), phi);
+        phi = contraction::multiply_with_twosite<Matrix>(phi, op, bp.row_dim(), bq.col_dim(), bp.site_dim());
+
+        theta = phi;
+        if (p > 0)
+            scale_left_rows(theta, lambda[p-1], bp.site_dim(), bp.row_dim());
+
+        block_matrix<Matrix, SymmGroup> u, v, bnew;
+        block_matrix<dmt, SymmGroup> s;
+        truncation_results trunc = svd_truncate(theta, u, v, s, cutoff, Mmax, false);
+
+        // keep the state normalized, the gates are not unitary in imaginary time
+        double norm = 0.;
+        for (std::size_t k = 0; k < s.n_blocks(); ++k)
+            for (typename dmt::const_diagonal_iterator it = s[k].diagonal().first; it != s[k].diagonal().second; ++it)
+                norm += maquis::real(*it) * maquis::real(*it);
+        norm = std::sqrt(norm);
+        s /= norm;
+
+        gemm(phi, adjoint(v), bnew);
+        bnew /= norm;
+
+        bp.replace_left_paired(bnew, Rnorm);
+        bq.replace_right_paired(v, Rnorm);
+        lambda[p] = s;
+
+        return trunc;
+    }
+
+    // multiply the rows of the left paired m by the Schmidt values of their left bond index
+    static void scale_left_rows(block_matrix<Matrix, SymmGroup> & m, block_matrix<dmt, SymmGroup> const & lam,
+                                Index<SymmGroup> const & phys_i, Index<SymmGroup> const & left_i)
+    {
+        ProductBasis<SymmGroup> left_pb(phys_i, left_i);
+        for (std::size_t k = 0; k < m.n_blocks(); ++k)
+            for (std::size_t s = 0; s < phys_i.size(); ++s)
+            {
+                typename SymmGroup::charge lc = SymmGroup::fuse(m.basis().left_charge(k), -phys_i[s].first);
+                if (!left_i.has(lc))
+                    continue;
+                std::size_t ls = left_i.size_of_block(lc), offset = left_pb(phys_i[s].first, lc);
+                // bond states without a Schmidt value carry no weight
+                std::size_t nl = lam.has_block(lc, lc) ? num_rows(lam(lc, lc)) : 0;
+
+                for (std::size_t ss = 0; ss < phys_i[s].second; ++ss)
+                    for (std::size_t l = 0; l < ls; ++l)
+                    {
+                        typename Matrix::value_type f = (l < nl) ? typename Matrix::value_type(lam(lc, lc)(l, l)) : 0.;
+                        for (std::size_t c = 0; c < num_cols(m[k]); ++c)
+                            m[k](offset + ss*ls + l, c) *= f;
+                    }
+            }
+    }
+
 private:
     DmrgParameters * parms;
     MPS<Matrix, SymmGroup> * mps;
@@ -387,6 +542,9 @@ private:
     std::vector<trotter_gate<Matrix, SymmGroup> > Uterms;
     std::vector<std::size_t> Useq; // trivial sequence
     std::vector<std::size_t> Useq_double, Useq_bmeas, Useq_ameas; // sequence with two sweeps; meas before; meas after
+
+    std::vector<block_matrix<dmt, SymmGroup> > lambda; // Schmidt values of each bond in te_parallel mode
+    bool imaginary_time;
 };
 
 #endif
@@ -0,0 +1,439 @@
+/*****************************************************************************
+ *
+ * ALPS MPS DMRG Project
+ *
+ * Copyright (C) 2026 Department of Chemistry and the PULSE Institute, Stanford University
+ *                    Laboratory for Physical Chemistry, ETH Zurich
+ *
+ * This software is part of the ALPS Applications, published under the ALPS
+ * Application License; you can use, redistribute it and/or modify it under
+ * the terms of the license, either version 1 or (at your option) any later
+ * version.
+ *
+ * You should have received a copy of the ALPS Application License along with
+ * the ALPS Applications; see the file LICENSE.txt. If not, the license is also
+ * available from http://alps.comp-phys.org/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef APP_DMRG_TEVOL_TDVP_SIM_H
+#define APP_DMRG_TEVOL_TDVP_SIM_H
+
+#include <cmath>
+
+#include <boost/shared_ptr.hpp>
+
+#include "dmrg/optimize/optimize.h"
+#include "dmrg/utils/results_collector.h"
+
+namespace tdvp_detail {
+    inline bool never_stop() { return false; }
+
+    /// Real time TDVP keeps psi = R + iI as a real MPS whose end index has dimension 2,
+    /// column 0 holding R and column 1 holding I. The initial state gets a zero imaginary part.
+    template <class Matrix, class SymmGroup>
+    void add_imaginary_part(MPS<Matrix, SymmGroup> & mps)
+    {
+        std::size_t L = mps.length();
+        MPSTensor<Matrix, SymmGroup> const & last = mps[L-1];
+
+        // restarted from a real time checkpoint
+        if (last.col_dim().sum_of_sizes() == 2)
+            return;
+        if (last.col_dim().sum_of_sizes() != 1)
+            throw std::runtime_error("real time tdvp needs an end index of dimension 1\n");
+
+        last.make_left_paired();
+        block_matrix<Matrix, SymmGroup> const & data = last.data();
+        block_matrix<Matrix, SymmGroup> wide;
+        for (std::size_t b = 0; b < data.n_blocks(); ++b) {
+            Matrix m(num_rows(data[b]), 2, 0.);
+            for (std::size_t i = 0; i < num_rows(data[b]); ++i)
+                m(i, 0) = data[b](i, 0);
+            wide.insert_block(m, data.basis().left_charge(b), data.basis().right_charge(b));
+        }
+
+        Index<SymmGroup> right;
+        right.insert(std::make_pair(last.col_dim()[0].first, 2));
+        mps[L-1] = MPSTensor<Matrix, SymmGroup>(last.site_dim(), last.row_dim(), right, wide, LeftPaired);
+    }
+
+    /// Copy of mpo without hermitian bond partners. In real time the right boundaries contain
+    /// the antisymmetric end block, so a boundary is no longer the transpose of its partner.
+    template <class Matrix, class SymmGroup>
+    MPO<Matrix, SymmGroup> drop_hermitian(MPO<Matrix, SymmGroup> const & mpo)
+    {
+        typedef MPOTensor<Matrix, SymmGroup> tensor_t;
+        typedef typename tensor_t::index_type index_type;
+        typedef typename tensor_t::BondProperty BondProperty;
+
+        MPO<Matrix, SymmGroup> ret(mpo);
+        for (std::size_t p = 0; p < mpo.length(); ++p) {
+            tensor_t const & W = mpo[p];
+            typename tensor_t::prempo_t terms;
+            for (index_type b1 = 0; b1 < W.row_dim(); ++b1) {
+                typename tensor_t::row_proxy row = W.row(b1);
+                for (typename tensor_t::row_proxy::const_iterator it = row.begin(); it != row.end(); ++it) {
+                    MPOTensor_detail::term_descriptor<Matrix, SymmGroup, true> term = W.at(b1, it.index());
+                    for (std::size_t k = 0; k < term.size(); ++k)
+                        terms.push_back(boost::make_tuple(b1, it.index(), W.tag_number(b1, it.index(), k), term.scale(k)));
+                }
+            }
+            ret[p] = tensor_t(W.row_dim(), W.col_dim(), terms, W.get_operator_table(),
+                              BondProperty(W.leftBond().spins(), MPOTensor_detail::Hermitian(W.row_dim())),
+                              BondProperty(W.rightBond().spins(), MPOTensor_detail::Hermitian(W.col_dim())));
+        }
+        return ret;
+    }
+}
+
+/// One symmetric TDVP step: a left to right and a right to left half sweep, each propagating
+/// by half the time step. With optimization=twosite the forward steps act on site pairs and
+/// the backward steps on single sites, with optimization=singlesite on single sites and bond
+/// matrices. The boundaries of the optimizer base stay valid from one step to the next, since
+/// every step ends with the center at site 0.
+/// In imaginary time the sweep applies exp(-tau H). In real time the state carries its
+/// imaginary part on the end index (tdvp_detail::add_imaginary_part) and the right end boundary
+/// couples the two parts antisymmetrically, so the site problems propagate with the real
+/// generator of exp(-i tau H).
+template<class Matrix, class SymmGroup, class Storage>
+class tdvp_sweep : public optimizer_base<Matrix, SymmGroup, Storage>
+{
+public:
+    typedef optimizer_base<Matrix, SymmGroup, Storage> base;
+    typedef typename Matrix::value_type value_type;
+    using base::mpo;
+    using base::mps;
+    using base::left_;
+    using base::right_;
+    using base::parms;
+    using base::iteration_results_;
+    using base::cpu_gpu_ratio;
+
+    tdvp_sweep(MPS<Matrix, SymmGroup> & mps_,
+               MPO<Matrix, SymmGroup> const & mpo_,
+               BaseParameters & parms_,
+               bool real_time_)
+    : base(mps_, mpo_, std::vector<MPS<Matrix, SymmGroup>*>(), parms_, &tdvp_detail::never_stop, 0)
+    , site_ratio(mps_.length(), 0.9)
+    , bond_ratio(mps_.length(), 0.9)
+    , tau(0.)
+    , real_time(real_time_)
+    , twosite(parms_["optimization"] == "twosite")
+    {
+        if (base::northo > 0)
+            throw std::runtime_error("tdvp does not support orthogonal states\n");
+
+        if (twosite)
+            make_ts_cache_mpo(mpo, ts_cache_mpo, mps);
+        else
+            make_bond_mpo();
+
+        if (real_time)
+            init_real_time_boundaries();
+    }
+
+    /// time step of the following sweeps
+    void set_time_step(double tau_) { tau = tau_; }
+
+    void sweep(int sweep, OptimizeDirection d = Both)
+    {
+        iteration_results_.clear();
+
+        std::size_t L = mps.length();
+        if (twosite) {
+            for (int site1 = 0; site1 < L-1; ++site1)
+                evolve_bond(sweep, site1, +1);
+            for (int site1 = L-2; site1 >= 0; --site1)
+                evolve_bond(sweep, site1, -1);
+        }
+        else {
+            for (int site = 0; site < L; ++site)
+                evolve_site(sweep, site, +1);
+            for (int site = L-1; site >= 0; --site)
+                evolve_site(sweep, site, -1);
+        }
+    }
+
+private:
+    // forward step on the pair (site1, site1+1), then the backward step on the site the
+    // center moves to, unless the half sweep ends here
+    void evolve_bond(int sweep, int site1, int lr)
+    {
+        std::size_t L = mps.length();
+        int site2 = site1 + 1;
+
+        maquis::cout << std::endl;
+        maquis::cout << "TDVP step " << sweep << ", propagating sites " << site1 << " and " << site2 << std::endl;
+
+        Storage::broadcast::fetch(left_[site1]);
+        Storage::broadcast::fetch(right_[site2+1]);
+
+        TwoSiteTensor<Matrix, SymmGroup> tst(mps[site1], mps[site2]);
+        MPSTensor<Matrix, SymmGroup> twin_mps = tst.make_mps();
+        tst.clear();
+
+        std::tuple<double, MPSTensor<Matrix, SymmGroup>, double> res
+            = evolve_site_problem(twin_mps, left_[site1], right_[site2+1], ts_cache_mpo[site1],
+                                  tau/2, real_time, parms, cpu_gpu_ratio[site1]);
+        cpu_gpu_ratio[site1] = std::get<2>(res);
+        twin_mps.clear();
+        tst << std::get<1>(res);
+        std::get<1>(res).clear();
+        record_energy(lr, std::get<0>(res));
+
+        truncation_results trunc;
+        double cutoff = this->get_cutoff(sweep);
+        std::size_t Mmax = this->get_Mmax(sweep);
+
+        if (lr == +1) {
+            boost::tie(mps[site1], mps[site2], trunc) = tst.split_mps_l2r(Mmax, cutoff);
+            tst.clear();
+
+            this->boundary_left_step(mpo, site1); // creating left_[site2]
+            if (site2 < L-1) {
+                evolve_back(site2, left_[site2], right_[site2+1]);
+                Storage::broadcast::drop(right_[site2+1]);
+            }
+            Storage::broadcast::evict(left_[site1]);
+        } else {
+            boost::tie(mps[site1], mps[site2], trunc) = tst.split_mps_r2l(Mmax, cutoff);
+            tst.clear();
+
+            this->boundary_right_step(mpo, site2); // creating right_[site2]
+            if (site1 > 0) {
+                evolve_back(site1, left_[site1], right_[site2]);
+                Storage::broadcast::drop(left_[site1]);
+            }
+            Storage::broadcast::evict(right_[site2+1]);
+        }
+
+        iteration_results_["BondDimension"]     << trunc.bond_dimension;
+        iteration_results_["TruncatedWeight"]   << trunc.truncated_weight;
+        iteration_results_["TruncatedFraction"] << trunc.truncated_fraction;
+        iteration_results_["SmallestEV"]        << trunc.smallest_ev;
+    }
+
+    // propagate the new center backwards by half a step, it was propagated twice otherwise
+    template <class BoundaryType>
+    void evolve_back(int site, BoundaryType & left, BoundaryType & right)
+    {
+        Storage::broadcast::fetch(left);
+        Storage::broadcast::fetch(right);
+
+        std::tuple<double, MPSTensor<Matrix, SymmGroup>, double> res
+            = evolve_site_problem(mps[site], left, right, mpo[site], -tau/2, real_time, parms, site_ratio[site]);
+        site_ratio[site] = std::get<2>(res);
+        mps[site] = std::get<1>(res);
+    }
+
+    // one-site TDVP: forward step on site, then the bond matrix split off towards the next
+    // site is propagated backwards, unless the half sweep ends here
+    void evolve_site(int sweep, int site, int lr)
+    {
+        std::size_t L = mps.length();
+
+        maquis::cout << std::endl;
+        maquis::cout << "TDVP step " << sweep << ", propagating site " << site << std::endl;
+
+        Storage::broadcast::fetch(left_[site]);
+        Storage::broadcast::fetch(right_[site+1]);
+
+        std::tuple<double, MPSTensor<Matrix, SymmGroup>, double> res
+            = evolve_site_problem(mps[site], left_[site], right_[site+1], mpo[site],
+                                  tau/2, real_time, parms, cpu_gpu_ratio[site]);
+        cpu_gpu_ratio[site] = std::get<2>(res);
+        mps[site] = std::get<1>(res);
+        record_energy(lr, std::get<0>(res));
+
+        if (lr == +1 && site < L-1) {
+            block_matrix<Matrix, SymmGroup> t = mps[site].normalize_left(DefaultSolver());
+            this->boundary_left_step(mpo, site); // creating left_[site+1]
+            evolve_bond_matrix(t, site, mps[site].col_dim(), mps[site+1].row_dim(), left_[site+1], right_[site+1]);
+            mps[site+1].multiply_from_left(t);
+
+            Storage::broadcast::drop(right_[site+1]);
+            Storage::broadcast::evict(left_[site]);
+        }
+        else if (lr == -1 && site > 0) {
+            block_matrix<Matrix, SymmGroup> t = mps[site].normalize_right(DefaultSolver());
+            this->boundary_right_step(mpo, site); // creating right_[site]
+            evolve_bond_matrix(t, site-1, mps[site-1].col_dim(), mps[site].row_dim(), left_[site], right_[site]);
+            mps[site-1].multiply_from_right(t);
+
+            Storage::broadcast::drop(left_[site]);
+            Storage::broadcast::evict(right_[site+1]);
+        }
+
+        iteration_results_["BondDimension"] << mps[site].col_dim().sum_of_sizes();
+    }
+
+    // propagate the bond matrix t between bond and bond+1 backwards by half a step; t is
+    // wrapped into a site tensor with a trivial physical index and bond_mpo[bond] as operator
+    template <class BoundaryType>
+    void evolve_bond_matrix(block_matrix<Matrix, SymmGroup> & t, int bond,
+                            Index<SymmGroup> const & left_i, Index<SymmGroup> const & right_i,
+                            BoundaryType & left, BoundaryType & right)
+    {
+        Storage::broadcast::fetch(left);
+        Storage::broadcast::fetch(right);
+
+        Index<SymmGroup> phys;
+        phys.insert(std::make_pair(SymmGroup::IdentityCharge, 1));
+        MPSTensor<Matrix, SymmGroup> c(phys, left_i, right_i, t, LeftPaired);
+
+        std::tuple<double, MPSTensor<Matrix, SymmGroup>, double> res
+            = evolve_site_problem(c, left, right, bond_mpo[bond], -tau/2, real_time, parms, bond_ratio[bond]);
+        bond_ratio[bond] = std::get<2>(res);
+
+        std::get<1>(res).make_left_paired();
+        t = std::get<1>(res).data();
+    }
+
+    // identity for every MPO bond index between p and p+1, acting on a trivial physical index
+    void make_bond_mpo()
+    {
+        typedef MPOTensor<Matrix, SymmGroup> tensor_t;
+        typedef typename tensor_t::index_type index_type;
+        typedef typename tensor_t::BondProperty BondProperty;
+
+        if (symm_traits::HasSU2<SymmGroup>::value)
+            throw std::runtime_error("one-site tdvp is not implemented for SU2 symmetry, use optimization=twosite\n");
+
+        typename tensor_t::op_table_ptr table(new OPTable<Matrix, SymmGroup>());
+        typename tensor_t::op_t ident;
+        ident.insert_block(Matrix(1, 1, 1.), SymmGroup::IdentityCharge, SymmGroup::IdentityCharge);
+        typename tensor_t::tag_type tag = table->register_op(ident);
+
+        std::size_t L = mps.length();
+        bond_mpo.resize(L-1);
+        for (std::size_t p = 0; p < L-1; ++p) {
+            index_type D = mpo[p+1].row_dim();
+            typename tensor_t::prempo_t terms;
+            for (index_type b = 0; b < D; ++b)
+                terms.push_back(boost::make_tuple(b, b, tag, value_type(1.)));
+            BondProperty bp(mpo[p+1].leftBond().spins(), MPOTensor_detail::Hermitian(D));
+            bond_mpo[p] = tensor_t(D, D, terms, table, bp, bp);
+        }
+    }
+
+    // Replaces the identity end block of right_[L] by the generator of the real time step,
+    // (R, I) -> H (I, -R) for psi = R + iI, and rebuilds the right boundaries from it. The rows
+    // of a right boundary block belong to the ket, as in overlap_mpo_right_step.
+    void init_real_time_boundaries()
+    {
+        std::size_t L = mps.length();
+
+        Storage::drop(right_[L]);
+        right_[L] = mps.right_boundary();
+        for (unsigned ci = 0; ci < right_[L].index().n_cohorts(); ++ci) {
+            if (right_[L].index().left_size(ci) != 2 || right_[L].index().right_size(ci) != 2)
+                throw std::runtime_error("real time tdvp needs the imaginary part on the end index\n");
+            value_type * block = right_[L][ci] + right_[L].index().offset(ci, 0);
+            block[0] = 0.;  block[2] = -1.;
+            block[1] = 1.;  block[3] = 0.;
+        }
+
+        for (int i = L-1; i >= 0; --i) {
+            this->boundary_right_step(mpo, i);
+            Storage::sync();
+            Storage::evict(right_[i+1]);
+        }
+    }
+
+    // in real time the site problems return <psi|K|psi> = 0 for the antisymmetric generator K,
+    // the energy is measured on the full state instead
+    void record_energy(int lr, double e)
+    {
+        if (real_time) return;
+
+        int prec = maquis::cout.precision();
+        maquis::cout.precision(15);
+        maquis::cout << "Energy " << lr << " " << e + mpo.getCoreEnergy() << std::endl;
+        maquis::cout.precision(prec);
+        iteration_results_["Energy"] << e + mpo.getCoreEnergy();
+    }
+
+    MPO<Matrix, SymmGroup> ts_cache_mpo;
+    std::vector<MPOTensor<Matrix, SymmGroup> > bond_mpo;
+    std::vector<double> site_ratio, bond_ratio;
+    double tau;
+    bool real_time, twosite;
+};
+
+// ******   SIMULATION CLASS   ******
+template <class Matrix, class SymmGroup>
+class tdvp_evolver {
+public:
+    tdvp_evolver(DmrgParameters * parms_, MPS<Matrix, SymmGroup> * mps_,
+                 Lattice const& lattice_, Model<Matrix, SymmGroup> const& model_,
+                 int init_sweep=0)
+    : parms(parms_)
+    , mps(mps_)
+    , lattice(lattice_) // shallow copy
+    , model(model_) // shallow copy
+    , mpo(new MPO<Matrix, SymmGroup>(make_mpo(lattice, model)))
+    , real_time(false)
+    {
+        maquis::cout << "Using " << (((*parms)["optimization"] == "twosite") ? "two" : "one")
+                     << "-site TDVP time evolution." << std::endl;
+
+        prepare_te_terms(init_sweep);
+    }
+
+    /// builds the sweeper for imaginary time before nsweeps_img and for real time afterwards;
+    /// its boundaries are built once here and reused by the following steps
+    void prepare_te_terms(unsigned sweep)
+    {
+        dt = (*parms)["dt"];
+
+        bool rt = (sweep >= (*parms)["nsweeps_img"]);
+        if (sweeper && rt == real_time)
+            return;
+        real_time = rt;
+
+        sweeper.reset();
+        if (real_time) {
+            tdvp_detail::add_imaginary_part(*mps);
+            sweep_mpo.reset(new MPO<Matrix, SymmGroup>(tdvp_detail::drop_hermitian(*mpo)));
+        }
+        else
+            sweep_mpo = mpo;
+
+        sweeper.reset(new tdvp_sweep<Matrix, SymmGroup, storage::Controller>(*mps, *sweep_mpo, *parms, real_time));
+    }
+
+    void operator()(unsigned sweep, unsigned nsteps)
+    {
+        sweeper->set_time_step(dt);
+        for (unsigned i=0; i < nsteps; ++i)
+            sweeper->sweep(sweep+i);
+    }
+
+    results_collector const& iteration_results() const
+    {
+        return sweeper->iteration_results();
+    }
+
+private:
+    DmrgParameters * parms;
+    MPS<Matrix, SymmGroup> * mps;
+    Lattice lattice;
+    Model<Matrix,SymmGroup> model;
+    double dt;
+    bool real_time;
+
+    // shared, so that copies of the evolver keep the boundaries valid
+    boost::shared_ptr<MPO<Matrix, SymmGroup> > mpo, sweep_mpo;
+    boost::shared_ptr<tdvp_sweep<Matrix, SymmGroup, storage::Controller> > sweeper;
+};
+
+#endif
@@ -291,7 +291,8 @@ public:
                 half_only = true;
                 std::vector<pos_t> positions;
                 meas.push_back( new measurements::TaggedNRankRDM<Matrix, SymmGroup>(name, lat, tag_handler, ident, fill, synchronous_meas_operators,
-                                                                                    half_only, positions, bra_ckp));
+                                                                                    half_only, positions, bra_ckp,
+                                                                                    parms["rdm_partial_file"].str(), parms["rdm_cache_memory"].as<double>()));
             }
 
             else if (boost::regex_match(lhs, what, expression_threeptdm)) {
@@ -383,7 +384,8 @@ public:
                 half_only = true;
                 std::vector<pos_t> positions;
                 meas.push_back( new measurements::TaggedNRankRDM<Matrix, SymmGroup>(name, lat, tag_handler, ident, fill, synchronous_meas_operators,
-                                                                                    half_only, positions, bra_ckp));
+                                                                                    half_only, positions, bra_ckp,
+                                                                                    parms["rdm_partial_file"].str(), parms["rdm_cache_memory"].as<double>()));
             }
 
             else if (!name.empty()) {
@@ -0,0 +1,166 @@
+/*****************************************************************************
+ *
+ * ALPS MPS DMRG Project
+ *
+ * Copyright (C) 2014 Institute for Theoretical Physics, ETH Zurich
+ *
+ * This software is part of the ALPS Applications, published under the ALPS
+ * Application License; you can use, redistribute it and/or modify it under
+ * the terms of the license, either version 1 or (at your option) any later
+ * version.
+ *
+ * You should have received a copy of the ALPS Application License along with
+ * the ALPS Applications; see the file LICENSE.txt. If not, the license is also
+ * available from http://alps.comp-phys.org/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef QC_CHEM_ORBITAL_ORDERING_H
+#define QC_CHEM_ORBITAL_ORDERING_H
+
+#include <cmath>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <numeric>
+#include <algorithm>
+
+#include "dmrg/utils/BaseParameters.h"
+#include "dmrg/models/chem/util.h"
+#include "dmrg/models/chem/parse_integrals.h"
+
+namespace chem {
+    namespace ordering_detail {
+
+        typedef alps::numeric::matrix<double> weight_matrix;
+
+        /// |(ij|ji)| between orbitals i != j, in the order of the integral file
+        inline weight_matrix exchange_weights(BaseParameters & parms, int L)
+        {
+            std::vector<double> m_raw;
+            std::vector<int>    i_raw;
+            if (parms.is_set("integrals"))
+                detail::parse_buffer(m_raw, i_raw, parms["integrals"]);
+            else
+                detail::parse_file(m_raw, i_raw, parms["integral_file"]);
+
+            weight_matrix W(L, L, 0.);
+            for (std::size_t line = 0; line < m_raw.size(); ++line) {
+                int i = i_raw[4*line]-1, j = i_raw[4*line+1]-1, k = i_raw[4*line+2]-1, l = i_raw[4*line+3]-1;
+                if (i < 0 || j < 0 || i == j)
+                    continue;
+                if ((i == k && j == l) || (i == l && j == k)) {
+                    if (i >= L || j >= L)
+                        throw std::runtime_error("orbital index in the integrals exceeds L\n");
+                    W(i,j) = W(j,i) = std::abs(m_raw[line]);
+                }
+            }
+            return W;
+        }
+
+        /// sum over orbital pairs of W_ij (p_i - p_j)^2, with p the position of an orbital in order
+        inline double cost(std::vector<int> const & order, weight_matrix const & W)
+        {
+            double ret = 0;
+            for (std::size_t p = 0; p < order.size(); ++p)
+                for (std::size_t q = p+1; q < order.size(); ++q)
+                    ret += W(order[p], order[q]) * double(q-p) * double(q-p);
+            return ret;
+        }
+
+        /// orbitals sorted by their component in the Fiedler vector of the graph Laplacian of W
+        inline std::vector<int> fiedler(weight_matrix const & W)
+        {
+            int L = num_rows(W);
+            std::vector<int> order(L);
+            std::iota(order.begin(), order.end(), 0);
+            if (L < 3)
+                return order;
+
+            weight_matrix laplacian(L, L, 0.);
+            for (int i = 0; i < L; ++i)
+                for (int j = 0; j < L; ++j)
+                    if (i != j) {
+                        laplacian(i,j) = -W(i,j);
+                        laplacian(i,i) += W(i,j);
+                    }
+
+            // eigenvalues come in decreasing order, the Fiedler vector belongs to the second smallest
+            weight_matrix evecs;
+            std::vector<double> evals(L);
+            heev(laplacian, evecs, evals);
+
+            std::stable_sort(order.begin(), order.end(),
+                             [&evecs, L](int a, int b) { return evecs(a, L-2) < evecs(b, L-2); });
+            return order;
+        }
+
+        /// Swaps pairs of orbital positions as long as this lowers the cost, at most passes sweeps over all pairs
+        inline void refine(std::vector<int> & order, weight_matrix const & W, int passes)
+        {
+            int L = order.size();
+            for (int pass = 0; pass < passes; ++pass) {
+                bool improved = false;
+                for (int a = 0; a < L; ++a)
+                    for (int b = a+1; b < L; ++b) {
+                        // only the distances of order[a] and order[b] to the other orbitals change
+                        double delta = 0;
+                        for (int q = 0; q < L; ++q) {
+                            if (q == a || q == b) continue;
+                            double da = double(a-q) * (a-q), db = double(b-q) * (b-q);
+                            delta += (W(order[a], order[q]) - W(order[b], order[q])) * (db - da);
+                        }
+                        if (delta < -1e-12) {
+                            std::swap(order[a], order[b]);
+                            improved = true;
+                        }
+                    }
+                if (!improved)
+                    break;
+            }
+        }
+    }
+
+    /// Ordering selected by "orbital_ordering" as a value for "orbital_order". Orbitals with
+    /// a large exchange integral are placed close to each other, which keeps the entanglement
+    /// across the bonds of the MPS and thus the required bond dimension low.
+    inline std::string optimize_orbital_order(BaseParameters & parms)
+    {
+        using namespace ordering_detail;
+
+        if (parms["orbital_ordering"] != "fiedler")
+            throw std::runtime_error("unknown orbital_ordering " + parms["orbital_ordering"].str() + "\n");
+        if (parms["COMPLEX"])
+            throw std::runtime_error("orbital_ordering is only available for real integrals\n");
+
+        int L = parms["L"];
+        weight_matrix W = exchange_weights(parms, L);
+
+        std::vector<int> order(L);
+        std::iota(order.begin(), order.end(), 0);
+        double cost_input = cost(order, W);
+
+        order = fiedler(W);
+        double cost_fiedler = cost(order, W);
+
+        refine(order, W, parms["orbital_ordering_passes"]);
+
+        maquis::cout << "Orbital ordering cost sum |(ij|ji)| (p_i - p_j)^2: " << cost_input << " (integral file), "
+                     << cost_fiedler << " (fiedler), " << cost(order, W) << " (refined)" << std::endl;
+
+        std::ostringstream ret;
+        for (int p = 0; p < L; ++p)
+            ret << (p ? "," : "") << order[p]+1;
+        return ret.str();
+    }
+}
+
+#endif
@@ -65,6 +65,7 @@ public:
             modify(it->lc, irr);
             modify(it->rc, irr);
         }
+        rhs.invalidate_positions();
         return rhs;
     }
 
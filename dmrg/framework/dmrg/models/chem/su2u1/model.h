@@ -167,7 +167,8 @@ public:
 
                 std::vector<pos_t> positions;
                 meas.push_back( new measurements::TaggedNRankRDM<Matrix, SymmGroup>(
-                                name, lat, tag_handler, op_collection, positions, bra_ckp));
+                                name, lat, tag_handler, op_collection, positions, bra_ckp,
+                                parms["rdm_partial_file"].str(), parms["rdm_cache_memory"].as<double>()));
             }
 
             if (boost::regex_match(lhs, what, expression_oneptdm) ||
@@ -183,7 +184,8 @@ public:
 
                 std::vector<pos_t> positions;
                 meas.push_back( new measurements::TaggedNRankRDM<Matrix, SymmGroup>(
-                                name, lat, tag_handler, op_collection, positions, bra_ckp));
+                                name, lat, tag_handler, op_collection, positions, bra_ckp,
+                                parms["rdm_partial_file"].str(), parms["rdm_cache_memory"].as<double>()));
             }
         }
 
@@ -29,6 +29,7 @@
 
 #include "dmrg/models/generate_mpo/mpo_maker.hpp"
 #include "dmrg/models/generate_mpo/tagged_mpo_maker_optim.hpp"
+#include "dmrg/models/generate_mpo/bipartite_mpo_maker.hpp"
 #include "dmrg/models/generate_mpo/corr_maker.hpp"
 #include "dmrg/models/generate_mpo/1D_mpo_maker.hpp"
 
@@ -43,4 +44,21 @@ MPO<Matrix, SymmGroup> make_mpo(Lattice const& lat, Model<Matrix, SymmGroup> & m
     return mpo;
 }
 
+/// MPO construction selected by the parameter mpo_construction
+template<class Matrix, class SymmGroup>
+MPO<Matrix, SymmGroup> make_mpo(Lattice const& lat, Model<Matrix, SymmGroup> & model, BaseParameters & parms)
+{
+    std::string construction = parms["mpo_construction"].str();
+    if (construction == "tagged")
+        return make_mpo(lat, model);
+    else if (construction == "bipartite") {
+        model.create_terms();
+        generate_mpo::BipartiteMPOMaker<Matrix, SymmGroup> mpom(lat, model);
+        maquis::cout << "Bipartite MPO: no hermitian pairs, boundary contractions compute all blocks" << std::endl;
+        return mpom.create_mpo();
+    }
+    else
+        throw std::runtime_error("Unknown mpo_construction: " + construction);
+}
+
 #endif
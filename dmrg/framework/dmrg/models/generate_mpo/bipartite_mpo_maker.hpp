@@ -0,0 +1,408 @@
+/*****************************************************************************
+ *
+ * ALPS MPS DMRG Project
+ *
+ * Copyright (C) 2014 Institute for Theoretical Physics, ETH Zurich
+ *
+ * This software is part of the ALPS Applications, published under the ALPS
+ * Application License; you can use, redistribute it and/or modify it under
+ * the terms of the license, either version 1 or (at your option) any later
+ * version.
+ *
+ * You should have received a copy of the ALPS Application License along with
+ * the ALPS Applications; see the file LICENSE.txt. If not, the license is also
+ * available from http://alps.comp-phys.org/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef GENERATE_MPO_BIPARTITE_MPO_MAKER_H
+#define GENERATE_MPO_BIPARTITE_MPO_MAKER_H
+
+#include "dmrg/models/generate_mpo/utils.hpp"
+
+#include "dmrg/block_matrix/block_matrix.h"
+#include "dmrg/block_matrix/block_matrix_algorithms.h"
+#include "dmrg/block_matrix/symmetry.h"
+
+#include "dmrg/mp_tensors/mpo.h"
+
+#include "dmrg/models/lattice.h"
+#include "dmrg/models/model.h"
+
+#include <vector>
+#include <map>
+#include <queue>
+#include <limits>
+#include <stdexcept>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/tuple/tuple_comparison.hpp>
+
+namespace generate_mpo
+{
+    namespace bipartite_detail {
+
+        /// Maximum matching (Hopcroft-Karp) of a bipartite graph, adj[u] lists the right
+        /// vertices adjacent to the left vertex u
+        class matching
+        {
+        public:
+            static constexpr std::size_t none = std::size_t(-1);
+
+            matching(std::vector<std::vector<std::size_t> > const & adj_, std::size_t n_right)
+            : adj(adj_), match_l(adj_.size(), none), match_r(n_right, none), dist(adj_.size())
+            {
+                while (bfs())
+                    for (std::size_t u = 0; u < adj.size(); ++u)
+                        if (match_l[u] == none)
+                            dfs(u);
+            }
+
+            /// Koenig's theorem: with Z the vertices reachable from unmatched left vertices over
+            /// alternating paths, (left \ Z) + (right & Z) is a minimum vertex cover
+            void vertex_cover(std::vector<bool> & left_cover, std::vector<bool> & right_cover) const
+            {
+                std::vector<bool> left_seen(adj.size(), false), right_seen(match_r.size(), false);
+                std::queue<std::size_t> q;
+                for (std::size_t u = 0; u < adj.size(); ++u)
+                    if (match_l[u] == none) {
+                        left_seen[u] = true;
+                        q.push(u);
+                    }
+
+                while (!q.empty()) {
+                    std::size_t u = q.front(); q.pop();
+                    for (std::size_t k = 0; k < adj[u].size(); ++k) {
+                        std::size_t v = adj[u][k];
+                        if (right_seen[v] || match_l[u] == v)
+                            continue;
+                        right_seen[v] = true;
+                        std::size_t w = match_r[v];
+                        if (w != none && !left_seen[w]) {
+                            left_seen[w] = true;
+                            q.push(w);
+                        }
+                    }
+                }
+
+                left_cover.resize(adj.size());
+                right_cover = right_seen;
+                for (std::size_t u = 0; u < adj.size(); ++u)
+                    left_cover[u] = !left_seen[u];
+            }
+
+        private:
+            bool bfs()
+            {
+                std::queue<std::size_t> q;
+                for (std::size_t u = 0; u < adj.size(); ++u) {
+                    dist[u] = (match_l[u] == none) ? 0 : none;
+                    if (match_l[u] == none)
+                        q.push(u);
+                }
+
+                bool found = false;
+                while (!q.empty()) {
+                    std::size_t u = q.front(); q.pop();
+                    for (std::size_t k = 0; k < adj[u].size(); ++k) {
+                        std::size_t w = match_r[adj[u][k]];
+                        if (w == none)
+                            found = true;
+                        else if (dist[w] == none) {
+                            dist[w] = dist[u] + 1;
+                            q.push(w);
+                        }
+                    }
+                }
+                return found;
+            }
+
+            bool dfs(std::size_t u)
+            {
+                for (std::size_t k = 0; k < adj[u].size(); ++k) {
+                    std::size_t v = adj[u][k], w = match_r[v];
+                    if (w == none || (dist[w] == dist[u] + 1 && dfs(w))) {
+                        match_l[u] = v;
+                        match_r[v] = u;
+                        return true;
+                    }
+                }
+                dist[u] = none;
+                return false;
+            }
+
+            std::vector<std::vector<std::size_t> > const & adj;
+            std::vector<std::size_t> match_l, match_r, dist;
+        };
+    }
+
+    /// MPO construction with the minimal bond dimension per cut for the given sweep order.
+    ///
+    /// Sweeping from the left, every term crossing the cut after site p is split into its
+    /// left part, (bond index at cut p, operator on p), and its right part, the operators still
+    /// to come. Both parts are vertices of a bipartite graph whose edges are the terms. A bond
+    /// index is created for every vertex of a minimum vertex cover: a left vertex carries its
+    /// operator string to the right and passes the coefficients on, a right vertex absorbs the
+    /// coefficients of all uncovered edges into the sum of left operators attached to it.
+    ///
+    /// Fillings and identities between the operators of a term follow TaggedMPOMaker. Bond spins
+    /// are part of the right vertex, so SU2 bond indices keep a unique spin. Hermitian partners
+    /// of bond indices are not recorded: a right vertex index is a sum over left operator strings,
+    /// and its conjugate is in general not another bond index. The boundary contractions therefore
+    /// compute all blocks, where TaggedMPOMaker skips the conjugate half of every paired index.
+    template<class Matrix, class SymmGroup>
+    class BipartiteMPOMaker
+    {
+        typedef typename Matrix::value_type scale_type;
+        typedef typename MPOTensor<Matrix, SymmGroup>::index_type index_type;
+        typedef typename MPOTensor<Matrix, SymmGroup>::prempo_t prempo_t;
+        typedef typename OPTable<Matrix, SymmGroup>::op_t op_t;
+
+        typedef Lattice::pos_t pos_t;
+        typedef typename OperatorTagTerm<Matrix, SymmGroup>::tag_type tag_type;
+        typedef ::term_descriptor<typename Matrix::value_type> term_descriptor;
+        typedef std::vector<tag_type> tag_vec;
+        typedef SpinDescriptor<typename symm_traits::SymmType<SymmGroup>::type> spin_desc_t;
+
+        // operators of a term right of the current cut
+        struct right_part
+        {
+            std::vector<std::pair<pos_t, tag_type> > ops;
+            bool full_identity;
+
+            bool operator<(right_part const & rhs) const
+            {
+                if (full_identity != rhs.full_identity) return full_identity < rhs.full_identity;
+                return ops < rhs.ops;
+            }
+        };
+
+        // terms crossing a cut, by bond index and right part
+        typedef std::map<std::pair<index_type, right_part>, scale_type> open_terms;
+
+    public:
+        BipartiteMPOMaker(Lattice const& lat_, Model<Matrix,SymmGroup> const& model)
+        : lat(lat_)
+        , length(lat.size())
+        , tag_handler(model.operators_table())
+        , verbose(true)
+        , core_energy(0.)
+        {
+            for (size_t p = 0; p <= lat.maximum_vertex_type(); ++p)
+            {
+                identities.push_back(model.identity_matrix_tag(p));
+                fillings.push_back(model.filling_matrix_tag(p));
+                try { identities_full.push_back(model.get_operator_tag("ident_full", p)); }
+                catch (std::runtime_error const & e) {}
+            }
+
+            typename Model<Matrix, SymmGroup>::terms_type const& terms = model.hamiltonian_terms();
+            for (typename Model<Matrix, SymmGroup>::terms_type::const_iterator it = terms.begin(); it != terms.end(); ++it)
+                add_term(*it);
+        }
+
+        void add_term(term_descriptor term)
+        {
+            std::sort(term.begin(), term.end(), pos_tag_lt());
+
+            for (std::size_t i = 1; i < term.size(); ++i)
+                if (term.position(i) == term.position(i-1))
+                    throw std::runtime_error("BipartiteMPOMaker: term with two operators on site "
+                                             + boost::lexical_cast<std::string>(term.position(i)));
+
+            if (term.size() == 1) {
+                add_1term(term);
+                return;
+            }
+
+            right_part rp;
+            for (std::size_t i = 0; i < term.size(); ++i)
+                rp.ops.push_back(std::make_pair(pos_t(term.position(i)), term.operator_tag(i)));
+
+            // TaggedMPOMaker switches to the full identity where the spin of the operators so far exceeds 1
+            spin_desc_t mpo_spin;
+            rp.full_identity = false;
+            for (std::size_t i = 0; i+1 < term.size(); ++i) {
+                mpo_spin = couple(mpo_spin, tag_handler->get_op(term.operator_tag(i)).spin());
+                if (mpo_spin.get() > 1)
+                    rp.full_identity = (int(term.full_identity) != -1);
+            }
+
+            terms[std::make_pair(index_type(0), rp)] += term.coeff;
+        }
+
+        MPO<Matrix, SymmGroup> create_mpo()
+        {
+            open_terms current = terms;
+            for (typename std::map<pos_t, op_t>::const_iterator it = site_terms.begin(); it != site_terms.end(); ++it) {
+                right_part rp;
+                rp.ops.push_back(std::make_pair(it->first, tag_handler->register_op(it->second, tag_detail::bosonic)));
+                rp.full_identity = false;
+                current[std::make_pair(index_type(0), rp)] += 1.;
+            }
+            if (current.empty())
+                throw std::runtime_error("BipartiteMPOMaker: the Hamiltonian has no operator terms");
+
+            MPO<Matrix, SymmGroup> mpo; mpo.reserve(length);
+            MPOTensor_detail::BondProperty<SymmGroup> left_bond;
+
+            for (pos_t p = 0; p < length; ++p) {
+                // left vertices: (bond index, operator on p), right vertices: (right part, bond spin)
+                std::map<std::pair<index_type, tag_type>, std::size_t> left_ids;
+                std::map<std::pair<right_part, int>, std::size_t> right_ids;
+                std::vector<std::pair<index_type, tag_type> > left_vertices;
+                std::vector<right_part const *> right_vertices;
+                std::vector<spin_desc_t> left_spins, right_spins;
+                std::map<std::pair<std::size_t, std::size_t>, scale_type> edges;
+
+                for (typename open_terms::const_iterator it = current.begin(); it != current.end(); ++it) {
+                    index_type a = it->first.first;
+                    right_part rest = it->first.second;
+
+                    tag_type op;
+                    if (!rest.ops.empty() && rest.ops.front().first == p) {
+                        op = rest.ops.front().second;
+                        rest.ops.erase(rest.ops.begin());
+                    }
+                    else
+                        op = filling(p, rest, left_bond.spin(a));
+                    spin_desc_t out_spin = couple(left_bond.spin(a), tag_handler->get_op(op).spin());
+
+                    std::pair<typename std::map<std::pair<index_type, tag_type>, std::size_t>::iterator, bool> lv
+                        = left_ids.insert(std::make_pair(std::make_pair(a, op), left_vertices.size()));
+                    if (lv.second) {
+                        left_vertices.push_back(std::make_pair(a, op));
+                        left_spins.push_back(out_spin);
+                    }
+
+                    std::pair<typename std::map<std::pair<right_part, int>, std::size_t>::iterator, bool> rv
+                        = right_ids.insert(std::make_pair(std::make_pair(rest, out_spin.get()), right_vertices.size()));
+                    if (rv.second) {
+                        right_vertices.push_back(&rv.first->first.first);
+                        right_spins.push_back(out_spin);
+                    }
+
+                    edges[std::make_pair(lv.first->second, rv.first->second)] += it->second;
+                }
+
+                std::vector<std::vector<std::size_t> > adj(left_vertices.size());
+                for (typename std::map<std::pair<std::size_t, std::size_t>, scale_type>::const_iterator
+                     e = edges.begin(); e != edges.end(); ++e)
+                    adj[e->first.first].push_back(e->first.second);
+
+                // after the last site only the empty right part is left, it closes all terms
+                std::vector<bool> left_cover(left_vertices.size(), false), right_cover(right_vertices.size(), true);
+                if (p < length-1)
+                    bipartite_detail::matching(adj, right_vertices.size()).vertex_cover(left_cover, right_cover);
+
+                index_type next_bond = 0;
+                std::vector<index_type> left_bonds(left_vertices.size()), right_bonds(right_vertices.size());
+                std::vector<spin_desc_t> bond_spins;
+                for (std::size_t u = 0; u < left_vertices.size(); ++u)
+                    if (left_cover[u]) {
+                        left_bonds[u] = next_bond++;
+                        bond_spins.push_back(left_spins[u]);
+                    }
+                for (std::size_t v = 0; v < right_vertices.size(); ++v)
+                    if (right_cover[v]) {
+                        right_bonds[v] = next_bond++;
+                        bond_spins.push_back(right_spins[v]);
+                    }
+
+                std::map<boost::tuple<index_type, index_type, tag_type>, scale_type> entries;
+                open_terms next;
+                for (typename std::map<std::pair<std::size_t, std::size_t>, scale_type>::const_iterator
+                     e = edges.begin(); e != edges.end(); ++e)
+                {
+                    std::size_t u = e->first.first, v = e->first.second;
+                    index_type a = left_vertices[u].first;
+                    tag_type op = left_vertices[u].second;
+                    if (e->second == scale_type(0.))
+                        continue;
+
+                    if (left_cover[u]) {
+                        entries[boost::make_tuple(a, left_bonds[u], op)] = 1.;
+                        next[std::make_pair(left_bonds[u], *right_vertices[v])] += e->second;
+                    }
+                    else {
+                        entries[boost::make_tuple(a, right_bonds[v], op)] += e->second;
+                        next[std::make_pair(right_bonds[v], *right_vertices[v])] = 1.;
+                    }
+                }
+
+                prempo_t pre_tensor; pre_tensor.reserve(entries.size());
+                for (typename std::map<boost::tuple<index_type, index_type, tag_type>, scale_type>::const_iterator
+                     it = entries.begin(); it != entries.end(); ++it)
+                    pre_tensor.push_back(boost::make_tuple(boost::get<0>(it->first), boost::get<1>(it->first),
+                                                           boost::get<2>(it->first), it->second));
+
+                MPOTensor_detail::BondProperty<SymmGroup> right_bond(next_bond);
+                right_bond.spins() = bond_spins;
+
+                if (verbose)
+                    maquis::cout << "MPO Bond " << p << ": " << next_bond << "/0" << std::endl;
+
+                mpo.push_back(MPOTensor<Matrix, SymmGroup>(left_bond.size(), next_bond, pre_tensor,
+                                                           tag_handler->get_operator_table(), left_bond, right_bond));
+                std::swap(left_bond, right_bond);
+                std::swap(current, next);
+            }
+
+            mpo.setCoreEnergy(core_energy);
+            return mpo;
+        }
+
+    private:
+        void add_1term(term_descriptor const& term)
+        {
+            /// Due to numerical instability: treat the core energy separately
+            if (term.operator_tag(0) == identities[lat.get_prop<int>("type", term.position(0))])
+                core_energy += double(alps::numeric::real(term.coeff));
+
+            else {
+                op_t current_op = tag_handler->get_op(term.operator_tag(0));
+                current_op *= term.coeff;
+                site_terms[term.position(0)] += current_op;
+            }
+        }
+
+        // operator on site p of a term without an operator there
+        tag_type filling(pos_t p, right_part const & rest, spin_desc_t const & spin) const
+        {
+            int type = lat.get_prop<int>("type", p);
+
+            int nferm = 0;
+            for (std::size_t i = 0; i < rest.ops.size(); ++i)
+                if (tag_handler->is_fermionic(rest.ops[i].second))
+                    ++nferm;
+
+            if (nferm % 2 == 1)
+                return fillings[type];
+            if (rest.full_identity && spin.get() > 1)
+                return identities_full[type];
+            return identities[type];
+        }
+
+        Lattice const& lat;
+        pos_t length;
+
+        boost::shared_ptr<TagHandler<Matrix, SymmGroup> > tag_handler;
+        tag_vec identities, identities_full, fillings;
+
+        open_terms terms;
+        std::map<pos_t, op_t> site_terms;
+
+        bool verbose;
+        double core_energy;
+    };
+}
+
+#endif
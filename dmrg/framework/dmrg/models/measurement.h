@@ -38,6 +38,7 @@
 
 #include <vector>
 #include <string>
+#include <functional>
 #include <sstream>
 #include <iostream>
 
@@ -54,6 +55,7 @@ class measurement {
 public:
     typedef typename Matrix::value_type value_type;
     typedef typename OPTable<Matrix, SymmGroup>::op_t op_t;
+    typedef std::function<void(std::vector<Lattice::pos_t> const&, value_type)> visitor_type;
     
     measurement(std::string const& n="")
     : cast_to_real(true), is_super_meas(false), name_(n), eigenstate(0)
@@ -69,6 +71,8 @@ public:
     void write_xml(alps::oxstream &) const;
     virtual void print(std::ostream& os) const;
     virtual void extract(std::vector<value_type> & results, std::vector<std::vector<Lattice::pos_t> > & labels) { }
+    /// Hands every labelled result to f, in the order of the vector extract
+    virtual void extract(visitor_type const & f);
     
     std::string const& name() const { return name_; }
     int& eigenstate_index() { return eigenstate; }
@@ -156,6 +160,16 @@ void measurement<Matrix, SymmGroup>::write_xml(alps::oxstream & out) const
 }
 
 
+template<class Matrix, class SymmGroup>
+void measurement<Matrix, SymmGroup>::extract(visitor_type const & f)
+{
+    std::vector<value_type> res;
+    std::vector<std::vector<Lattice::pos_t> > lab;
+    extract(res, lab);
+    for (std::size_t i = 0; i < res.size(); ++i)
+        f(lab[i], res[i]);
+}
+
 template<class Matrix, class SymmGroup>
 void measurement<Matrix, SymmGroup>::set_super_meas(Index<SymmGroup> const& phys_psi_)
 {
@@ -32,6 +32,7 @@
 #include "dmrg/models/meas_prepare.hpp"
 #include "dmrg/mp_tensors/mps_mpo_ops.h"
 #include "dmrg/mp_tensors/super_mpo.h"
+#include "dmrg/optimize/solver_interface.hpp"
 
 namespace measurements {
     
@@ -79,45 +80,11 @@ namespace measurements {
         {
             this->vector_results.clear();
             this->labels.clear();
-            
-            typedef typename SymmGroup::subcharge subcharge;
-
-            evaluate_with_mpo(mps);
-
-            // disabled, because site_hamil (matrix vector prod) is no longer exposed)
 
-            //if (!rmps || this->is_super_meas || is_bond) {
-            //    evaluate_with_mpo(mps);
-            //} else {
-            //    throw std::runtime_error("not implemented\n");
-
-                /// compute local reduced density matrices
-                //rmps.get().init();
-                //
-                //std::size_t L = mps.size();
-                //this->vector_results.reserve(this->vector_results.size() + L);
-                //this->labels.reserve(this->labels.size() + L);
-                //
-                //for (typename Lattice::pos_t p = 0; p < L; ++p) {
-                //    
-                //    subcharge type = lattice.get_prop<subcharge>("type", p);
-                //    if (site_term[type].n_blocks() > 0) {
-
-                //        MPOTensor<Matrix, SymmGroup> temp;
-                //        temp.set(0, 0, site_term[type]);
-                //        
-                //        MPSTensor<Matrix, SymmGroup> mpsp = mps[p];
-                //        MPSTensor<Matrix, SymmGroup> vec2
-                //        = contraction::Engine<Matrix, AlignedMatrix, SymmGroup>::
-                //            site_hamil(mpsp, rmps.get().left(p), rmps.get().right(p), temp);
-                //        
-                //        typename MPS<Matrix, SymmGroup>::scalar_type res = mpsp.scalar_overlap(vec2);
-                //        
-                //        this->vector_results.push_back(res);
-                //        this->labels.push_back( lattice.get_prop<std::string>("label", p) );
-                //    }
-                //}
-            //}
+            if (this->is_super_meas || is_bond)
+                evaluate_with_mpo(mps);
+            else
+                evaluate_at_center(mps);
         }
         
     protected:
@@ -126,6 +93,44 @@ namespace measurements {
             return new local(*this);
         }
         
+        /// moves the orthogonality center through the chain, at the center both environments
+        /// are identities and every site value is a single local contraction
+        void evaluate_at_center(MPS<Matrix, SymmGroup> const& mps)
+        {
+            typedef typename SymmGroup::subcharge subcharge;
+            typedef typename maquis::traits::aligned_matrix<Matrix, maquis::aligned_allocator, ALIGNMENT>::type AlignedMatrix;
+            typedef std::map<std::string, typename Matrix::value_type> result_type;
+            result_type res;
+
+            MPS<Matrix, SymmGroup> psi = mps;
+            psi.canonize(0);
+
+            for (typename Lattice::pos_t p = 0; p < psi.length(); ++p) {
+                if (p > 0)
+                    psi.move_normalization_l2r(p-1, p);
+
+                subcharge type = lattice.get_prop<subcharge>("type", p);
+                if (site_term[type].n_blocks() == 0)
+                    continue;
+
+                MPOTensor<Matrix, SymmGroup> temp;
+                temp.set(0, 0, site_term[type]);
+
+                Boundary<AlignedMatrix, SymmGroup> left(psi[p].row_dim(), psi[p].row_dim(), 1),
+                                                   right(psi[p].col_dim(), psi[p].col_dim(), 1);
+                typename Matrix::value_type val = site_expval(psi[p], left, right, temp);
+                res[lattice.get_prop<std::string>("label", p)] += (this->cast_to_real) ? maquis::real(val) : val;
+            }
+
+            /// same label order as evaluate_with_mpo
+            this->vector_results.reserve(this->vector_results.size() + res.size());
+            this->labels.reserve(this->labels.size() + res.size());
+            for (typename result_type::const_iterator it = res.begin(); it != res.end(); ++it) {
+                this->labels.push_back(it->first);
+                this->vector_results.push_back(it->second);
+            }
+        }
+
         void evaluate_with_mpo(MPS<Matrix, SymmGroup> const& mps)
         {
             typedef typename SymmGroup::subcharge subcharge;
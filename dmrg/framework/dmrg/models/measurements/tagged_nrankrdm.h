@@ -31,11 +31,16 @@
 
 #include <algorithm>
 #include <functional>
+#include <fstream>
+#include <numeric>
 #include <boost/iterator/counting_iterator.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/functional/hash.hpp>
 
 #include "dmrg/block_matrix/symmetry/nu1pg.h"
 #include "dmrg/models/measurement.h"
+#include "dmrg/mp_tensors/expval_cache.h"
+#include "dmrg/utils/parallel/utils.hpp"
 
 #include "dmrg/models/chem/su2u1/term_maker.h"
 
@@ -84,6 +89,161 @@ namespace measurements_details {
         }
     };
 
+    // hash of the tensor elements in left paired form, identifies the state an RDM was measured on
+    template <class Matrix, class SymmGroup>
+    std::size_t mps_fingerprint(MPS<Matrix, SymmGroup> const & mps)
+    {
+        std::size_t seed = mps.length();
+        for (std::size_t p = 0; p < mps.length(); ++p)
+        {
+            mps[p].make_left_paired();
+            block_matrix<Matrix, SymmGroup> const & data = mps[p].data();
+            std::vector<const typename Matrix::value_type*> view = data.data_view();
+            std::vector<std::size_t> sizes = data.basis().sizes();
+            for (std::size_t b = 0; b < view.size(); ++b)
+            {
+                boost::hash_combine(seed, sizes[b]);
+                boost::hash_combine(seed, boost::hash_range(view[b], view[b] + sizes[b]));
+            }
+        }
+        return seed;
+    }
+
+    // Hands out the tasks of an RDM measurement longest first and collects their results in
+    // preallocated per-task slots, so that no thread waits for another one to store its results.
+    // Finished tasks are appended to the partial result file, if given, from which an interrupted
+    // measurement resumes. The file starts with the id of the measurement and the state (see
+    // partial_id), a file with another id is discarded. The file is removed once all tasks are collected.
+    template <class T>
+    class rdm_scheduler
+    {
+    public:
+        typedef Lattice::pos_t pos_t;
+        typedef std::vector<pos_t> positions_type;
+
+        rdm_scheduler(std::vector<double> const & cost, std::string const & partial_, std::string const & id_)
+        : order(cost.size())
+        , values(cost.size())
+        , labels(cost.size())
+        , done(cost.size(), 0)
+        , partial(partial_)
+        , id(id_ + " " + std::to_string(cost.size()))
+        {
+            std::iota(order.begin(), order.end(), 0);
+            std::stable_sort(order.begin(), order.end(),
+                             [&cost](std::size_t a, std::size_t b) { return cost[a] > cost[b]; });
+
+            if (partial != "" && !(boost::filesystem::exists(partial) && load()))
+                write_id();
+        }
+
+        std::size_t size() const { return order.size(); }
+
+        // k-th task in longest-first order
+        std::size_t task(std::size_t k) const { return order[k]; }
+
+        bool finished(std::size_t t) const { return done[t]; }
+
+        void store(std::size_t t, std::vector<T> & v, std::vector<positions_type> & l)
+        {
+            values[t].swap(v);
+            labels[t].swap(l);
+            done[t] = 1;
+
+            if (partial != "")
+            {
+                #ifdef MAQUIS_OPENMP
+                #pragma omp critical (rdm_partial_results)
+                #endif
+                append(t);
+            }
+        }
+
+        // results in task order, each task in reverse order of evaluation
+        void collect(std::vector<T> & res, std::vector<positions_type> & lab)
+        {
+            std::size_t n = 0;
+            for (std::size_t t = 0; t < values.size(); ++t)
+                n += values[t].size();
+
+            res.reserve(res.size() + n);
+            lab.reserve(lab.size() + n);
+            for (std::size_t t = 0; t < values.size(); ++t)
+            {
+                std::copy(values[t].rbegin(), values[t].rend(), std::back_inserter(res));
+                std::copy(labels[t].rbegin(), labels[t].rend(), std::back_inserter(lab));
+            }
+
+            if (partial != "")
+                boost::filesystem::remove(partial);
+        }
+
+    private:
+        // record: task, number of elements, number of positions, positions, values
+        void append(std::size_t t)
+        {
+            std::ofstream ofs(partial.c_str(), std::ios::binary | std::ios::app);
+            uint64_t head[3] = { t, values[t].size(), labels[t].size() ? labels[t][0].size() : 0 };
+            ofs.write(reinterpret_cast<const char*>(head), sizeof(head));
+            for (std::size_t i = 0; i < labels[t].size(); ++i)
+                ofs.write(reinterpret_cast<const char*>(labels[t][i].data()), head[2] * sizeof(pos_t));
+            ofs.write(reinterpret_cast<const char*>(values[t].data()), head[1] * sizeof(T));
+        }
+
+        // header: length of the id, id
+        void write_id()
+        {
+            std::ofstream ofs(partial.c_str(), std::ios::binary | std::ios::trunc);
+            uint64_t n = id.size();
+            ofs.write(reinterpret_cast<const char*>(&n), sizeof(n));
+            ofs.write(id.data(), n);
+        }
+
+        // false if the file belongs to another measurement or state,
+        // a truncated last record is ignored and its task evaluated again
+        bool load()
+        {
+            std::ifstream ifs(partial.c_str(), std::ios::binary);
+            uint64_t n = 0;
+            std::string file_id;
+            if (ifs.read(reinterpret_cast<char*>(&n), sizeof(n)) && n == id.size()) {
+                file_id.resize(n);
+                ifs.read(&file_id[0], n);
+            }
+            if (!ifs || file_id != id) {
+                maquis::cout << "Discarding " << partial << ", it was written for another measurement or state" << std::endl;
+                return false;
+            }
+
+            uint64_t head[3];
+            std::size_t n_loaded = 0;
+            while (ifs.read(reinterpret_cast<char*>(head), sizeof(head)))
+            {
+                if (head[0] >= done.size())
+                    throw std::runtime_error("partial RDM results in " + partial + " do not match the measurement\n");
+
+                std::vector<positions_type> l(head[1], positions_type(head[2]));
+                std::vector<T> v(head[1]);
+                for (std::size_t i = 0; i < l.size(); ++i)
+                    ifs.read(reinterpret_cast<char*>(l[i].data()), head[2] * sizeof(pos_t));
+                ifs.read(reinterpret_cast<char*>(v.data()), head[1] * sizeof(T));
+                if (!ifs) break;
+
+                values[head[0]].swap(v);
+                labels[head[0]].swap(l);
+                done[head[0]] = 1;
+                ++n_loaded;
+            }
+            maquis::cout << "Resuming from " << n_loaded << " finished tasks in " << partial << std::endl;
+            return true;
+        }
+
+        std::vector<std::size_t> order;
+        std::vector<std::vector<T> > values;
+        std::vector<std::vector<positions_type> > labels;
+        std::vector<char> done;
+        std::string partial, id;
+    };
 }
 
 namespace measurements {
@@ -111,7 +271,9 @@ namespace measurements {
                        boost::shared_ptr<TagHandler<Matrix, SymmGroup> > tag_handler_,
                        tag_vec const & identities_, tag_vec const & fillings_, std::vector<scaled_bond_term> const& ops_,
                        bool half_only_, positions_type const& positions_ = positions_type(),
-                       std::string const& ckp_ = std::string(""))
+                       std::string const& ckp_ = std::string(""),
+                       std::string const& partial_ = std::string(""),
+                       double cache_mb = 256.)
         : base(name_)
         , lattice(lat)
         , tag_handler(tag_handler_)
@@ -120,6 +282,8 @@ namespace measurements {
         , fillings(fillings_)
         , operator_terms(ops_)
         , bra_ckp(ckp_)
+        , partial(partial_)
+        , cache_bytes(static_cast<std::size_t>(cache_mb * 1024 * 1024))
         {
             pos_t extent = operator_terms.size() > 2 ? lattice.size() : lattice.size()-1;
             if (positions_first.size() == 0)
@@ -176,10 +340,21 @@ namespace measurements {
             bool bra_neq_ket = (dummy_bra_mps.length() > 0);
             MPS<Matrix, SymmGroup> const & bra_mps = (bra_neq_ket) ? dummy_bra_mps : ket_mps;
 
+            // one task per p1, cost ~ number of elements x operator span
+            std::vector<double> cost(positions_first.size());
+            for (std::size_t i = 0; i < positions_first.size(); ++i)
+                cost[i] = double(lattice.size() - positions_first[i]) * (lattice.size() - positions_first[i]);
+
+            measurements_details::rdm_scheduler<typename MPS<Matrix, SymmGroup>::scalar_type>
+                schedule(cost, partial_file(), partial_id(dummy_bra_mps, ket_mps));
+
             #ifdef MAQUIS_OPENMP
-            #pragma omp parallel for
+            #pragma omp parallel for schedule(dynamic)
             #endif
-            for (std::size_t i = 0; i < positions_first.size(); ++i) {
+            for (std::size_t k = 0; k < schedule.size(); ++k) {
+                std::size_t i = schedule.task(k);
+                if (schedule.finished(i)) continue;
+
                 pos_t p1 = positions_first[i];
                 boost::shared_ptr<TagHandler<Matrix, SymmGroup> > tag_handler_local(new TagHandler<Matrix, SymmGroup>(*tag_handler));
 
@@ -210,20 +385,10 @@ namespace measurements {
                     }
                 }
 
-                std::vector<std::string> lbt = label_strings(lattice,  num_labels);
-
-                // save results and labels
-                #ifdef MAQUIS_OPENMP
-                #pragma omp critical
-                #endif
-                {
-                    this->vector_results.reserve(this->vector_results.size() + dct.size());
-                    std::copy(dct.rbegin(), dct.rend(), std::back_inserter(this->vector_results));
-
-                    this->labels.reserve(this->labels.size() + dct.size());
-                    std::copy(lbt.rbegin(), lbt.rend(), std::back_inserter(this->labels));
-                }
+                schedule.store(i, dct, num_labels);
             }
+
+            collect(schedule);
         }
 
         void measure_2rdm(MPS<Matrix, SymmGroup> const & dummy_bra_mps,
@@ -233,14 +398,33 @@ namespace measurements {
             bool bra_neq_ket = (dummy_bra_mps.length() > 0);
             MPS<Matrix, SymmGroup> const & bra_mps = (bra_neq_ket) ? dummy_bra_mps : ket_mps;
 
+            // one task per (p1, p2)
+            pos_t L = lattice.size();
+            std::vector<double> cost(L * L);
+            for (pos_t p1 = 0; p1 < L; ++p1)
+            for (pos_t p2 = 0; p2 < L; ++p2)
+                cost[p1 * L + p2] = rdm2_cost(bra_neq_ket ? 0 : std::min(p1, p2));
+
+            measurements_details::rdm_scheduler<typename MPS<Matrix, SymmGroup>::scalar_type>
+                schedule(cost, partial_file(), partial_id(dummy_bra_mps, ket_mps));
+
             #ifdef MAQUIS_OPENMP
-            #pragma omp parallel for collapse(1)
+            #pragma omp parallel for schedule(dynamic)
             #endif
-            for (pos_t p1 = 0; p1 < lattice.size(); ++p1)
-            for (pos_t p2 = 0; p2 < lattice.size(); ++p2)
+            for (std::size_t k = 0; k < schedule.size(); ++k)
             {
+                std::size_t t = schedule.task(k);
+                if (schedule.finished(t)) continue;
+
+                pos_t p1 = t / L, p2 = t % L;
                 boost::shared_ptr<TagHandler<Matrix, SymmGroup> > tag_handler_local(new TagHandler<Matrix, SymmGroup>(*tag_handler));
 
+                // consecutive elements share the boundaries up to the first differing operator
+                std::vector<expval_cache<Matrix, SymmGroup> > expvals;
+                expvals.reserve(operator_terms.size());
+                for (std::size_t synop = 0; synop < operator_terms.size(); ++synop)
+                    expvals.emplace_back(bra_mps, ket_mps, !bra_neq_ket, cache_bytes / operator_terms.size());
+
                 // Permutation symmetry for bra == ket: pqrs == rspq == qpsr == srqp
                 // if bra != ket, pertmutation symmetry is only pqrs == qpsr
                 pos_t subref = 0;
@@ -249,11 +433,11 @@ namespace measurements {
                 else
                     subref = std::min(p1, p2);
 
+                std::vector<typename MPS<Matrix, SymmGroup>::scalar_type> dct;
+                std::vector<std::vector<pos_t> > num_labels;
+
                 for (pos_t p3 = subref; p3 < lattice.size(); ++p3)
                 { 
-                    std::vector<typename MPS<Matrix, SymmGroup>::scalar_type> dct;
-                    std::vector<std::vector<pos_t> > num_labels;
-
                     for (pos_t p4 = p3; p4 < lattice.size(); ++p4)
                     { 
                         pos_t pos_[4] = {p1, p2, p3, p4};
@@ -277,7 +461,7 @@ namespace measurements {
                             {
                                 checkpass = true;
                                 MPO<Matrix, SymmGroup> mpo = generate_mpo::sign_and_fill(term, identities, fillings, tag_handler_local, lattice);
-                                value += operator_terms[synop].second * expval(bra_mps, ket_mps, mpo, !bra_neq_ket);
+                                value += operator_terms[synop].second * expvals[synop](mpo);
                             }
                             else break;
                         }
@@ -287,22 +471,12 @@ namespace measurements {
                              num_labels.push_back(positions);
                         }
                     }
-
-                    std::vector<std::string> lbt = label_strings(lattice,  num_labels);
-
-                    // save results and labels
-                    #ifdef MAQUIS_OPENMP
-                    #pragma omp critical
-                    #endif
-                    {
-                        this->vector_results.reserve(this->vector_results.size() + dct.size());
-                        std::copy(dct.rbegin(), dct.rend(), std::back_inserter(this->vector_results));
-
-                        this->labels.reserve(this->labels.size() + dct.size());
-                        std::copy(lbt.rbegin(), lbt.rend(), std::back_inserter(this->labels));
-                    }
                 }
+
+                schedule.store(t, dct, num_labels);
             }
+
+            collect(schedule);
         }
 
         void measure_3rdm(MPS<Matrix, SymmGroup> const & dummy_bra_mps,
@@ -312,19 +486,41 @@ namespace measurements {
             bool bra_neq_ket = (dummy_bra_mps.length() > 0);
             MPS<Matrix, SymmGroup> const & bra_mps = (bra_neq_ket) ? dummy_bra_mps : ket_mps;
 
+            // one task per (p1, p2 <= p1)
+            std::vector<std::pair<pos_t, pos_t> > tasks;
+            std::vector<double> cost;
+            for (pos_t p1 = 0; p1 < lattice.size(); ++p1)
+            for (pos_t p2 = 0; p2 <= p1; ++p2)
+            {
+                tasks.push_back(std::make_pair(p1, p2));
+                cost.push_back(rdm3_cost(p2, bra_neq_ket ? 0 : p2));
+            }
+
+            measurements_details::rdm_scheduler<typename MPS<Matrix, SymmGroup>::scalar_type>
+                schedule(cost, partial_file(), partial_id(dummy_bra_mps, ket_mps));
+
             // if bra != ket, no transpose symmetry
             #ifdef MAQUIS_OPENMP
-            // Intel Composer v15 patch 0 does not accept collapse(2) - FIXME! test v15 patch 5
-            //#pragma omp parallel for collapse(2) schedule (dynamic,1)
-            #pragma omp parallel for collapse(1) schedule (dynamic,1)
+            #pragma omp parallel for schedule (dynamic,1)
             #endif
-            for (pos_t p1 = 0; p1 < lattice.size(); ++p1)
-            for (pos_t p2 = 0; p2 < lattice.size(); ++p2)
+            for (std::size_t k = 0; k < schedule.size(); ++k)
             {
-                if(p2 > p1) continue;
+                std::size_t t = schedule.task(k);
+                if (schedule.finished(t)) continue;
+
+                pos_t p1 = tasks[t].first, p2 = tasks[t].second;
 
                 boost::shared_ptr<TagHandler<Matrix, SymmGroup> > tag_handler_local(new TagHandler<Matrix, SymmGroup>(*tag_handler));
 
+                // consecutive elements share the boundaries up to the first differing operator
+                std::vector<expval_cache<Matrix, SymmGroup> > expvals;
+                expvals.reserve(operator_terms.size());
+                for (std::size_t synop = 0; synop < operator_terms.size(); ++synop)
+                    expvals.emplace_back(bra_mps, ket_mps, false, cache_bytes / operator_terms.size());
+
+                std::vector<typename MPS<Matrix, SymmGroup>::scalar_type> dct;
+                std::vector<std::vector<pos_t> > num_labels;
+
                 for (pos_t p3 = std::min(p1, p2); p3 < lattice.size(); ++p3)
                 {
                     if(p1 == p2 && p1 == p3)
@@ -335,9 +531,6 @@ namespace measurements {
     
                         for (pos_t p5 = ((bra_neq_ket) ? 0 : std::min(p1, p2)); p5 < lattice.size(); ++p5)
                         { 
-                            std::vector<typename MPS<Matrix, SymmGroup>::scalar_type> dct;
-                            std::vector<std::vector<pos_t> > num_labels;
-    
                             for (pos_t p6 = std::min(p4, p5); p6 < lattice.size(); ++p6)
                             {
                                 // sixth index must be different if p4 == p5 
@@ -369,7 +562,7 @@ namespace measurements {
                                     measured = true;
     
                                     MPO<Matrix, SymmGroup> mpo = generate_mpo::sign_and_fill(term, identities, fillings, tag_handler_local, lattice);
-                                    value += operator_terms[synop].second * expval(bra_mps, ket_mps, mpo);
+                                    value += operator_terms[synop].second * expvals[synop](mpo);
     
                                 }
                                 if(measured)
@@ -378,24 +571,57 @@ namespace measurements {
                                      num_labels.push_back(positions);
                                 }
                             }
-    
-                            std::vector<std::string> lbt = label_strings(lattice,  num_labels);
-
-                            // save results and labels
-                            #ifdef MAQUIS_OPENMP
-                            #pragma omp critical
-                            #endif
-                            {
-                                this->vector_results.reserve(this->vector_results.size() + dct.size());
-                                std::copy(dct.rbegin(), dct.rend(), std::back_inserter(this->vector_results));
-
-                                this->labels.reserve(this->labels.size() + dct.size());
-                                std::copy(lbt.rbegin(), lbt.rend(), std::back_inserter(this->labels));
-                            }
                         }
                     }
                 }
+
+                schedule.store(t, dct, num_labels);
             }
+
+            collect(schedule);
+        }
+
+        void collect(measurements_details::rdm_scheduler<typename MPS<Matrix, SymmGroup>::scalar_type> & schedule)
+        {
+            std::vector<std::vector<pos_t> > num_labels;
+            schedule.collect(this->vector_results, num_labels);
+
+            std::vector<std::string> lbt = label_strings(lattice, num_labels);
+            this->labels.insert(this->labels.end(), lbt.begin(), lbt.end());
+        }
+
+        // elements x operator span of the 2-RDM task with p3 >= subref
+        double rdm2_cost(pos_t subref) const
+        {
+            double n = lattice.size() - subref;
+            return n * (n + 1) / 2 * n;
+        }
+
+        // elements x operator span of the 3-RDM task with p3 >= first and p4, p5 >= subref
+        double rdm3_cost(pos_t first, pos_t subref) const
+        {
+            double n = lattice.size() - subref;
+            return (lattice.size() - first) * n * n * n * n;
+        }
+
+        // with several MPI ranks each one keeps its own file
+        std::string partial_file() const
+        {
+            if (partial == "")
+                return partial;
+            std::string ret = partial + "." + this->name();
+            return (parallel::size() > 1) ? ret + ".rank" + parallel::rank_str() : ret;
+        }
+
+        // measurement name and fingerprints of the ket and, if given, the bra state
+        std::string partial_id(MPS<Matrix, SymmGroup> const & dummy_bra_mps, MPS<Matrix, SymmGroup> const & ket_mps) const
+        {
+            if (partial == "")
+                return std::string();
+            std::string ret = this->name() + " " + std::to_string(measurements_details::mps_fingerprint(ket_mps));
+            if (dummy_bra_mps.length() > 0)
+                ret += " " + std::to_string(measurements_details::mps_fingerprint(dummy_bra_mps));
+            return ret;
         }
 
     private:
@@ -406,6 +632,9 @@ namespace measurements {
         std::vector<scaled_bond_term> operator_terms;
 
         std::string bra_ckp;
+        std::string partial;
+        // boundaries each thread keeps to share between elements, see expval_cache
+        std::size_t cache_bytes;
     };
 
 
@@ -436,7 +665,9 @@ namespace measurements {
                        boost::shared_ptr<TagHandler<Matrix, SymmGroup> > tag_handler_,
                        typename TM::OperatorCollection const & op_collection_,
                        positions_type const& positions_ = positions_type(),
-                       std::string const& ckp_ = std::string(""))
+                       std::string const& ckp_ = std::string(""),
+                       std::string const& partial_ = std::string(""),
+                       double cache_mb = 256.)
         : base(name_)
         , lattice(lat)
         , tag_handler(tag_handler_)
@@ -445,6 +676,8 @@ namespace measurements {
         , identities(op_collection.ident.no_couple)
         , fillings(op_collection.fill.no_couple)
         , bra_ckp(ckp_)
+        , partial(partial_)
+        , cache_bytes(static_cast<std::size_t>(cache_mb * 1024 * 1024))
         {
             pos_t extent = lattice.size();
             if (positions_first.size() == 0)
@@ -497,6 +730,13 @@ namespace measurements {
             results = this->vector_results;
             num_labels = numeric_labels;
         }
+
+        // no copies of the result and label vectors
+        void extract(typename base::visitor_type const & f)
+        {
+            for (std::size_t i = 0; i < numeric_labels.size(); ++i)
+                f(numeric_labels[i], this->vector_results[i]);
+        }
         
         void measure_correlation(MPS<Matrix, SymmGroup> const & dummy_bra_mps,
                                  MPS<Matrix, SymmGroup> const & ket_mps)
@@ -506,10 +746,23 @@ namespace measurements {
             //MPS<Matrix, SymmGroup> const & bra_mps = (bra_neq_ket) ? dummy_bra_mps : ket_mps;
             MPS<Matrix, SymmGroup> bra_mps = (bra_neq_ket) ? dummy_bra_mps : ket_mps; // copy bra to avoid multithread issues
 
+            // one task per p1, cost ~ number of elements x operator span
+            std::vector<double> cost(positions_first.size());
+            for (std::size_t i = 0; i < positions_first.size(); ++i) {
+                double n = lattice.size() - ((bra_neq_ket) ? 0 : positions_first[i]);
+                cost[i] = n * n;
+            }
+
+            measurements_details::rdm_scheduler<typename MPS<Matrix, SymmGroup>::scalar_type>
+                schedule(cost, partial_file(), partial_id(dummy_bra_mps, ket_mps));
+
             #ifdef MAQUIS_OPENMP
             #pragma omp parallel for schedule(dynamic)
             #endif
-            for (std::size_t i = 0; i < positions_first.size(); ++i) {
+            for (std::size_t k = 0; k < schedule.size(); ++k) {
+                std::size_t i = schedule.task(k);
+                if (schedule.finished(i)) continue;
+
                 pos_t p1 = positions_first[i];
                 boost::shared_ptr<TagHandler<Matrix, SymmGroup> > tag_handler_local(new TagHandler<Matrix, SymmGroup>(*tag_handler));
 
@@ -550,24 +803,10 @@ namespace measurements {
                     num_labels.push_back(positions);
                 }
 
-                // the lattice knows the ordering and provides the correct orbital label for each position
-                std::vector<std::string> lbt = label_strings(num_labels);
-
-                // save results and labels
-                #ifdef MAQUIS_OPENMP
-                #pragma omp critical
-                #endif
-                {
-                    this->vector_results.reserve(this->vector_results.size() + dct.size());
-                    std::copy(dct.rbegin(), dct.rend(), std::back_inserter(this->vector_results));
-
-                    this->labels.reserve(this->labels.size() + dct.size());
-                    std::copy(lbt.rbegin(), lbt.rend(), std::back_inserter(this->labels));
-
-                    this->numeric_labels.reserve(this->numeric_labels.size() + dct.size());
-                    std::copy(num_labels.rbegin(), num_labels.rend(), std::back_inserter(numeric_labels));
-                }
+                schedule.store(i, dct, num_labels);
             }
+
+            collect(schedule);
         }
 
         void measure_2rdm(MPS<Matrix, SymmGroup> const & dummy_bra_mps,
@@ -577,14 +816,32 @@ namespace measurements {
             bool bra_neq_ket = (dummy_bra_mps.length() > 0);
             MPS<Matrix, SymmGroup> const & bra_mps = (bra_neq_ket) ? dummy_bra_mps : ket_mps;
 
+            // one task per (p1, p2), cost ~ number of elements x operator span
+            pos_t L = lattice.size();
+            std::vector<double> cost(L * L);
+            for (pos_t p1 = 0; p1 < L; ++p1)
+            for (pos_t p2 = 0; p2 < L; ++p2) {
+                double n = L - ((bra_neq_ket) ? 0 : std::min(p1, p2));
+                cost[p1 * L + p2] = n * (n + 1) / 2 * n;
+            }
+
+            measurements_details::rdm_scheduler<typename MPS<Matrix, SymmGroup>::scalar_type>
+                schedule(cost, partial_file(), partial_id(dummy_bra_mps, ket_mps));
+
             #ifdef MAQUIS_OPENMP
-            #pragma omp parallel for collapse(1) schedule(dynamic)
+            #pragma omp parallel for schedule(dynamic)
             #endif
-            for (pos_t p1 = 0; p1 < lattice.size(); ++p1)
-            for (pos_t p2 = 0; p2 < lattice.size(); ++p2)
+            for (std::size_t k = 0; k < schedule.size(); ++k)
             {
+                std::size_t t = schedule.task(k);
+                if (schedule.finished(t)) continue;
+
+                pos_t p1 = t / L, p2 = t % L;
                 boost::shared_ptr<TagHandler<Matrix, SymmGroup> > tag_handler_local(new TagHandler<Matrix, SymmGroup>(*tag_handler));
 
+                // consecutive elements share the boundaries up to the first differing MPO tensor
+                expval_cache<Matrix, SymmGroup> expvals(bra_mps, ket_mps, !bra_neq_ket, cache_bytes);
+
                 // Permutation symmetry for bra == ket: pqrs == rspq == qpsr == srqp
                 pos_t subref = std::min(p1, p2);
 
@@ -613,7 +870,7 @@ namespace measurements {
                                                                               op_collection.ident_full.no_couple,
                                                                               op_collection.fill.no_couple, tag_handler_local, terms);
                         MPO<Matrix, SymmGroup> mpo = mpo_m.create_mpo();
-                        typename MPS<Matrix, SymmGroup>::scalar_type value = expval(bra_mps, ket_mps, mpo, !bra_neq_ket);
+                        typename MPS<Matrix, SymmGroup>::scalar_type value = expvals(mpo);
 
                         dct.push_back(value);
                         // reorder positions p -> order[p]
@@ -624,23 +881,41 @@ namespace measurements {
                     }
                 }
 
-                std::vector<std::string> lbt = label_strings(num_labels);
+                schedule.store(t, dct, num_labels);
+            }
 
-                // save results and labels
-                #ifdef MAQUIS_OPENMP
-                #pragma omp critical
-                #endif
-                {
-                    this->vector_results.reserve(this->vector_results.size() + dct.size());
-                    std::copy(dct.rbegin(), dct.rend(), std::back_inserter(this->vector_results));
+            collect(schedule);
+        }
 
-                    this->labels.reserve(this->labels.size() + dct.size());
-                    std::copy(lbt.rbegin(), lbt.rend(), std::back_inserter(this->labels));
+        // the lattice knows the ordering and provides the correct orbital label for each position
+        void collect(measurements_details::rdm_scheduler<typename MPS<Matrix, SymmGroup>::scalar_type> & schedule)
+        {
+            std::size_t offset = numeric_labels.size();
+            schedule.collect(this->vector_results, numeric_labels);
 
-                    this->numeric_labels.reserve(this->numeric_labels.size() + dct.size());
-                    std::copy(num_labels.rbegin(), num_labels.rend(), std::back_inserter(numeric_labels));
-                }
-            }
+            std::vector<std::vector<pos_t> > num_labels(numeric_labels.begin() + offset, numeric_labels.end());
+            std::vector<std::string> lbt = label_strings(num_labels);
+            this->labels.insert(this->labels.end(), lbt.begin(), lbt.end());
+        }
+
+        // with several MPI ranks each one keeps its own file
+        std::string partial_file() const
+        {
+            if (partial == "")
+                return partial;
+            std::string ret = partial + "." + this->name();
+            return (parallel::size() > 1) ? ret + ".rank" + parallel::rank_str() : ret;
+        }
+
+        // measurement name and fingerprints of the ket and, if given, the bra state
+        std::string partial_id(MPS<Matrix, SymmGroup> const & dummy_bra_mps, MPS<Matrix, SymmGroup> const & ket_mps) const
+        {
+            if (partial == "")
+                return std::string();
+            std::string ret = this->name() + " " + std::to_string(measurements_details::mps_fingerprint(ket_mps));
+            if (dummy_bra_mps.length() > 0)
+                ret += " " + std::to_string(measurements_details::mps_fingerprint(dummy_bra_mps));
+            return ret;
         }
 
     private:
@@ -653,6 +928,9 @@ namespace measurements {
         tag_vec identities, fillings;
 
         std::string bra_ckp;
+        std::string partial;
+        // boundaries each thread keeps to share between elements, see expval_cache
+        std::size_t cache_bytes;
 
         std::vector<std::vector<pos_t> > numeric_labels;
     };
@@ -30,11 +30,14 @@
 
 #include <iostream>
 #include <set>
+#include <algorithm>
 #include <boost/archive/binary_oarchive.hpp>
 
 #include "dmrg/sim/matrix_types.h"
 #include "utils/function_objects.h"
 #include "dmrg/utils/aligned_allocator.hpp"
+#include "dmrg/utils/numa.h"
+#include "dmrg/utils/memory_tracking.h"
 #include "dmrg/utils/storage.h"
 #include "dmrg/mp_tensors/mpotensor_detail.h"
 
@@ -243,7 +246,8 @@ public:
     typedef typename Matrix::value_type value_type;
     typedef std::pair<typename SymmGroup::charge, std::size_t> access_type;
 
-    typedef std::vector<value_type, maquis::aligned_allocator<value_type, ALIGNMENT>> idata_t;
+    typedef std::vector<value_type, memtrack::allocator<value_type, memtrack::boundaries,
+                                    maquis::first_touch_allocator<value_type, ALIGNMENT>>> idata_t;
     typedef std::vector<idata_t> data_t;
     //typedef std::vector<value_type, maquis::aligned_allocator<value_type, ALIGNMENT>> data_t;
 
@@ -278,8 +282,14 @@ public:
 
         allocate_all();
 
-        for (unsigned ci = 0; ci < index_.n_cohorts(); ++ci)
-            std::fill((*this)[ci], (*this)[ci] + index_.cohort_size(ci), value_type(1.));
+        // identity blocks, an end index of dimension > 1 is traced over
+        for (unsigned ci = 0; ci < index_.n_cohorts(); ++ci) {
+            std::fill((*this)[ci], (*this)[ci] + index_.cohort_size(ci), value_type(0.));
+            std::size_t ls = index_.left_size(ci), n = std::min(ls, index_.right_size(ci));
+            for (std::size_t b = 0; b < ad; ++b)
+                for (std::size_t k = 0; k < n; ++k)
+                    (*this)[ci][index_.offset(ci, b) + k + k*ls] = value_type(1.);
+        }
     }
 
     Boundary(BoundaryIndex<value_type, SymmGroup> const & idx) : index_(idx)
@@ -329,10 +339,15 @@ public:
         //    seek += index_.cohort_size_a(ci);
         //}
 
-        for (unsigned ci = 0; ci < index_.n_cohorts(); ++ci) {
-            data()[ci].resize(index_.cohort_size(ci));
+        // zeroed by the threads selected with numa_placement, so the pages are spread over their nodes
+        std::vector<std::size_t> sizes(index_.n_cohorts());
+        for (unsigned ci = 0; ci < index_.n_cohorts(); ++ci)
+            sizes[ci] = index_.cohort_size(ci);
+
+        numa::allocate_cohorts(data(), sizes);
+
+        for (unsigned ci = 0; ci < index_.n_cohorts(); ++ci)
             data_view[ci] = data()[ci].data();
-        }
     }
 
     void deallocate()
@@ -355,8 +370,7 @@ public:
         for (size_t ci = 0; ci < index_.n_cohorts(); ++ci)
             for (size_t b = 0; b < index_.aux_dim(); ++b)
                 if (index_.has_block(ci, b))
-                    ret[b] += std::accumulate((*this)[ci] + index_.offset(ci, b),
-                                              (*this)[ci] + index_.offset(ci, b) + index_.block_size(ci), scalar_type(0));
+                    ret[b] += block_trace(ci, b);
 
         return ret;
     }
@@ -367,7 +381,8 @@ public:
 
         scalar_type ret(0);
         for (size_t ci = 0; ci < index_.n_cohorts(); ++ci)
-            ret += std::accumulate((*this)[ci], (*this)[ci] + index_.block_size(ci) * index_.n_blocks(ci), scalar_type(0));
+            if (index_.has_block(ci, 0))
+                ret += block_trace(ci, 0);
 
         return ret;
     }
@@ -394,6 +409,18 @@ public:
 
 private:
 
+    // diagonal sum of block b of cohort ci, the full contraction once the end index is reached
+    scalar_type block_trace(size_t ci, size_t b) const
+    {
+        size_t ls = index_.left_size(ci), n = std::min(ls, index_.right_size(ci));
+        value_type const * block = (*this)[ci] + index_.offset(ci, b);
+
+        scalar_type ret(0);
+        for (size_t k = 0; k < n; ++k)
+            ret += block[k + k*ls];
+        return ret;
+    }
+
     data_t const& data() const { return data_; }
     data_t      & data()       { return data_; }
     //std::vector<value_type*> const& data() const { return data_view; }
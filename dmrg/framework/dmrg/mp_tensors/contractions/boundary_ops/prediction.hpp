@@ -70,6 +70,91 @@ namespace contraction {
                 return dm;
             }
 
+            // zero matrix with the blocks of psi psi^+ (left) or psi^+ psi (right), the target of alpha_dm_direct
+            template<class OtherMatrix, class Matrix, class SymmGroup>
+            static block_matrix<OtherMatrix, SymmGroup>
+            zero_dm(block_matrix<Matrix, SymmGroup> const & psi, bool left)
+            {
+                block_matrix<OtherMatrix, SymmGroup> dm;
+                for (std::size_t k = 0; k < psi.n_blocks(); ++k)
+                {
+                    typename SymmGroup::charge c = left ? psi.basis().left_charge(k) : psi.basis().right_charge(k);
+                    std::size_t n = left ? num_rows(psi[k]) : num_cols(psi[k]);
+                    if (!dm.has_block(c, c))
+                        dm.insert_block(OtherMatrix(n, n), c, c);
+                }
+                return dm;
+            }
+
+            // (1 - U U^+) dm (1 - U U^+)
+            template<class Matrix, class SymmGroup>
+            static block_matrix<Matrix, SymmGroup>
+            project_out(block_matrix<Matrix, SymmGroup> dm,
+                        block_matrix<Matrix, SymmGroup> const & U)
+            {
+                block_matrix<Matrix, SymmGroup> tmp, proj;
+                gemm(transpose(conjugate(U)), dm, tmp);
+                gemm(U, tmp, proj);
+                dm -= proj;
+
+                gemm(dm, U, tmp);
+                gemm(tmp, transpose(conjugate(U)), proj);
+                dm -= proj;
+                return dm;
+            }
+
+            // at most Mexp leading eigenvectors of dm, eigenvalues below floor are numerical noise
+            template<class Matrix, class SymmGroup>
+            static block_matrix<Matrix, SymmGroup>
+            leading_states(block_matrix<Matrix, SymmGroup> const & dm,
+                           double cutoff, std::size_t Mexp, double floor)
+            {
+                block_matrix<Matrix, SymmGroup> V;
+                block_matrix<typename alps::numeric::associated_real_diagonal_matrix<Matrix>::type, SymmGroup> D;
+                if (Mexp == 0 || dm.n_blocks() == 0)
+                    return V;
+
+                heev_truncate(dm, V, D, cutoff, Mexp, false);
+
+                for (int k = D.n_blocks() - 1; k >= 0; --k)
+                {
+                    std::size_t keep = 0;
+                    while (keep < num_rows(D[k]) && maquis::real(D[k](keep, keep)) > floor)
+                        ++keep;
+
+                    if (keep == 0)
+                        V.remove_block(V.basis().left_charge(k), V.basis().right_charge(k));
+                    else if (keep < num_cols(V[k]))
+                        V.resize_block(V.basis().left_charge(k), V.basis().right_charge(k),
+                                       V.basis().left_size(k), keep);
+                }
+                return V;
+            }
+
+            // the columns of B appended to those of A, block by block
+            template<class Matrix, class SymmGroup>
+            static block_matrix<Matrix, SymmGroup>
+            join_columns(block_matrix<Matrix, SymmGroup> A,
+                         block_matrix<Matrix, SymmGroup> const & B)
+            {
+                for (std::size_t b = 0; b < B.n_blocks(); ++b)
+                {
+                    typename SymmGroup::charge lc = B.basis().left_charge(b), rc = B.basis().right_charge(b);
+                    if (!A.has_block(lc, rc)) {
+                        A.insert_block(B[b], lc, rc);
+                        continue;
+                    }
+
+                    std::size_t k = A.find_block(lc, rc);
+                    std::size_t offset = num_cols(A[k]);
+                    A.resize_block(k, num_rows(A[k]), offset + num_cols(B[b]));
+                    for (std::size_t j = 0; j < num_cols(B[b]); ++j)
+                        for (std::size_t i = 0; i < num_rows(B[b]); ++i)
+                            A[k](i, offset + j) = B[b](i, j);
+                }
+                return A;
+            }
+
         } // namespace detail
 
         template<class Matrix, class OtherMatrix, class SymmGroup>
@@ -149,6 +234,76 @@ namespace contraction {
             return B;
         }
 
+        /// Controlled bond expansion: the truncated basis of the optimized tensor, enlarged by at most
+        /// Mexp states of the projected residual (1 - A A^+) L W psi taken from the density matrix of
+        /// the enlarged left environment. The new states carry no weight in psi, the next site
+        /// optimization decides about them. The optimized tensor keeps at most Mmax - Mexp states
+        /// (at least Mmax / 2), so a saturated bond still has room for the expansion.
+        template<class Matrix, class OtherMatrix, class SymmGroup>
+        static std::pair<MPSTensor<Matrix, SymmGroup>, truncation_results>
+        expand_new_state_l2r_sweep(MPSTensor<Matrix, SymmGroup> const & mps,
+                                   MPOTensor<Matrix, SymmGroup> const & mpo,
+                                   Boundary<OtherMatrix, SymmGroup> const & left,
+                                   double cutoff, std::size_t Mmax, std::size_t Mexp)
+        {
+            mps.make_left_paired();
+            block_matrix<OtherMatrix, SymmGroup> dm;
+            gemm(mps.data(), transpose(conjugate(mps.data())), dm);
+
+            block_matrix<OtherMatrix, SymmGroup> U;
+            block_matrix<typename alps::numeric::associated_real_diagonal_matrix<OtherMatrix>::type, SymmGroup> S;
+            truncation_results trunc = heev_truncate(dm, U, S, cutoff, Mmax - std::min(Mexp, Mmax / 2));
+
+            if (trunc.bond_dimension < Mmax) {
+                // only the perturbation term, the psi psi^+ part is projected out anyway
+                block_matrix<OtherMatrix, SymmGroup> residual = detail::zero_dm<OtherMatrix>(mps.data(), true);
+                alpha_dm_direct(mps, left, mpo, residual, 1.);
+                double floor = 1e-12 * maquis::real(residual.trace());
+                residual = detail::project_out(residual, U);
+                U = detail::join_columns(U, detail::leading_states(residual, cutoff, std::min(Mexp, Mmax - trunc.bond_dimension), floor));
+
+                std::size_t expanded = U.right_basis().sum_of_sizes();
+                maquis::cout << "Bond expansion: " << trunc.bond_dimension << " -> " << expanded << std::endl;
+                trunc.bond_dimension = expanded;
+            }
+
+            MPSTensor<Matrix, SymmGroup> ret = mps;
+            ret.replace_left_paired(U);
+            return std::make_pair(ret, trunc);
+        }
+
+        template<class Matrix, class OtherMatrix, class SymmGroup>
+        static std::pair<MPSTensor<Matrix, SymmGroup>, truncation_results>
+        expand_new_state_r2l_sweep(MPSTensor<Matrix, SymmGroup> const & mps,
+                                   MPOTensor<Matrix, SymmGroup> const & mpo,
+                                   Boundary<OtherMatrix, SymmGroup> const & right,
+                                   double cutoff, std::size_t Mmax, std::size_t Mexp)
+        {
+            mps.make_right_paired();
+            block_matrix<OtherMatrix, SymmGroup> dm;
+            gemm(transpose(conjugate(mps.data())), mps.data(), dm);
+
+            block_matrix<OtherMatrix, SymmGroup> U;
+            block_matrix<typename alps::numeric::associated_real_diagonal_matrix<OtherMatrix>::type, SymmGroup> S;
+            truncation_results trunc = heev_truncate(dm, U, S, cutoff, Mmax - std::min(Mexp, Mmax / 2));
+
+            if (trunc.bond_dimension < Mmax) {
+                block_matrix<OtherMatrix, SymmGroup> residual = detail::zero_dm<OtherMatrix>(mps.data(), false);
+                alpha_dm_direct_right(mps, right, mpo, residual, 1.);
+                double floor = 1e-12 * maquis::real(residual.trace());
+                residual = detail::project_out(residual, U);
+                U = detail::join_columns(U, detail::leading_states(residual, cutoff, std::min(Mexp, Mmax - trunc.bond_dimension), floor));
+
+                std::size_t expanded = U.right_basis().sum_of_sizes();
+                maquis::cout << "Bond expansion: " << trunc.bond_dimension << " -> " << expanded << std::endl;
+                trunc.bond_dimension = expanded;
+            }
+
+            MPSTensor<Matrix, SymmGroup> ret = mps;
+            ret.replace_right_paired(adjoint(U));
+            return std::make_pair(ret, trunc);
+        }
+
         template<class Matrix, class OtherMatrix, class SymmGroup>
         boost::tuple<MPSTensor<Matrix, SymmGroup>, MPSTensor<Matrix, SymmGroup>, truncation_results>
         predict_split_l2r(TwoSiteTensor<Matrix, SymmGroup> & tst,
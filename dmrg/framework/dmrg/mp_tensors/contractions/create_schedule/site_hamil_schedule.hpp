@@ -32,6 +32,7 @@
 #include <boost/lambda/construct.hpp>
 
 #include "dmrg/solver/accelerator.h"
+#include "dmrg/utils/tracing.h"
 
 
 namespace contraction {
@@ -50,6 +51,7 @@ create_contraction_schedule(MPSTensor<Matrix, SymmGroup> & initial,
     typedef MPOTensor_detail::index_type index_type;
 
     std::chrono::high_resolution_clock::time_point now = std::chrono::high_resolution_clock::now();
+    tracing::span trace("create_contraction_schedule", "schedule");
 
     accelerator::gpu::reset_buffers();
 
@@ -69,13 +71,38 @@ create_contraction_schedule(MPSTensor<Matrix, SymmGroup> & initial,
 
     omp_for(index_type mb, parallel::range<index_type>(0,loop_max), {
                 rshtm_t_tasks(right.index(), left_i, right_i, physical_i, out_right_pb, mb, tasks[mb]);
-                shtm_tasks(mpo, left, right, left_i, right_i, physical_i, out_right_pb, mb, tasks[mb]);
     });
 
+    // one work item per coupled (lb_in, lb_out) pair, so that a few dominant input blocks
+    // are still spread over all threads; cohorts are appended in lb_out order
+    std::vector<std::pair<unsigned, unsigned> > pairs;
+    for (unsigned lb_in = 0; lb_in < loop_max; ++lb_in)
+        for (unsigned lb_out = 0; lb_out < loop_max; ++lb_out)
+            if (left.index().cohort_index(left_i[lb_out].first, left_i[lb_in].first) != left.index().n_cohorts())
+                pairs.push_back(std::make_pair(lb_in, lb_out));
+
+    std::vector<typename ScheduleNew<value_type>::block_type::cohort_type> cohorts(pairs.size());
+    omp_for(std::size_t item, parallel::range<std::size_t>(0, pairs.size()), {
+                cohorts[item] = shtm_cohort(mpo, left, right, left_i, right_i, physical_i, out_right_pb,
+                                            pairs[item].first, pairs[item].second, tasks[pairs[item].first]);
+    });
+    for (std::size_t item = 0; item < cohorts.size(); ++item)
+        if (cohorts[item].n_tasks()) tasks[pairs[item].first].push_back(std::move(cohorts[item]));
+    std::vector<typename ScheduleNew<value_type>::block_type::cohort_type>().swap(cohorts);
+
     tasks.compute_workload(right.index().rt(), cpu_gpu_ratio);
     tasks.stage_gpu();
     tasks.mps_stage.allocate(initial.data().basis().sizes());
 
+    if (tracing::enabled()) {
+        std::size_t ncohorts = 0;
+        for (index_type mb = 0; mb < loop_max; ++mb)
+            ncohorts += std::distance(tasks[mb].begin(), tasks[mb].end());
+        trace.counter("flops", tasks.total_flops);
+        trace.counter("cohorts", ncohorts);
+        trace.counter("bytes", size_of(left) + size_of(right));
+    }
+
     if (std::max(mpo.row_dim(), mpo.col_dim()) > 10)
     {
         maquis::cout << "Schedule size: " << tasks.size() << " blocks, " //<< tasks.enumeration_gpu.size()
@@ -38,16 +38,19 @@
 namespace contraction {
 namespace common {
 
+    // the cohort of output block lb_out for input block lb_in, without tasks if the blocks do not couple
     template<class Matrix, class OtherMatrix, class SymmGroup>
-    void shtm_tasks(MPOTensor<Matrix, SymmGroup> const & mpo,
-                    Boundary<OtherMatrix, SymmGroup> const & left_boundary,
-                    Boundary<OtherMatrix, SymmGroup> const & right_boundary,
-                    Index<SymmGroup> const & left_i,
-                    Index<SymmGroup> const & right_i,
-                    Index<SymmGroup> const & phys_i,
-                    ProductBasis<SymmGroup> const & right_pb,
-                    unsigned lb_in,
-                    typename common::ScheduleNew<typename Matrix::value_type>::block_type & mpsb)
+    typename common::ScheduleNew<typename Matrix::value_type>::block_type::cohort_type
+    shtm_cohort(MPOTensor<Matrix, SymmGroup> const & mpo,
+                Boundary<OtherMatrix, SymmGroup> const & left_boundary,
+                Boundary<OtherMatrix, SymmGroup> const & right_boundary,
+                Index<SymmGroup> const & left_i,
+                Index<SymmGroup> const & right_i,
+                Index<SymmGroup> const & phys_i,
+                ProductBasis<SymmGroup> const & right_pb,
+                unsigned lb_in,
+                unsigned lb_out,
+                typename common::ScheduleNew<typename Matrix::value_type>::block_type const & mpsb)
     {
         typedef MPOTensor_detail::index_type index_type;
         typedef typename SymmGroup::charge charge;
@@ -64,76 +67,86 @@ namespace common {
         // output physical index, output offset range = out_right offset + ss2*rs_out
         //                                              for ss2 in {0, 1, .., phys_i[s].second}
 
-        //for (auto lbci : boost::adaptors::reverse(left(lc_out)))
-        for (unsigned lb_out = 0; lb_out < left_i.size(); ++lb_out)
+        charge lc_out = left_i[lb_out].first;
+        unsigned ls_out = left_i[lb_out].second;
+        unsigned ci = left.cohort_index(lc_out, lc_in); if (ci == left.n_cohorts()) return typename block_type::cohort_type();
+        unsigned ci_eff = left.tr(ci) ? left.cohort_index(lc_in, lc_out) : ci;
+
+        typename block_type::cohort_type cohort(phys_s, lb_in, lb_out, ls_in, ls_out, ci, ci_eff, left.n_blocks(ci_eff));
+
+        for (unsigned s = 0; s < phys_i.size(); ++s)
         {
-            //charge lc_out = lbci.first;
-            //unsigned lb_out = left_i.position(lbci.first); if (lb_in == left_i.size()) continue;
-            //unsigned ci = lbci.second, ci_conj = left.cohort_index(lc_in, lc_out);
-            charge lc_out = left_i[lb_out].first;
-            unsigned ls_out = left_i[lb_out].second;
-            unsigned ci = left.cohort_index(lc_out, lc_in); if (ci == left.n_cohorts()) continue;
-            unsigned ci_eff = left.tr(ci) ? left.cohort_index(lc_in, lc_out) : ci;
+            charge phys_out = phys_i[s].first;
+            charge rc_out = SymmGroup::fuse(lc_out, phys_out);
+            unsigned rb_out = right_i.position(rc_out); if (rb_out == right_i.size()) continue;
+            unsigned rs_out = right_i[rb_out].second;
+            unsigned out_offset = right_pb(phys_out, rc_out);
 
-            typename block_type::cohort_type cohort(phys_s, lb_in, lb_out, ls_in, ls_out, ci, ci_eff, left.n_blocks(ci_eff));
+            cohort.add_unit(s, phys_i[s].second, rs_out, out_offset);
+            ::SU2::Wigner9jCache<value_type, SymmGroup> w9j(lc_out, lc_in, rc_out);
 
-            for (unsigned s = 0; s < phys_i.size(); ++s)
+            for (index_type b1 = 0; b1 < mpo.row_dim(); ++b1)
             {
-                charge phys_out = phys_i[s].first;
-                charge rc_out = SymmGroup::fuse(lc_out, phys_out);
-                unsigned rb_out = right_i.position(rc_out); if (rb_out == right_i.size()) continue;
-                unsigned rs_out = right_i[rb_out].second;
-                unsigned out_offset = right_pb(phys_out, rc_out);
-
-                cohort.add_unit(s, phys_i[s].second, rs_out, out_offset);
-                ::SU2::Wigner9jCache<value_type, SymmGroup> w9j(lc_out, lc_in, rc_out);
+                if (!left.has_block(ci, b1)) continue;
+                unsigned left_idx = left.offset(ci, b1) / (ls_in * ls_out);
 
-                for (index_type b1 = 0; b1 < mpo.row_dim(); ++b1)
-                {
-                    if (!left.has_block(ci, b1)) continue;
-                    unsigned left_idx = left.offset(ci, b1) / (ls_in * ls_out);
+                int A = mpo.leftBond().spin(b1).get(); if (!::SU2::triangle<SymmGroup>(lc_in, A, lc_out)) continue;
 
-                    int A = mpo.leftBond().spin(b1).get(); if (!::SU2::triangle<SymmGroup>(lc_in, A, lc_out)) continue;
+                for (auto row_it = mpo.row(b1).begin(); row_it != mpo.row(b1).end(); ++row_it) {
+                    index_type b2 = row_it.index();
 
-                    for (auto row_it = mpo.row(b1).begin(); row_it != mpo.row(b1).end(); ++row_it) {
-                        index_type b2 = row_it.index();
+                    MPOTensor_detail::term_descriptor<Matrix, SymmGroup, true> access = mpo.at(b1,b2);
+                    for (unsigned op_index = 0; op_index < access.size(); ++op_index)
+                    {
+                        typename operator_selector<Matrix, SymmGroup>::type const & W = access.op(op_index);
+                        int K = W.spin().get(), Ap = mpo.rightBond().spin(b2).get();
 
-                        MPOTensor_detail::term_descriptor<Matrix, SymmGroup, true> access = mpo.at(b1,b2);
-                        for (unsigned op_index = 0; op_index < access.size(); ++op_index)
+                        for (size_t w_block = 0; w_block < W.basis().size(); ++w_block)
                         {
-                            typename operator_selector<Matrix, SymmGroup>::type const & W = access.op(op_index);
-                            int K = W.spin().get(), Ap = mpo.rightBond().spin(b2).get();
-
-                            for (size_t w_block = 0; w_block < W.basis().size(); ++w_block)
-                            {
-                                if (phys_out != W.basis().right_charge(w_block)) continue;
-                                charge phys_in = W.basis().left_charge(w_block);
-
-                                charge rc_in = SymmGroup::fuse(lc_in, phys_in);
-                                unsigned ci_right = right.cohort_index(rc_in, rc_out); if (!right.has_block(ci_right, b2)) continue;
-                                unsigned rb_in = right_i.position(rc_in);
-                                if (rb_in == right_i.size()) continue;
-                                unsigned rs_in = right_i[rb_in].second;
-                                unsigned in_offset = right_pb(phys_in, rc_in);
-                                size_t right_offset = right.offset(ci_right, b2);
-
-                                value_type couplings[4];
-                                value_type scale = right.conjugate_scale(ci_right, b2) * access.scale(op_index)
-                                                 *  left.conjugate_scale(ci, b1);
-
-                                w9j.set_scale(A, K, Ap, rc_in, scale, couplings);
-                                detail::op_iterate<Matrix, SymmGroup>(W, w_block, couplings, cohort, s, rs_in, mpsb, in_offset, ci_right, right_offset/rs_in);
-                            } // w_block
-                        } //op_index
-                    } // b2
-
-                    cohort.add_line(left_idx);
-                } // b1
-            } // phys_out
+                            if (phys_out != W.basis().right_charge(w_block)) continue;
+                            charge phys_in = W.basis().left_charge(w_block);
+
+                            charge rc_in = SymmGroup::fuse(lc_in, phys_in);
+                            unsigned ci_right = right.cohort_index(rc_in, rc_out); if (!right.has_block(ci_right, b2)) continue;
+                            unsigned rb_in = right_i.position(rc_in);
+                            if (rb_in == right_i.size()) continue;
+                            unsigned rs_in = right_i[rb_in].second;
+                            unsigned in_offset = right_pb(phys_in, rc_in);
+                            size_t right_offset = right.offset(ci_right, b2);
+
+                            value_type couplings[4];
+                            value_type scale = right.conjugate_scale(ci_right, b2) * access.scale(op_index)
+                                             *  left.conjugate_scale(ci, b1);
+
+                            w9j.set_scale(A, K, Ap, rc_in, scale, couplings);
+                            detail::op_iterate<Matrix, SymmGroup>(W, w_block, couplings, cohort, s, rs_in, mpsb, in_offset, ci_right, right_offset/rs_in);
+                        } // w_block
+                    } //op_index
+                } // b2
+
+                cohort.add_line(left_idx);
+            } // b1
+        } // phys_out
+
+        return cohort;
+    }
 
+    template<class Matrix, class OtherMatrix, class SymmGroup>
+    void shtm_tasks(MPOTensor<Matrix, SymmGroup> const & mpo,
+                    Boundary<OtherMatrix, SymmGroup> const & left_boundary,
+                    Boundary<OtherMatrix, SymmGroup> const & right_boundary,
+                    Index<SymmGroup> const & left_i,
+                    Index<SymmGroup> const & right_i,
+                    Index<SymmGroup> const & phys_i,
+                    ProductBasis<SymmGroup> const & right_pb,
+                    unsigned lb_in,
+                    typename common::ScheduleNew<typename Matrix::value_type>::block_type & mpsb)
+    {
+        for (unsigned lb_out = 0; lb_out < left_i.size(); ++lb_out)
+        {
+            auto cohort = shtm_cohort(mpo, left_boundary, right_boundary, left_i, right_i, phys_i, right_pb, lb_in, lb_out, mpsb);
             if (cohort.n_tasks()) mpsb.push_back(std::move(cohort));
-
-        } // lb_out
+        }
     }
 
 } // namespace common
@@ -119,6 +119,44 @@ namespace contraction {
             return trunc;
         }
 
+        static truncation_results
+        expand_l2r_sweep(MPS<Matrix, SymmGroup> & mps,
+                         MPOTensor<Matrix, SymmGroup> const & mpo,
+                         Boundary<OtherMatrix, SymmGroup> const & left,
+                         std::size_t l, double cutoff,
+                         std::size_t Mmax, std::size_t Mexp)
+        {
+            MPSTensor<Matrix, SymmGroup> new_mps;
+            truncation_results trunc;
+
+            boost::tie(new_mps, trunc) =
+            common::expand_new_state_l2r_sweep<Matrix, OtherMatrix, SymmGroup>
+                   (mps[l], mpo, left, cutoff, Mmax, Mexp);
+
+            mps[l+1] = common::predict_lanczos_l2r_sweep<Matrix, OtherMatrix, SymmGroup>(mps[l+1], mps[l], new_mps);
+            mps[l] = new_mps;
+            return trunc;
+        }
+
+        static truncation_results
+        expand_r2l_sweep(MPS<Matrix, SymmGroup> & mps,
+                         MPOTensor<Matrix, SymmGroup> const & mpo,
+                         Boundary<OtherMatrix, SymmGroup> const & right,
+                         std::size_t l, double cutoff,
+                         std::size_t Mmax, std::size_t Mexp)
+        {
+            MPSTensor<Matrix, SymmGroup> new_mps;
+            truncation_results trunc;
+
+            boost::tie(new_mps, trunc) =
+            common::expand_new_state_r2l_sweep<Matrix, OtherMatrix, SymmGroup>
+                   (mps[l], mpo, right, cutoff, Mmax, Mexp);
+
+            mps[l-1] = common::predict_lanczos_r2l_sweep<Matrix, OtherMatrix, SymmGroup>(mps[l-1], mps[l], new_mps);
+            mps[l] = new_mps;
+            return trunc;
+        }
+
         static boost::tuple<MPSTensor<Matrix, SymmGroup>, MPSTensor<Matrix, SymmGroup>, truncation_results>
         predict_split_l2r(TwoSiteTensor<Matrix, SymmGroup> & tst,
                           std::size_t Mmax, double cutoff, double alpha,
@@ -0,0 +1,189 @@
+/*****************************************************************************
+ *
+ * ALPS MPS DMRG Project
+ *
+ * Copyright (C) 2014 Institute for Theoretical Physics, ETH Zurich
+ *               2011-2011 by Bela Bauer <bauerb@phys.ethz.ch>
+ *               2011-2013    Michele Dolfi <dolfim@phys.ethz.ch>
+ *
+ * This software is part of the ALPS Applications, published under the ALPS
+ * Application License; you can use, redistribute it and/or modify it under
+ * the terms of the license, either version 1 or (at your option) any later
+ * version.
+ *
+ * You should have received a copy of the ALPS Application License along with
+ * the ALPS Applications; see the file LICENSE.txt. If not, the license is also
+ * available from http://alps.comp-phys.org/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef EXPVAL_CACHE_H
+#define EXPVAL_CACHE_H
+
+#include <vector>
+#include <map>
+#include <limits>
+
+#include "dmrg/mp_tensors/mps.h"
+#include "dmrg/mp_tensors/mpo.h"
+#include "dmrg/mp_tensors/mps_mpo_ops.h"
+
+/// <bra|mpo|ket> for a sequence of MPOs which share leading site tensors, e.g. the
+/// operator strings of RDM elements. The left boundaries of the previous MPOs are kept and
+/// only the sites after the longest shared prefix are contracted again. At most max_bytes of
+/// boundaries are kept, the least recently used ones are dropped first.
+template <class Matrix, class SymmGroup>
+class expval_cache
+{
+    typedef typename Matrix::value_type value_type;
+    typedef typename MPOTensor<Matrix, SymmGroup>::index_type index_type;
+    typedef typename MPOTensor<Matrix, SymmGroup>::row_proxy row_proxy;
+
+    struct entry
+    {
+        entry() : bytes(0), used(0) {}
+        Boundary<Matrix, SymmGroup> data;
+        std::size_t bytes, used;
+    };
+
+public:
+    expval_cache(MPS<Matrix, SymmGroup> const & bra_, MPS<Matrix, SymmGroup> const & ket_, bool symmetric_ = false,
+                 std::size_t max_bytes_ = std::numeric_limits<std::size_t>::max())
+    : bra(bra_)
+    , ket(ket_)
+    , symmetric(symmetric_)
+    , max_bytes(max_bytes_)
+    , bytes(0)
+    , clock(0)
+    , initial(mps_mpo_detail::mixed_left_boundary(bra_, ket_))
+    { }
+
+    value_type operator()(MPO<Matrix, SymmGroup> const & mpo)
+    {
+        assert(mpo.length() == bra.length() && bra.length() == ket.length());
+        std::size_t L = bra.length();
+
+        std::size_t common = 0;
+        while (common < last.size() && same_tensor(last[common], mpo[common]))
+            ++common;
+        last.assign(mpo.begin(), mpo.end());
+
+        // boundaries past the shared prefix belong to a different operator string
+        while (!stored.empty() && stored.rbegin()->first >= common)
+            erase(stored.rbegin()->first);
+
+        Boundary<Matrix, SymmGroup> const * prev = &initial;
+        std::size_t start = 0;
+        if (!stored.empty()) {
+            stored.rbegin()->second.used = ++clock;
+            prev = &stored.rbegin()->second.data;
+            start = stored.rbegin()->first + 1;
+        }
+
+        for (std::size_t i = start; i < L; ++i) {
+            entry & e = stored[i];
+            e.data = contraction::Engine<Matrix, Matrix, SymmGroup>::overlap_mpo_left_step(bra[i], ket[i], *prev, mpo[i], symmetric);
+            e.bytes = size_of(e.data);
+            e.used = ++clock;
+            bytes += e.bytes;
+            prev = &e.data;
+            evict(i);
+        }
+
+        return prev->trace();
+    }
+
+    std::size_t size_in_bytes() const { return bytes; }
+
+private:
+    void erase(std::size_t i)
+    {
+        bytes -= stored[i].bytes;
+        stored.erase(i);
+    }
+
+    // the boundary at site keep is the one the next step continues from
+    void evict(std::size_t keep)
+    {
+        while (bytes > max_bytes) {
+            typename std::map<std::size_t, entry>::iterator victim = stored.end();
+            for (typename std::map<std::size_t, entry>::iterator it = stored.begin(); it != stored.end(); ++it)
+                if (it->first != keep && (victim == stored.end() || it->second.used < victim->second.used))
+                    victim = it;
+            if (victim == stored.end())
+                break;
+            erase(victim->first);
+        }
+    }
+
+    // tags are only compared within the same operator table, otherwise the tensors are treated as different
+    static bool same_tensor(MPOTensor<Matrix, SymmGroup> const & a, MPOTensor<Matrix, SymmGroup> const & b)
+    {
+        if (a.row_dim() != b.row_dim() || a.col_dim() != b.col_dim()
+            || a.get_operator_table() != b.get_operator_table())
+            return false;
+
+        if (!same_bond(a.leftBond(), b.leftBond()) || !same_bond(a.rightBond(), b.rightBond()))
+            return false;
+
+        for (index_type r = 0; r < a.row_dim(); ++r)
+        {
+            if (a.num_row_non_zeros(r) != b.num_row_non_zeros(r))
+                return false;
+
+            row_proxy row = a.row(r);
+            for (typename row_proxy::const_iterator it = row.begin(); it != row.end(); ++it)
+            {
+                index_type c = it.index();
+                if (!b.has(r, c))
+                    return false;
+
+                MPOTensor_detail::term_descriptor<Matrix, SymmGroup, true> at = a.at(r, c), bt = b.at(r, c);
+                if (at.size() != bt.size())
+                    return false;
+
+                for (std::size_t k = 0; k < at.size(); ++k)
+                    if (a.tag_number(r, c, k) != b.tag_number(r, c, k) || at.scale(k) != bt.scale(k))
+                        return false;
+            }
+        }
+
+        return true;
+    }
+
+    static bool same_bond(typename MPOTensor<Matrix, SymmGroup>::BondProperty const & a,
+                          typename MPOTensor<Matrix, SymmGroup>::BondProperty const & b)
+    {
+        if (a.size() != b.size() || a.conj().size() != b.conj().size())
+            return false;
+
+        for (index_type i = 0; i < a.size(); ++i)
+            if (a.spin(i) != b.spin(i))
+                return false;
+
+        for (index_type i = 0; i < a.conj().size(); ++i)
+            if (a.conj().conj(i) != b.conj().conj(i) || a.conj().phase(i) != b.conj().phase(i))
+                return false;
+
+        return true;
+    }
+
+    MPS<Matrix, SymmGroup> const & bra;
+    MPS<Matrix, SymmGroup> const & ket;
+    bool symmetric;
+    std::size_t max_bytes, bytes, clock;
+
+    Boundary<Matrix, SymmGroup> initial;
+    std::vector<MPOTensor<Matrix, SymmGroup> > last;
+    std::map<std::size_t, entry> stored;
+};
+
+#endif
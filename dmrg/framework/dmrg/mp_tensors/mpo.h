@@ -28,7 +28,10 @@
 #define MPO_H
 
 #include <vector>
+#include <algorithm>
 #include <set>
+#include <map>
+#include <limits>
 #include <boost/serialization/vector.hpp>
 
 #include "dmrg/mp_tensors/mpotensor.h"
@@ -37,6 +40,10 @@ template<class Matrix, class SymmGroup, typename = void>
 class MPO : public std::vector<MPOTensor<Matrix, SymmGroup> >
 {
     typedef std::vector<MPOTensor<Matrix, SymmGroup> > base;
+    typedef typename SymmGroup::charge charge;
+    typedef typename MPOTensor<Matrix, SymmGroup>::index_type index_type;
+    // physical states as (charge sector, offset within the sector)
+    typedef std::vector<std::pair<charge, std::size_t> > phys_states;
 
 public:
     typedef MPOTensor<Matrix, SymmGroup> elem_type;
@@ -50,29 +57,56 @@ public:
     
     std::size_t length() const { return this->size(); }
     
+    /// Canonical compression: a QR sweep from the left brings the MPO into left-canonical form,
+    /// the following SVD sweep from the right then truncates every bond against its true singular
+    /// values, dropping those below cutoff times the largest one. The rotated bonds lose their
+    /// Hermitian pairs, so the MPO is left as it was if no bond can be reduced.
     void compress(double cutoff)
     {
+        std::size_t L = this->size();
+        if (L < 2)
+            return;
+
         calc_charges();
-        
-        for (int p = 0; p < this->size()-1; ++p) {
-            MPOTensor<Matrix, SymmGroup> b1 = (*this)[p], b2 = (*this)[p+1];
-            
-            block_matrix<Matrix, SymmGroup> left = make_left_matrix(p);
-            block_matrix<Matrix, SymmGroup> right = make_right_matrix(p+1);
-            
-            block_matrix<Matrix, SymmGroup> M, U, V;
-
-            block_matrix<typename alps::numeric::associated_real_diagonal_matrix<Matrix>::type, SymmGroup> S, Sqrt;
-            gemm(left, right, M);
-            svd_truncate(M, U, V, S, cutoff, 100000, false);
-            Sqrt = sqrt(S);
-            gemm(U, Sqrt, left);
-            gemm(Sqrt, V, right);
-            
-            maquis::cout << "MPO bond truncation: " << bond_indices[p+1].sum_of_sizes() << " -> ";
-            replace_pair(left, right, p);
-            maquis::cout << bond_indices[p+1].sum_of_sizes() << std::endl;
+        MPO original = *this;
+        compressed_ops.reset(new OPTable<Matrix, SymmGroup>());
+
+        std::vector<std::size_t> before(L);
+        for (std::size_t p = 1; p < L; ++p)
+            before[p] = bond_indices[p].sum_of_sizes();
+
+        for (std::size_t p = 0; p < L-1; ++p) {
+            block_matrix<Matrix, SymmGroup> left = make_left_matrix(p), right = make_right_matrix(p+1);
+            block_matrix<Matrix, SymmGroup> Q, R, M;
+
+            qr(left, Q, R);
+            gemm(R, right, M);
+            replace_pair(Q, M, p, cutoff);
         }
+
+        for (std::size_t p = L-1; p > 0; --p) {
+            block_matrix<Matrix, SymmGroup> left = make_left_matrix(p-1), right = make_right_matrix(p);
+            block_matrix<Matrix, SymmGroup> U, V, M;
+            block_matrix<typename alps::numeric::associated_real_diagonal_matrix<Matrix>::type, SymmGroup> S;
+
+            svd_truncate(right, U, V, S, cutoff, 100000, false);
+            gemm(left, U, M);
+            gemm(M, S, left);
+            replace_pair(left, V, p-1, cutoff);
+        }
+
+        bool reduced = false;
+        for (std::size_t p = 1; p < L; ++p)
+            reduced = reduced || bond_indices[p].sum_of_sizes() < before[p];
+        if (!reduced) {
+            *this = original;
+            maquis::cout << "MPO compression: no bond reduced, keeping the original MPO" << std::endl;
+            return;
+        }
+
+        for (std::size_t p = 1; p < L; ++p)
+            maquis::cout << "MPO bond reduction (exact) at site " << p << ": " << before[p] << " -> "
+                         << bond_indices[p].sum_of_sizes() << std::endl;
     }
 
     void setCoreEnergy(double e) { core_energy = e; }
@@ -81,6 +115,8 @@ public:
 private:
     std::vector<std::map<std::size_t, typename SymmGroup::charge> > bond_index_charges;
     std::vector<Index<SymmGroup> > bond_indices;
+    // operators of the compressed tensors, shared by all sites so that equal entries share a tag
+    boost::shared_ptr<OPTable<Matrix, SymmGroup> > compressed_ops;
     double core_energy;
 
     friend class boost::serialization::access;
@@ -111,13 +147,6 @@ private:
                         charge_diffs.insert(SymmGroup::fuse(bond_index_charges[p-1][r],
                                                             SymmGroup::fuse((*this)[p-1].at(r,c).op().basis().left_charge(b),
                                                                             -(*this)[p-1].at(r,c).op().basis().right_charge(b))));
-//                        maquis::cout << r << " " << c << std::endl;
-//                        maquis::cout << bond_index_charges[p-1][r] << std::endl;
-//                        maquis::cout << (*this)[p-1](r,c).basis().left_charge(b) << std::endl;
-//                        maquis::cout << (*this)[p-1](r,c).basis().right_charge(b) << std::endl;
-//                        std::copy(charge_diffs.begin(), charge_diffs.end(),
-//                                  std::ostream_iterator<typename SymmGroup::charge>(maquis::cout, " "));
-//                        maquis::cout << std::endl << std::endl;
                     }
                 }
 #ifndef NDEBUG
@@ -145,267 +174,259 @@ private:
                     index.insert(std::make_pair(it->second, 1));
         }
     }
-    
-    block_matrix<Matrix, SymmGroup> make_left_matrix(std::size_t p)
+
+    // union of the sectors all operators on site p act on
+    Index<SymmGroup> phys_basis(std::size_t p) const
     {
-        typedef typename SymmGroup::charge charge;
-        
+        MPOTensor<Matrix, SymmGroup> const & W = (*this)[p];
+
         Index<SymmGroup> phys_i;
-        for (size_t r = 0; r < (*this)[p].row_dim(); ++r)
-            for (size_t c = 0; c < (*this)[p].col_dim(); ++c)
+        for (index_type r = 0; r < W.row_dim(); ++r)
+            for (index_type c = 0; c < W.col_dim(); ++c)
             {
-                if (!(*this)[p].has(r,c))
+                if (!W.has(r,c))
                     continue;
-                for (size_t cs = 0; cs < (*this)[p].at(r, c).op().basis().size(); ++cs) {
-                    //std::pair<charge, size_t> sector = (*this)[p].at(r, c).op.left_basis()[cs];
-                    typename DualIndex<SymmGroup>::value_type sector = (*this)[p].at(r, c).op().basis()[cs];
-                    //if (! phys_i.has(sector.first))
-                    if (! phys_i.has(sector.lc))
-                        phys_i.insert(std::make_pair(sector.lc, sector.ls));
-                }
-            }
-        
-        Index<SymmGroup> left_i = phys_i * adjoin(phys_i) * bond_indices[p];
-        Index<SymmGroup> right_i = bond_indices[p+1];
-        
-        left_i = common_subset(left_i, right_i);
-        
-        block_matrix<Matrix, SymmGroup> ret(left_i, right_i);
-        
-        std::map<charge, size_t> visited_c_basis;
-        for (size_t c = 0; c < (*this)[p].col_dim(); ++c) {
-            int outr = -1;
-            for (size_t r = 0; r < (*this)[p].row_dim(); ++r)
-                for (size_t ls = 0; ls < phys_i.size(); ++ls)
-                    for (size_t rs = 0; rs < phys_i.size(); ++rs) {
-                        charge lc = SymmGroup::fuse(bond_index_charges[p][r],
-                                                    SymmGroup::fuse(phys_i[ls].first,
-                                                                    -phys_i[rs].first));
-                        charge rc = bond_index_charges[p+1][c];
-                        
-                        if (lc != rc)
-                            continue;
-                        
-                        outr++;
-                        
-                        if (! (*this)[p].has(r,c))
-                            continue;
-                        if (! (*this)[p].at(r,c).op().has_block(phys_i[ls].first, phys_i[rs].first) )
-                            continue;                       
-                        
-                        //std::size_t cs = (*this)[p].at(r, c).op().left_basis().position(phys_i[ls].first);
-                        std::size_t cs = (*this)[p].at(r, c).op().basis().position(phys_i[ls].first, phys_i[rs].first);
-                        
-                        assert( lc == rc );
-                        assert( outr < left_i.size_of_block(lc) );
-                        
-                        // ...for now...
-                        assert( num_rows((*this)[p].at(r,c).op()[cs]) == 1 );
-                        assert( num_cols((*this)[p].at(r,c).op()[cs]) == 1 );
-                        
-                        ret(std::make_pair(lc, outr),
-                            std::make_pair(rc, visited_c_basis[rc])) =
-                        (*this)[p].at(r,c).op()[cs](0,0);
-                        
-//                        maquis::cout << (*this)[p](r,c)[cs](0,0) << " | ";
-//                        maquis::cout << r << " " << c << " " << phys_i[ls].first << " " << phys_i[rs].first;
-//                        maquis::cout << " -> ";
-//                        maquis::cout << "(" << lc << "," << outr << ") (" << rc << "," << visited_c_basis[rc] << ")" << std::endl;
+                MPOTensor_detail::term_descriptor<Matrix, SymmGroup, true> term = W.at(r,c);
+                for (std::size_t k = 0; k < term.size(); ++k)
+                    for (std::size_t cs = 0; cs < term.op(k).basis().size(); ++cs) {
+                        typename DualIndex<SymmGroup>::value_type sector = term.op(k).basis()[cs];
+                        if (! phys_i.has(sector.lc))
+                            phys_i.insert(std::make_pair(sector.lc, sector.ls));
+                        if (! phys_i.has(sector.rc))
+                            phys_i.insert(std::make_pair(sector.rc, sector.rs));
                     }
-            visited_c_basis[bond_index_charges[p+1][c]]++;
+            }
+        return phys_i;
+    }
+
+    static phys_states states(Index<SymmGroup> const & phys_i)
+    {
+        phys_states ret;
+        for (std::size_t b = 0; b < phys_i.size(); ++b)
+            for (std::size_t s = 0; s < phys_i[b].second; ++s)
+                ret.push_back(std::make_pair(phys_i[b].first, s));
+        return ret;
+    }
+
+    // matrix element <ls| W(r,c) |rs>, summed over all terms of the entry
+    typename Matrix::value_type element(std::size_t p, index_type r, index_type c,
+                                        std::pair<charge, std::size_t> const & ls,
+                                        std::pair<charge, std::size_t> const & rs) const
+    {
+        typename Matrix::value_type ret = 0.;
+        MPOTensor_detail::term_descriptor<Matrix, SymmGroup, true> term = (*this)[p].at(r,c);
+        for (std::size_t k = 0; k < term.size(); ++k) {
+            std::size_t b = term.op(k).find_block(ls.first, rs.first);
+            if (b < term.op(k).n_blocks())
+                ret += term.scale(k) * term.op(k)[b](ls.second, rs.second);
         }
-        
-//        maquis::cout << ret << std::endl;
-//        maquis::cout << "###" << std::endl;
-        
         return ret;
     }
-    
-    block_matrix<Matrix, SymmGroup> make_right_matrix(std::size_t p)
+
+    // offset of every bond index within its charge block
+    std::vector<std::size_t> bond_offsets(std::size_t p) const
     {
-        typedef typename SymmGroup::charge charge;
-        
-        Index<SymmGroup> phys_i;
-        for (size_t r = 0; r < (*this)[p].row_dim(); ++r)
-            for (size_t c = 0; c < (*this)[p].col_dim(); ++c)
+        std::map<charge, std::size_t> visited;
+        std::vector<std::size_t> ret(bond_index_charges[p].size());
+        for (std::size_t b = 0; b < ret.size(); ++b)
+            ret[b] = visited[bond_index_charges[p].find(b)->second]++;
+        return ret;
+    }
+
+    // row (column) offset of (b, ls, rs) within the charge block it fuses to,
+    // with b the left (right) bond index of site p
+    std::vector<std::size_t> fused_offsets(std::size_t p, phys_states const & st, bool left) const
+    {
+        std::size_t S = st.size();
+        std::size_t D = left ? (*this)[p].row_dim() : (*this)[p].col_dim();
+        std::map<charge, std::size_t> visited;
+        std::vector<std::size_t> ret(D * S * S);
+        for (std::size_t b = 0; b < D; ++b)
+            for (std::size_t ls = 0; ls < S; ++ls)
+                for (std::size_t rs = 0; rs < S; ++rs)
+                    ret[(b * S + ls) * S + rs] = visited[fused_charge(p, b, st[ls].first, st[rs].first, left)]++;
+        return ret;
+    }
+
+    charge fused_charge(std::size_t p, std::size_t b, charge ls, charge rs, bool left) const
+    {
+        if (left)
+            return SymmGroup::fuse(bond_index_charges[p].find(b)->second, SymmGroup::fuse(ls, -rs));
+        else
+            return SymmGroup::fuse(bond_index_charges[p+1].find(b)->second, SymmGroup::fuse(-ls, rs));
+    }
+
+    // W[p] reshaped to rows (left bond, ls, rs) and columns (right bond)
+    block_matrix<Matrix, SymmGroup> make_left_matrix(std::size_t p) const
+    {
+        Index<SymmGroup> phys_i = phys_basis(p);
+        phys_states st = states(phys_i);
+        std::size_t S = st.size();
+
+        Index<SymmGroup> left_i = phys_i * adjoin(phys_i) * bond_indices[p];
+        Index<SymmGroup> const & right_i = bond_indices[p+1];
+
+        block_matrix<Matrix, SymmGroup> ret;
+        for (std::size_t i = 0; i < right_i.size(); ++i)
+            if (left_i.has(right_i[i].first))
+                ret.insert_block(Matrix(left_i.size_of_block(right_i[i].first), right_i[i].second, 0.),
+                                 right_i[i].first, right_i[i].first);
+
+        std::vector<std::size_t> row_offsets = fused_offsets(p, st, true);
+        std::vector<std::size_t> col_offsets = bond_offsets(p+1);
+
+        MPOTensor<Matrix, SymmGroup> const & W = (*this)[p];
+        for (index_type c = 0; c < W.col_dim(); ++c) {
+            charge rc = bond_index_charges[p+1].find(c)->second;
+            typename MPOTensor<Matrix, SymmGroup>::col_proxy col = W.column(c);
+            for (typename MPOTensor<Matrix, SymmGroup>::col_proxy::const_iterator it = col.begin(); it != col.end(); ++it)
             {
-                if (!(*this)[p].has(r,c))
-                    continue;
-                for (size_t cs = 0; cs < (*this)[p].at(r, c).op().basis().size(); ++cs) {
-                    //std::pair<charge, size_t> sector = (*this)[p].at(r, c).op.left_basis()[cs];
-                    typename DualIndex<SymmGroup>::value_type sector = (*this)[p].at(r, c).op().basis()[cs];
-                    //if (! phys_i.has(sector.first))
-                    if (! phys_i.has(sector.lc))
-                        //phys_i.insert(sector);
-                        phys_i.insert(std::make_pair(sector.lc, sector.ls));
-                }
-            }
-        
-        Index<SymmGroup> left_i = bond_indices[p];
-        Index<SymmGroup> right_i = adjoin(phys_i) * phys_i * bond_indices[p+1];
-        
-        right_i = common_subset(right_i, left_i);
-        
-        block_matrix<Matrix, SymmGroup> ret(left_i, right_i);
-        
-        std::map<charge, size_t> visited_r_basis;
-        for (size_t r = 0; r < (*this)[p].row_dim(); ++r) {
-            int outc = -1;
-            for (size_t c = 0; c < (*this)[p].col_dim(); ++c)
-                for (size_t ls = 0; ls < phys_i.size(); ++ls)
-                    for (size_t rs = 0; rs < phys_i.size(); ++rs) {
-                        charge lc = bond_index_charges[p][r];
-                        charge rc = SymmGroup::fuse(bond_index_charges[p+1][c],
-                                                    SymmGroup::fuse(-phys_i[ls].first,
-                                                                    phys_i[rs].first));
-                        
-                        if (lc != rc)
-                            continue;
-                        
-                        outc++;
-                        
-                        if (! (*this)[p].has(r,c))
-                            continue;
-                        if (! (*this)[p].at(r, c).op().has_block(phys_i[ls].first, phys_i[rs].first) )
+                index_type r = it.index();
+                for (std::size_t ls = 0; ls < S; ++ls)
+                    for (std::size_t rs = 0; rs < S; ++rs)
+                    {
+                        if (fused_charge(p, r, st[ls].first, st[rs].first, true) != rc)
                             continue;
-                        
-                        //std::size_t cs = (*this)[p].at(r, c).op().left_basis().position(phys_i[ls].first);
-                        std::size_t cs = (*this)[p].at(r, c).op().basis().position(phys_i[ls].first, phys_i[rs].first);
-                        
-                        assert( lc == rc );
-                        assert( outc < right_i.size_of_block(rc) );
-                        
-                        // ...for now...
-                        assert( num_rows((*this)[p].at(r,c).op()[cs]) == 1 );
-                        assert( num_cols((*this)[p].at(r,c).op()[cs]) == 1 );
-                        
-                        ret(std::make_pair(lc, visited_r_basis[lc]),
-                            std::make_pair(rc, outc)) =
-                        (*this)[p].at(r,c).op()[cs](0,0);
-                        
-//                        maquis::cout << (*this)[p](r,c)[cs](0,0) << " | ";
-//                        maquis::cout << r << " " << c << " " << phys_i[ls].first << " " << phys_i[rs].first;
-//                        maquis::cout << " -> ";
-//                        maquis::cout << "(" << lc << "," << visited_r_basis[lc] << ") (" << rc << "," << outc << ")" << std::endl;
+                        typename Matrix::value_type val = element(p, r, c, st[ls], st[rs]);
+                        if (val != typename Matrix::value_type(0.))
+                            ret(std::make_pair(rc, row_offsets[(r * S + ls) * S + rs]),
+                                std::make_pair(rc, col_offsets[c])) = val;
                     }
-            visited_r_basis[bond_index_charges[p][r]]++;
+            }
         }
-        
-//        maquis::cout << ret << std::endl;
-//        maquis::cout << "###" << std::endl;
-        
         return ret;
     }
     
-    void replace_pair(block_matrix<Matrix, SymmGroup> & left,
-                      block_matrix<Matrix, SymmGroup> & right,
-                      std::size_t p)
+    // W[p] reshaped to rows (left bond) and columns (ls, rs, right bond)
+    block_matrix<Matrix, SymmGroup> make_right_matrix(std::size_t p) const
     {
-        typedef typename SymmGroup::charge charge;
-        
-        Index<SymmGroup> phys_i;
-        for (size_t r = 0; r < (*this)[p].row_dim(); ++r)
-            for (size_t c = 0; c < (*this)[p].col_dim(); ++c)
+        Index<SymmGroup> phys_i = phys_basis(p);
+        phys_states st = states(phys_i);
+        std::size_t S = st.size();
+
+        Index<SymmGroup> const & left_i = bond_indices[p];
+        Index<SymmGroup> right_i = adjoin(phys_i) * phys_i * bond_indices[p+1];
+
+        block_matrix<Matrix, SymmGroup> ret;
+        for (std::size_t i = 0; i < left_i.size(); ++i)
+            if (right_i.has(left_i[i].first))
+                ret.insert_block(Matrix(left_i[i].second, right_i.size_of_block(left_i[i].first), 0.),
+                                 left_i[i].first, left_i[i].first);
+
+        std::vector<std::size_t> row_offsets = bond_offsets(p);
+        std::vector<std::size_t> col_offsets = fused_offsets(p, st, false);
+
+        MPOTensor<Matrix, SymmGroup> const & W = (*this)[p];
+        for (index_type r = 0; r < W.row_dim(); ++r) {
+            charge lc = bond_index_charges[p].find(r)->second;
+            typename MPOTensor<Matrix, SymmGroup>::row_proxy row = W.row(r);
+            for (typename MPOTensor<Matrix, SymmGroup>::row_proxy::const_iterator it = row.begin(); it != row.end(); ++it)
             {
-                for (size_t cs = 0; cs < (*this)[p].at(r, c).op().basis().size(); ++cs) {
-                    //std::pair<charge, size_t> sector = (*this)[p].at(r, c).op.left_basis()[cs];
-                    typename DualIndex<SymmGroup>::value_type sector = (*this)[p].at(r, c).op().basis()[cs];
-                    //if (! phys_i.has(sector.first))
-                    if (! phys_i.has(sector.lc))
-                        //phys_i.insert(sector);
-                        phys_i.insert(std::make_pair(sector.lc, sector.ls));
-                }
-            }
-        
-        assert( left.right_basis() == right.left_basis() );
-        bond_indices[p+1] = left.right_basis();
-        {
-            std::size_t count = 0;
-            bond_index_charges[p+1].clear();
-            Index<SymmGroup> left_right_basis_cp = left.right_basis();
-            for (size_t i = 0; i < left_right_basis_cp.size(); ++i)
-                bond_index_charges[p+1][count++] = left_right_basis_cp[i].first;
-        }
-        
-        (*this)[p] = MPOTensor<Matrix, SymmGroup>((*this)[p].row_dim(),
-                                                  bond_indices[p+1].sum_of_sizes());
-        
-        std::map<charge, size_t> visited_c_basis;
-        for (size_t c = 0; c < (*this)[p].col_dim(); ++c) {
-            int outr = -1;
-            for (size_t r = 0; r < (*this)[p].row_dim(); ++r)
-                for (size_t ls = 0; ls < phys_i.size(); ++ls)
-                    for (size_t rs = 0; rs < phys_i.size(); ++rs)
+                index_type c = it.index();
+                for (std::size_t ls = 0; ls < S; ++ls)
+                    for (std::size_t rs = 0; rs < S; ++rs)
                     {
-                        charge lc = SymmGroup::fuse(bond_index_charges[p][r],
-                                                    SymmGroup::fuse(phys_i[ls].first,
-                                                                    -phys_i[rs].first));
-                        charge rc = bond_index_charges[p+1][c];
-                        
-                        if (lc != rc)
+                        if (fused_charge(p, c, st[ls].first, st[rs].first, false) != lc)
                             continue;
-                        
-                        outr++;
-                        
-                        typename Matrix::value_type val = left(std::make_pair(lc, outr),
-                                                               std::make_pair(rc, visited_c_basis[rc]));
-                        
-                        if (std::abs(val) > 1e-40) {
-                            typename operator_selector<Matrix, SymmGroup>::type block;
-                            charge blc = phys_i[ls].first, brc = phys_i[rs].first;
-                            if ( (*this)[p].has(r,c) )
-                                block = (*this)[p].at(r,c).op();
-                            block.insert_block(Matrix(1, 1, val), blc, brc);
-                            (*this)[p].set(r, c, block);
-                            
-//                            maquis::cout << val << " | ";
-//                            maquis::cout << r << " " << c << " " << phys_i[ls].first << " " << phys_i[rs].first;
-//                            maquis::cout << " <- ";
-//                            maquis::cout << "(" << lc << "," << outr << ") (" << rc << "," << visited_c_basis[rc] << ")" << std::endl;
-                        }
+                        typename Matrix::value_type val = element(p, r, c, st[ls], st[rs]);
+                        if (val != typename Matrix::value_type(0.))
+                            ret(std::make_pair(lc, row_offsets[r]),
+                                std::make_pair(lc, col_offsets[(c * S + ls) * S + rs])) = val;
                     }
-            visited_c_basis[bond_index_charges[p+1][c]]++;
+            }
         }
-        
-        (*this)[p+1] = MPOTensor<Matrix, SymmGroup>(bond_indices[p+1].sum_of_sizes(),
-                                                    (*this)[p+1].col_dim());
-        
-        std::map<charge, size_t> visited_r_basis;
-        for (size_t r = 0; r < (*this)[p+1].row_dim(); ++r) {
-            int outc = -1;
-            for (size_t c = 0; c < (*this)[p+1].col_dim(); ++c)
-                for (size_t ls = 0; ls < phys_i.size(); ++ls)
-                    for (size_t rs = 0; rs < phys_i.size(); ++rs)
+        return ret;
+    }
+
+    static double max_abs(block_matrix<Matrix, SymmGroup> const & M)
+    {
+        double ret = 0.;
+        for (std::size_t b = 0; b < M.n_blocks(); ++b)
+            for (std::size_t i = 0; i < num_rows(M[b]); ++i)
+                for (std::size_t j = 0; j < num_cols(M[b]); ++j)
+                    ret = std::max(ret, static_cast<double>(std::abs(M[b](i,j))));
+        return ret;
+    }
+
+    // inverse of make_left_matrix / make_right_matrix: elements below cutoff times the largest one
+    // are dropped, entries equal up to a scale share one tag in compressed_ops. Only the end bonds
+    // are never rotated, so only they keep their Hermitian pairs.
+    elem_type make_tensor(block_matrix<Matrix, SymmGroup> const & M, std::size_t p,
+                          Index<SymmGroup> const & phys_i, bool left, double cutoff) const
+    {
+        typedef typename operator_selector<Matrix, SymmGroup>::type op_t;
+        typedef typename elem_type::tag_type tag_type;
+        typedef typename elem_type::value_type value_type;
+        typedef typename elem_type::prempo_t prempo_t;
+
+        phys_states st = states(phys_i);
+        std::size_t S = st.size();
+        index_type rows = bond_index_charges[p].size(), cols = bond_index_charges[p+1].size();
+        double threshold = cutoff * max_abs(M);
+
+        std::vector<std::size_t> bond_pos = bond_offsets(left ? p+1 : p);
+        std::vector<std::size_t> fused_pos = fused_offsets(p, st, left);
+
+        std::map<std::pair<index_type, index_type>, op_t> ops;
+        for (index_type r = 0; r < rows; ++r)
+            for (index_type c = 0; c < cols; ++c)
+                for (std::size_t ls = 0; ls < S; ++ls)
+                    for (std::size_t rs = 0; rs < S; ++rs)
                     {
-                        charge lc = bond_index_charges[p+1][r];
-                        charge rc = SymmGroup::fuse(bond_index_charges[p+2][c],
-                                                    SymmGroup::fuse(-phys_i[ls].first,
-                                                                    phys_i[rs].first));
-                        
-                        if (lc != rc)
+                        index_type b = left ? r : c, k = left ? c : r;
+                        charge bc = bond_index_charges[left ? p+1 : p].find(k)->second;
+                        if (fused_charge(p, b, st[ls].first, st[rs].first, left) != bc)
                             continue;
-                        
-                        outc++;
-                        
-                        typename Matrix::value_type val = right(std::make_pair(lc, visited_r_basis[lc]),
-                                                                std::make_pair(rc, outc));
-                        
-                        if (std::abs(val) > 1e-40) {
-                            typename operator_selector<Matrix, SymmGroup>::type block;
-                            charge blc = phys_i[ls].first, brc = phys_i[rs].first;
-                            if ( (*this)[p+1].has(r,c) )
-                                block = (*this)[p+1].at(r,c).op();
-                            block.insert_block(Matrix(1, 1, val), blc, brc);
-                            (*this)[p+1].set(r, c, block);
-                            
-//                            maquis::cout << val << " | ";
-//                            maquis::cout << r << " " << c << " " << phys_i[ls].first << " " << phys_i[rs].first;
-//                            maquis::cout << " <- ";
-//                            maquis::cout << "(" << lc << "," << visited_r_basis[lc] << ") (" << rc << "," << outc << ")" << std::endl;
+                        std::size_t fused = fused_pos[(b * S + ls) * S + rs];
+
+                        typename Matrix::value_type val = left
+                            ? M(std::make_pair(bc, fused), std::make_pair(bc, bond_pos[k]))
+                            : M(std::make_pair(bc, bond_pos[k]), std::make_pair(bc, fused));
+
+                        if (std::abs(val) > threshold) {
+                            op_t & block = ops[std::make_pair(r, c)];
+                            if (! block.has_block(st[ls].first, st[rs].first))
+                                block.insert_block(Matrix(phys_i.size_of_block(st[ls].first),
+                                                          phys_i.size_of_block(st[rs].first), 0.),
+                                                   st[ls].first, st[rs].first);
+                            block(st[ls].first, st[rs].first)(st[ls].second, st[rs].second) = val;
                         }
                     }
-            visited_r_basis[bond_index_charges[p+1][r]]++;
+
+        prempo_t prempo;
+        for (typename std::map<std::pair<index_type, index_type>, op_t>::const_iterator it = ops.begin();
+             it != ops.end(); ++it)
+        {
+            std::pair<tag_type, value_type> tag = compressed_ops->checked_register(it->second);
+            prempo.push_back(boost::make_tuple(it->first.first, it->first.second, tag.first, tag.second));
+        }
+
+        typename elem_type::BondProperty lb(rows), rb(cols);
+        if (p == 0)
+            lb = (*this)[p].leftBond();
+        if (p == this->size()-1)
+            rb = (*this)[p].rightBond();
+        return elem_type(rows, cols, prempo, compressed_ops, lb, rb);
+    }
+
+    void replace_pair(block_matrix<Matrix, SymmGroup> const & left,
+                      block_matrix<Matrix, SymmGroup> const & right,
+                      std::size_t p, double cutoff)
+    {
+        Index<SymmGroup> phys_l = phys_basis(p), phys_r = phys_basis(p+1);
+        
+        assert( left.right_basis() == right.left_basis() );
+        bond_indices[p+1] = left.right_basis();
+        bond_index_charges[p+1].clear();
+        {
+            std::size_t count = 0;
+            for (size_t i = 0; i < bond_indices[p+1].size(); ++i)
+                for (size_t s = 0; s < bond_indices[p+1][i].second; ++s)
+                    bond_index_charges[p+1][count++] = bond_indices[p+1][i].first;
         }
+
+        (*this)[p] = make_tensor(left, p, phys_l, true, cutoff);
+        (*this)[p+1] = make_tensor(right, p+1, phys_r, false, cutoff);
     }
 };
 
@@ -428,15 +449,44 @@ public:
     
     std::size_t length() const { return this->size(); }
     
+    /// Exact compression that keeps operator tags and bond spins: a bond index whose column
+    /// (row) is a multiple of another one with the same spin is folded into the partner's row
+    /// (column) on the neighbouring site, empty bond indices are dropped. A truncated SVD would
+    /// mix operators of different spin within one entry, which reduced matrix elements cannot hold,
+    /// so nothing is truncated here. Two entries count as parallel if their scales agree to the
+    /// relative tolerance cutoff.
     void compress(double cutoff)
     {
-        throw std::runtime_error("MPO compression for SU2 not implemented\n");
+        std::size_t L = this->size();
+        if (L < 2)
+            return;
+
+        std::vector<std::size_t> before(L);
+        for (std::size_t p = 1; p < L; ++p)
+            before[p] = (*this)[p].row_dim();
+
+        for (std::size_t p = 0; p < L-1; ++p)
+            deparallelise(p, true, cutoff);
+        for (std::size_t p = L-1; p > 0; --p)
+            deparallelise(p-1, false, cutoff);
+
+        for (std::size_t p = 1; p < L; ++p)
+            maquis::cout << "MPO bond truncation at site " << p << ": " << before[p] << " -> "
+                         << (*this)[p].row_dim() << std::endl;
     }
 
     void setCoreEnergy(double e) { core_energy = e; }
     double getCoreEnergy() const { return core_energy; }
 
 private:
+    typedef typename elem_type::index_type index_type;
+    typedef typename elem_type::tag_type tag_type;
+    typedef typename elem_type::value_type value_type;
+    typedef typename elem_type::BondProperty BondProperty;
+    // summed scale per operator tag of one entry, and the nonzero entries of one row or column
+    typedef std::map<tag_type, value_type> entry_t;
+    typedef std::map<index_type, entry_t> line_t;
+
     double core_energy;
 
     friend class boost::serialization::access;
@@ -446,6 +496,174 @@ private:
     {
         ar & core_energy & boost::serialization::base_object<base>(*this);
     }
+
+    static void add_entry(elem_type const & W, index_type r, index_type c, entry_t & e)
+    {
+        MPOTensor_detail::term_descriptor<Matrix, SymmGroup, true> term = W.at(r, c);
+        for (std::size_t k = 0; k < term.size(); ++k)
+            e[W.tag_number(r, c, k)] += term.scale(k);
+    }
+
+    static line_t get_line(elem_type const & W, index_type b, bool column)
+    {
+        line_t ret;
+        if (column) {
+            typename elem_type::col_proxy col = W.column(b);
+            for (typename elem_type::col_proxy::const_iterator it = col.begin(); it != col.end(); ++it)
+                add_entry(W, it.index(), b, ret[it.index()]);
+        }
+        else {
+            typename elem_type::row_proxy row = W.row(b);
+            for (typename elem_type::row_proxy::const_iterator it = row.begin(); it != row.end(); ++it)
+                add_entry(W, b, it.index(), ret[it.index()]);
+        }
+
+        for (typename line_t::iterator it = ret.begin(); it != ret.end(); ) {
+            for (typename entry_t::iterator t = it->second.begin(); t != it->second.end(); )
+                if (t->second == value_type(0.)) it->second.erase(t++);
+                else ++t;
+            if (it->second.empty()) ret.erase(it++);
+            else ++it;
+        }
+        return ret;
+    }
+
+    // b == alpha * a
+    static bool parallel(line_t const & a, line_t const & b, double tol, value_type & alpha)
+    {
+        if (a.size() != b.size())
+            return false;
+
+        bool first = true;
+        for (typename line_t::const_iterator ia = a.begin(), ib = b.begin(); ia != a.end(); ++ia, ++ib) {
+            if (ia->first != ib->first || ia->second.size() != ib->second.size())
+                return false;
+            for (typename entry_t::const_iterator ta = ia->second.begin(), tb = ib->second.begin();
+                 ta != ia->second.end(); ++ta, ++tb)
+            {
+                if (ta->first != tb->first)
+                    return false;
+                if (first) {
+                    alpha = tb->second / ta->second;
+                    first = false;
+                }
+                else if (std::abs(tb->second - alpha * ta->second) > tol * std::abs(tb->second))
+                    return false;
+            }
+        }
+        return !first;
+    }
+
+    // keeps the spins of the surviving indices and the hermitian pairs among the unmodified ones
+    static BondProperty filter_bond(BondProperty const & bp, std::vector<index_type> const & new_index,
+                                    std::vector<bool> const & valid, index_type d)
+    {
+        typename elem_type::spin_index spins;
+        MPOTensor_detail::Hermitian herm(d);
+        for (index_type b = 0; b < new_index.size(); ++b) {
+            if (new_index[b] == std::numeric_limits<index_type>::max())
+                continue;
+            spins.push_back(bp.spin(b));
+
+            index_type a = bp.conj().conj(b);
+            if (!valid[b] || a >= new_index.size() || !valid[a])
+                continue;
+            if (a == b)
+                herm.register_self_adjoint(new_index[b]);
+            else if (b < a)
+                herm.register_hermitian_pair(new_index[b], new_index[a], bp.conj().phase(b), bp.conj().phase(a));
+        }
+        return BondProperty(spins, herm);
+    }
+
+    // merges parallel columns of W[p] (columns == true) or parallel rows of W[p+1]
+    void deparallelise(std::size_t p, bool columns, double tol)
+    {
+        elem_type const & W = (*this)[p];
+        elem_type const & X = (*this)[p+1];
+        index_type D = W.col_dim();
+
+        // lines are compared, partners absorb the lines merged away
+        std::vector<line_t> lines(D), partners(D);
+        for (index_type b = 0; b < D; ++b) {
+            lines[b] = get_line(columns ? W : X, b, columns);
+            partners[b] = get_line(columns ? X : W, b, !columns);
+        }
+
+        std::vector<bool> keep(D, true), touched(D, false);
+        std::map<std::pair<std::size_t, index_type>, std::vector<index_type> > candidates;
+        for (index_type b = 0; b < D; ++b) {
+            if (lines[b].empty() || partners[b].empty()) {
+                keep[b] = false;
+                continue;
+            }
+
+            std::vector<index_type> & bucket = candidates[std::make_pair(lines[b].size(), lines[b].begin()->first)];
+            for (std::size_t i = 0; i < bucket.size() && keep[b]; ++i) {
+                index_type a = bucket[i];
+                value_type alpha;
+                if (!(W.rightBond().spin(a) == W.rightBond().spin(b)) || !(X.leftBond().spin(a) == X.leftBond().spin(b))
+                    || !parallel(lines[a], lines[b], tol, alpha))
+                    continue;
+
+                for (typename line_t::const_iterator it = partners[b].begin(); it != partners[b].end(); ++it)
+                    for (typename entry_t::const_iterator t = it->second.begin(); t != it->second.end(); ++t)
+                        partners[a][it->first][t->first] += alpha * t->second;
+                keep[b] = false;
+                touched[a] = true;
+            }
+            if (keep[b])
+                bucket.push_back(b);
+        }
+
+        index_type d = 0;
+        std::vector<index_type> new_index(D, std::numeric_limits<index_type>::max());
+        std::vector<bool> valid(D);
+        for (index_type b = 0; b < D; ++b) {
+            if (keep[b])
+                new_index[b] = d++;
+            valid[b] = keep[b] && !touched[b];
+        }
+        if (d == D)
+            return;
+
+        typename elem_type::prempo_t w_terms, x_terms;
+        for (index_type b = 0; b < D; ++b) {
+            if (!keep[b])
+                continue;
+            line_t const & w_line = columns ? lines[b] : partners[b];
+            line_t const & x_line = columns ? partners[b] : lines[b];
+            for (typename line_t::const_iterator it = w_line.begin(); it != w_line.end(); ++it)
+                for (typename entry_t::const_iterator t = it->second.begin(); t != it->second.end(); ++t)
+                    w_terms.push_back(boost::make_tuple(it->first, new_index[b], t->first, t->second));
+            for (typename line_t::const_iterator it = x_line.begin(); it != x_line.end(); ++it)
+                for (typename entry_t::const_iterator t = it->second.begin(); t != it->second.end(); ++t)
+                    x_terms.push_back(boost::make_tuple(new_index[b], it->first, t->first, t->second));
+        }
+
+        elem_type W_new(W.row_dim(), d, w_terms, W.get_operator_table(),
+                        W.leftBond(), filter_bond(W.rightBond(), new_index, valid, d));
+        elem_type X_new(d, X.col_dim(), x_terms, X.get_operator_table(),
+                        filter_bond(X.leftBond(), new_index, valid, d), X.rightBond());
+        (*this)[p] = W_new;
+        (*this)[p+1] = X_new;
+    }
 };
 
+/// Bytes of the operators in the operator tables of mpo, a table shared by several tensors counts once
+template<class Matrix, class SymmGroup, class Enable>
+std::size_t size_of(MPO<Matrix, SymmGroup, Enable> const & mpo)
+{
+    std::set<void const *> seen;
+    std::size_t r = 0;
+    for (std::size_t p = 0; p < mpo.size(); ++p) {
+        typename MPOTensor<Matrix, SymmGroup>::op_table_ptr table = mpo[p].get_operator_table();
+        if (!table || !seen.insert(table.get()).second)
+            continue;
+        for (std::size_t k = 0; k < table->size(); ++k)
+            r += size_of((*table)[k]);
+    }
+    return r;
+}
+
 #endif
@@ -63,13 +63,23 @@ public:
                       BaseParameters & parms_)
     : mps(mps_)
     , mpsp(mps_)
-    , mpo(mpo_)
+    , mpo(&mpo_)
     , parms(parms_)
     {
         mps.canonize(0);
-        init_left_right(mpo);
-        
         mpsp = mps;
+
+        init_boundaries();
+    }
+
+    /// Apply mpo_ to the result of the previous fit, which also is the initial guess.
+    /// After finalize() that result is right normalized, so no canonization is needed.
+    void next(MPO<Matrix, SymmGroup> const & mpo_)
+    {
+        mpo = &mpo_;
+        mps = mpsp;
+
+        init_boundaries();
     }
     
     std::pair<double,double> sweep(int sweep)
@@ -77,6 +87,7 @@ public:
         std::chrono::high_resolution_clock::time_point sweep_now = std::chrono::high_resolution_clock::now();
         
         std::size_t L = mps.length();
+        MPO<Matrix, SymmGroup> const & mpo = *this->mpo;
         
         std::pair<double,double> eps;
         block_matrix<Matrix, SymmGroup> norm_boudary;
@@ -144,9 +155,11 @@ public:
     MPS<Matrix, SymmGroup> get_current_mps() const { return mpsp; }
     
 private:
-    void init_left_right(MPO<Matrix, SymmGroup> const & mpo)
+    // the remaining left boundaries are built by the first left to right half sweep
+    void init_boundaries()
     {
         std::size_t L = mps.length();
+        MPO<Matrix, SymmGroup> const & mpo = *this->mpo;
         
         left_.resize(mpo.length()+1);
         right_.resize(mpo.length()+1);
@@ -155,12 +168,6 @@ private:
         left_[0] = mps.left_boundary();
         Storage::evict(left_[0]);
         
-        for (int i = 0; i < L; ++i) {
-            Storage::drop(left_[i+1]);
-            left_[i+1] = contr::overlap_mpo_left_step(mpsp[i], mps[i], left_[i], mpo[i]);
-            Storage::evict(left_[i+1]);
-        }
-        
         Storage::drop(right_[L]);
         right_[L] = mps.right_boundary();
         Storage::evict(right_[L]);
@@ -173,7 +180,7 @@ private:
     }
     
     MPS<Matrix, SymmGroup> mps, mpsp;
-    MPO<Matrix, SymmGroup> const& mpo;
+    MPO<Matrix, SymmGroup> const * mpo;
 
     BaseParameters & parms;
     std::vector<Boundary<BoundaryMatrix, SymmGroup> > left_, right_;
@@ -142,14 +142,49 @@ MPO<Matrix, SymmGroup> cleanup_mpo(MPO<Matrix, SymmGroup> const & mpo)
     return ret;
 }
 
+// W x W for a single site, the row and column indices of the result are r1*D+r2, c1*D+c2
 template<class Matrix, class SymmGroup>
-MPO<Matrix, SymmGroup>
-square_mpo(MPO<Matrix, SymmGroup> const & mpo)
+MPOTensor<Matrix, SymmGroup>
+square_mpo_tensor(MPOTensor<Matrix, SymmGroup> const & inp)
 {
-    typedef typename SymmGroup::charge charge;
     typedef typename MPOTensor<Matrix, SymmGroup>::row_proxy row_proxy;
     typedef typename MPOTensor<Matrix, SymmGroup>::index_type index_type;
+
+    MPOTensor<Matrix, SymmGroup> ret(inp.row_dim()*inp.row_dim(),
+                                     inp.col_dim()*inp.col_dim());
     
+    for (index_type r1 = 0; r1 < inp.row_dim(); ++r1)
+    {
+        row_proxy row1 = inp.row(r1);
+        for (index_type r2 = 0; r2 < inp.row_dim(); ++r2)
+        {
+            row_proxy row2 = inp.row(r2);
+            for (typename row_proxy::const_iterator it1 = row1.begin(); it1 != row1.end(); ++it1)
+            {
+                index_type c1 = it1.index();
+                for (typename row_proxy::const_iterator it2 = row2.begin(); it2 != row2.end(); ++it2) {
+                    index_type c2 = it2.index();
+
+                    assert(inp.has(r1, c1));
+                    assert(inp.has(r2, c2));
+                    
+                    typename operator_selector<Matrix, SymmGroup>::type t;
+                    gemm(inp.at(r1, c1).op(), inp.at(r2, c2).op(), t);
+                    if (t.n_blocks() > 0)
+                        ret.set(r1*inp.row_dim()+r2, c1*inp.col_dim()+c2, 
+                                    t * (inp.at(r1, c1).scale() * inp.at(r2, c2).scale()));
+                }
+            }
+        }
+    }
+
+    return ret;
+}
+
+template<class Matrix, class SymmGroup>
+MPO<Matrix, SymmGroup>
+square_mpo(MPO<Matrix, SymmGroup> const & mpo)
+{
     size_t L = mpo.length();
     
     MPO<Matrix, SymmGroup> sq(L);
@@ -158,35 +193,7 @@ square_mpo(MPO<Matrix, SymmGroup> const & mpo)
     {
         MPOTensor<Matrix, SymmGroup> const & inp = mpo[p];
         maquis::cout << "MPOTensor " << inp.row_dim()*inp.row_dim() << " " << inp.col_dim()*inp.col_dim() << std::endl;
-        MPOTensor<Matrix, SymmGroup> ret(inp.row_dim()*inp.row_dim(),
-                                         inp.col_dim()*inp.col_dim());
-        
-        for (index_type r1 = 0; r1 < inp.row_dim(); ++r1)
-        {
-            row_proxy row1 = inp.row(r1);
-            for (index_type r2 = 0; r2 < inp.row_dim(); ++r2)
-            {
-                row_proxy row2 = inp.row(r2);
-                for (typename row_proxy::const_iterator it1 = row1.begin(); it1 != row1.end(); ++it1)
-                {
-                    index_type c1 = it1.index();
-                    for (typename row_proxy::const_iterator it2 = row2.begin(); it2 != row2.end(); ++it2) {
-                        index_type c2 = it2.index();
-
-                        assert(inp.has(r1, c1));
-                        assert(inp.has(r2, c2));
-                        
-                        typename operator_selector<Matrix, SymmGroup>::type t;
-                        gemm(inp.at(r1, c1).op(), inp.at(r2, c2).op(), t);
-                        if (t.n_blocks() > 0)
-                            ret.set(r1*inp.row_dim()+r2, c1*inp.col_dim()+c2, 
-                                        t * (inp.at(r1, c1).scale() * inp.at(r2, c2).scale()));
-                    }
-                }
-            }
-        }
-        
-        sq[p] = ret;
+        sq[p] = square_mpo_tensor(inp);
     }
     
     maquis::cout << "Done squaring." << std::endl;
@@ -130,8 +130,15 @@ void MPS<Matrix, SymmGroup>::normalize_left()
 {
     canonize(length()-1);
     // now state is: A A A A A A M
-    block_matrix<Matrix, SymmGroup> t = (*this)[length()-1].normalize_left(DefaultSolver());
-    // now state is: A A A A A A A
+    if ((*this)[length()-1].col_dim().sum_of_sizes() > 1) {
+        // an end index of dimension > 1 carries part of the state (e.g. the real and imaginary
+        // parts in real time TDVP), an isometry would lose it, so only the norm is divided out
+        (*this)[length()-1].divide_by_scalar((*this)[length()-1].scalar_norm());
+    }
+    else {
+        block_matrix<Matrix, SymmGroup> t = (*this)[length()-1].normalize_left(DefaultSolver());
+        // now state is: A A A A A A A
+    }
     canonized_i = length()-1;
 }
 
@@ -31,6 +31,7 @@
 #include "utils/traits.hpp"
 #include "dmrg/mp_tensors/mps.h"
 #include "dmrg/mp_tensors/mpo.h"
+#include "dmrg/mp_tensors/mpo_ops.h"
 #include "dmrg/mp_tensors/contractions.h"
 
 
@@ -75,6 +76,25 @@ typename Matrix::value_type expval(MPS<Matrix, SymmGroup> const & mps, MPO<Matri
     return expval(mps, mps, mpo, true);
 }
 
+/// <mps|H^2|mps> = ||H|mps>||^2, streamed through a boundary carrying two MPO layers.
+/// The squared MPO tensor exists only for the current site, so H^2 is never built.
+template<class Matrix, class SymmGroup>
+typename Matrix::value_type expval_square(MPS<Matrix, SymmGroup> const & mps, MPO<Matrix, SymmGroup> const & mpo)
+{
+    assert(mpo.length() == mps.length());
+    std::size_t L = mps.length();
+
+    Boundary<Matrix, SymmGroup> left = mps_mpo_detail::mixed_left_boundary(mps, mps);
+
+    for (int i = 0; i < L; ++i)
+    {
+        MPOTensor<Matrix, SymmGroup> w2 = square_mpo_tensor(mpo[i]);
+        left = contraction::Engine<Matrix, Matrix, SymmGroup>::overlap_mpo_left_step(mps[i], mps[i], left, w2, true);
+    }
+
+    return left.trace();
+}
+
 template<class Matrix, class SymmGroup>
 std::vector<typename MPS<Matrix, SymmGroup>::scalar_type> multi_expval(MPS<Matrix, SymmGroup> const & bra,
                                                                        MPS<Matrix, SymmGroup> const & ket,
@@ -101,6 +121,24 @@ std::vector<typename MPS<Matrix, SymmGroup>::scalar_type> multi_expval(MPS<Matri
 
 //typedef std::vector< std::vector< std::pair<std::string, double> > > entanglement_spectrum_type;
 typedef std::vector< std::pair<std::vector<std::string>, std::vector<double> > > entanglement_spectrum_type;
+
+/// n-th Renyi entropy from the squared Schmidt values sv, von Neumann for n == 1
+inline double renyi_entropy(std::vector<double> const & sv, double n)
+{
+    double S = 0;
+    if (n == 1) {
+        for (std::vector<double>::const_iterator it = sv.begin();
+             it != sv.end(); ++it)
+            S += *it * log(*it);
+        return -S;
+    } else {
+        for (std::vector<double>::const_iterator it = sv.begin();
+             it != sv.end(); ++it)
+            S += pow(*it, n);
+        return 1/(1-n)*log(S);
+    }
+}
+
 template<class Matrix, class SymmGroup>
 std::vector<double>
 calculate_bond_renyi_entropies(MPS<Matrix, SymmGroup> mps, double n,
@@ -148,18 +186,7 @@ calculate_bond_renyi_entropies(MPS<Matrix, SymmGroup> mps, double n,
             spectra->push_back(std::make_pair(labels, values));
         }
         
-        double S = 0;
-        if (n == 1) {
-            for (std::vector<double>::const_iterator it = sv.begin();
-                 it != sv.end(); ++it)
-                S += *it * log(*it);
-            ret.push_back(-S);
-        } else {
-            for (std::vector<double>::const_iterator it = sv.begin();
-                 it != sv.end(); ++it)
-                S += pow(*it, n);
-            ret.push_back(1/(1-n)*log(S));
-        }
+        ret.push_back(renyi_entropy(sv, n));
         
         mps.move_normalization_l2r(p-1, p, DefaultSolver());
     }
@@ -174,6 +201,62 @@ calculate_bond_entropies(MPS<Matrix, SymmGroup> & mps)
     return calculate_bond_renyi_entropies(mps, 1, NULL);
 }
 
+/// Schmidt values of one bond from the singular values s of a two-site split,
+/// labelled by charge and normalised to unit weight
+template<class DiagMatrix, class SymmGroup>
+std::pair<std::vector<std::string>, std::vector<double> >
+bond_spectrum(block_matrix<DiagMatrix, SymmGroup> const & s)
+{
+    std::vector<std::string> labels;
+    std::vector<double> values;
+    double norm = 0;
+    for (std::size_t k = 0; k < s.n_blocks(); ++k) {
+        std::ostringstream oss_c;
+        oss_c << s.basis().left_charge(k);
+        std::string c_str = oss_c.str();
+        for (std::size_t l = 0; l < s.basis().left_size(k); ++l) {
+            double a = std::abs(s[k](l,l));
+            labels.push_back( c_str );
+            values.push_back( a );
+            norm += a*a;
+        }
+    }
+    if (norm > 0)
+        for (std::size_t k = 0; k < values.size(); ++k)
+            values[k] /= std::sqrt(norm);
+    return std::make_pair(labels, values);
+}
+
+/// Renyi entropies from the Schmidt values recorded by the optimizer during its last sweep,
+/// one entry per bond; same output as calculate_bond_renyi_entropies without the extra pass
+inline std::vector<double>
+recorded_bond_renyi_entropies(entanglement_spectrum_type const & recorded, double n,
+                              std::vector<int> * measure_es_where = NULL,
+                              entanglement_spectrum_type * spectra = NULL)
+{
+    std::vector<double> ret;
+    if (spectra != NULL)
+        spectra->clear();
+
+    for (std::size_t b = 0; b < recorded.size(); ++b)
+    {
+        std::vector<double> sv;
+        for (std::size_t k = 0; k < recorded[b].second.size(); ++k) {
+            double a = recorded[b].second[k];
+            if (a > 1e-10)
+                sv.push_back(a*a);
+        }
+
+        int p = b + 1;
+        if (spectra != NULL && measure_es_where != NULL
+            && std::find(measure_es_where->begin(), measure_es_where->end(), p) != measure_es_where->end())
+            spectra->push_back(recorded[b]);
+
+        ret.push_back(renyi_entropy(sv, n));
+    }
+    return ret;
+}
+
 template<class Matrix, class SymmGroup>
 typename MPS<Matrix, SymmGroup>::scalar_type dm_trace(MPS<Matrix, SymmGroup> const& mps, Index<SymmGroup> const& phys_psi)
 {
@@ -42,6 +42,31 @@ enum DecompMethod {QR, SVD};
 
 static DecompMethod DefaultSolver() {return QR;} // QR or SVD
 
+namespace mpstensor_detail
+{
+    // The data of an MPSTensor in the pairing it is not currently in. It is kept
+    // after a re-pairing so that switching back is a swap, and dropped as soon as
+    // the data may change. Copies of a tensor start without it.
+    template<class Matrix, class SymmGroup>
+    struct layout_cache
+    {
+        layout_cache() : valid(false) {}
+        layout_cache(layout_cache const &) : valid(false) {}
+        layout_cache & operator=(layout_cache const &) { reset(); return *this; }
+
+        void reset()
+        {
+            if (valid) {
+                data = block_matrix<Matrix, SymmGroup>();
+                valid = false;
+            }
+        }
+
+        block_matrix<Matrix, SymmGroup> data;
+        bool valid;
+    };
+}
+
 template<class Matrix, class SymmGroup>
 class MPSTensor : public storage::gpu::multiDeviceSerializable<MPSTensor<Matrix, SymmGroup>>
 {
@@ -139,6 +164,8 @@ public:
     
     void make_left_paired() const;
     void make_right_paired() const;
+    // frees the kept copy in the other pairing, for tensors the sweep has moved past
+    void drop_other_layout() const;
     
     void clear();
     void conjugate_inplace();
@@ -161,6 +188,7 @@ public:
     Index<SymmGroup> phys_i, left_i, right_i;
 private:
     mutable block_matrix<Matrix, SymmGroup> data_;
+    mutable mpstensor_detail::layout_cache<Matrix, SymmGroup> other_layout;
     mutable MPSStorageLayout cur_storage;
     Indicator cur_normalization;
 };
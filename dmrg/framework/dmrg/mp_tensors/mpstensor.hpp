@@ -213,11 +213,17 @@ void MPSTensor<Matrix, SymmGroup>::make_left_paired() const
     if (cur_storage == LeftPaired)
         return;
     
-    block_matrix<Matrix, SymmGroup> tmp;
-    reshape_right_to_left_new<Matrix>(phys_i, left_i, right_i,
-                                      data(), tmp);
+    if (other_layout.valid)
+        swap(data_, other_layout.data);
+    else {
+        block_matrix<Matrix, SymmGroup> tmp;
+        reshape_right_to_left_new<Matrix>(phys_i, left_i, right_i,
+                                          data(), tmp);
+        swap(data_, tmp);
+        swap(other_layout.data, tmp);
+        other_layout.valid = true;
+    }
     cur_storage = LeftPaired;
-    swap(data_, tmp);
     
     assert( weak_equal(right_i, data().right_basis()) );
 }
@@ -228,11 +234,17 @@ void MPSTensor<Matrix, SymmGroup>::make_right_paired() const
     if (cur_storage == RightPaired)
         return;
     
-    block_matrix<Matrix, SymmGroup> tmp;
-    reshape_left_to_right_new<Matrix>(phys_i, left_i, right_i,
-                                      data(), tmp);
+    if (other_layout.valid)
+        swap(data_, other_layout.data);
+    else {
+        block_matrix<Matrix, SymmGroup> tmp;
+        reshape_left_to_right_new<Matrix>(phys_i, left_i, right_i,
+                                          data(), tmp);
+        swap(data_, tmp);
+        swap(other_layout.data, tmp);
+        other_layout.valid = true;
+    }
     cur_storage = RightPaired;
-    swap(data_, tmp);
     
     assert( weak_equal(left_i, data().left_basis()) );
 }
@@ -473,11 +485,18 @@ bool MPSTensor<Matrix, SymmGroup>::is_right_paired() const
     return cur_storage == RightPaired;
 }
 
+template<class Matrix, class SymmGroup>
+void MPSTensor<Matrix, SymmGroup>::drop_other_layout() const
+{
+    other_layout.reset();
+}
+
 template<class Matrix, class SymmGroup>
 block_matrix<Matrix, SymmGroup> &
 MPSTensor<Matrix, SymmGroup>::data()
 {
     cur_normalization = Unorm;
+    other_layout.reset();
     return data_;
 }
 
@@ -582,6 +601,8 @@ void MPSTensor<Matrix, SymmGroup>::swap_with(MPSTensor<Matrix, SymmGroup> & b)
     swap(this->left_i, b.left_i);
     swap(this->right_i, b.right_i);
     swap(this->data_, b.data_);
+    swap(this->other_layout.data, b.other_layout.data);
+    swap(this->other_layout.valid, b.other_layout.valid);
     swap(this->cur_storage, b.cur_storage);
     swap(this->cur_normalization, b.cur_normalization);
 }
@@ -590,6 +611,7 @@ template<class Matrix, class SymmGroup>
 template<class Archive>
 void MPSTensor<Matrix, SymmGroup>::load(Archive & ar)
 {
+    other_layout.reset();
     data_.clear();
     make_left_paired();
     ar["phys_i"] >> phys_i;
@@ -603,17 +625,22 @@ template<class Matrix, class SymmGroup>
 template<class Archive>
 void MPSTensor<Matrix, SymmGroup>::save(Archive & ar) const
 {
+    // a re-pairing only for writing must not leave a second copy behind
+    bool kept = other_layout.valid;
     make_left_paired();
     ar["phys_i"] << phys_i;
     ar["left_i"] << left_i;
     ar["right_i"] << right_i;
     ar["data_"] << data();
+    if (!kept)
+        other_layout.reset();
 }
 
 template<class Matrix, class SymmGroup>
 template<class Archive>
 void MPSTensor<Matrix, SymmGroup>::serialize(Archive & ar, const unsigned int version)
 {
+    other_layout.reset();
     ar & phys_i & left_i & right_i & cur_storage & cur_normalization & data_;
 }
 
@@ -78,10 +78,12 @@ public:
     MPSTensor<Matrix, SymmGroup> make_mps() const;
     
     boost::tuple<MPSTensor<Matrix, SymmGroup>, MPSTensor<Matrix, SymmGroup>, truncation_results>
-    split_mps_l2r(std::size_t Mmax, double cutoff) const;
+    split_mps_l2r(std::size_t Mmax, double cutoff,
+                  block_matrix<typename alps::numeric::associated_real_diagonal_matrix<Matrix>::type, SymmGroup> * s_out = NULL) const;
     
     boost::tuple<MPSTensor<Matrix, SymmGroup>, MPSTensor<Matrix, SymmGroup>, truncation_results>
-    split_mps_r2l(std::size_t Mmax, double cutoff) const;
+    split_mps_r2l(std::size_t Mmax, double cutoff,
+                  block_matrix<typename alps::numeric::associated_real_diagonal_matrix<Matrix>::type, SymmGroup> * s_out = NULL) const;
     
     void clear();
     void swap_with(TwoSiteTensor & b);
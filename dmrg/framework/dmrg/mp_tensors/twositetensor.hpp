@@ -152,7 +152,8 @@ MPSTensor<Matrix, SymmGroup> TwoSiteTensor<Matrix, SymmGroup>::make_mps_(type_he
 
 template<class Matrix, class SymmGroup>
 boost::tuple<MPSTensor<Matrix, SymmGroup>, MPSTensor<Matrix, SymmGroup>, truncation_results>
-TwoSiteTensor<Matrix, SymmGroup>::split_mps_l2r(std::size_t Mmax, double cutoff) const
+TwoSiteTensor<Matrix, SymmGroup>::split_mps_l2r(std::size_t Mmax, double cutoff,
+                                                block_matrix<typename alps::numeric::associated_real_diagonal_matrix<Matrix>::type, SymmGroup> * s_out) const
 {
     make_both_paired();
     
@@ -161,6 +162,8 @@ TwoSiteTensor<Matrix, SymmGroup>::split_mps_l2r(std::size_t Mmax, double cutoff)
     block_matrix<dmt, SymmGroup> s;
     
     truncation_results trunc = svd_truncate(data_, u, v, s, cutoff, Mmax, true);
+    if (s_out != NULL)
+        *s_out = s;
 
     for (size_t block = 0; block < u.n_blocks(); ++block)
         u[block].shrink_to_fit();
@@ -176,7 +179,8 @@ TwoSiteTensor<Matrix, SymmGroup>::split_mps_l2r(std::size_t Mmax, double cutoff)
 
 template<class Matrix, class SymmGroup>
 boost::tuple<MPSTensor<Matrix, SymmGroup>, MPSTensor<Matrix, SymmGroup>, truncation_results>
-TwoSiteTensor<Matrix, SymmGroup>::split_mps_r2l(std::size_t Mmax, double cutoff) const
+TwoSiteTensor<Matrix, SymmGroup>::split_mps_r2l(std::size_t Mmax, double cutoff,
+                                                block_matrix<typename alps::numeric::associated_real_diagonal_matrix<Matrix>::type, SymmGroup> * s_out) const
 {
     typedef typename SymmGroup::charge charge;
 
@@ -187,6 +191,8 @@ TwoSiteTensor<Matrix, SymmGroup>::split_mps_r2l(std::size_t Mmax, double cutoff)
     block_matrix<dmt, SymmGroup> s;
     
     truncation_results trunc = svd_truncate(data_, u, v, s, cutoff, Mmax, true);
+    if (s_out != NULL)
+        *s_out = s;
     
     for (size_t block = 0; block < v.n_blocks(); ++block)
         v[block].shrink_to_fit();
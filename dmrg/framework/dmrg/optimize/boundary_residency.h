@@ -0,0 +1,267 @@
+/*****************************************************************************
+ *
+ * ALPS MPS DMRG Project
+ *
+ * Copyright (C) 2014 Institute for Theoretical Physics, ETH Zurich
+ *
+ * This software is part of the ALPS Applications, published under the ALPS
+ * Application License; you can use, redistribute it and/or modify it under
+ * the terms of the license, either version 1 or (at your option) any later
+ * version.
+ *
+ * You should have received a copy of the ALPS Application License along with
+ * the ALPS Applications; see the file LICENSE.txt. If not, the license is also
+ * available from http://alps.comp-phys.org/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef BOUNDARY_RESIDENCY_H
+#define BOUNDARY_RESIDENCY_H
+
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include "dmrg/utils/storage.h"
+
+/// Decides which boundaries stay in memory when temporary storage is enabled.
+///
+/// The optimizer reports the boundaries of each step through fetch/prefetch/pin and the ones it
+/// is done with through release. With a zero budget (or without "storagedir") every call goes
+/// straight to Transfer, i.e. a released boundary is evicted at once. Otherwise released
+/// boundaries stay resident until the budget is exceeded; then the one needed again farthest
+/// along the sweep is written out first, the least recently used one among equals. Prefetches
+/// reach further ahead when a boundary takes longer to load than a step takes to compute.
+template <class Transfer, class BoundaryType>
+class boundary_residency
+{
+    typedef std::chrono::high_resolution_clock clock;
+
+    struct entry {
+        entry() : resident(false), in_flight(false), bytes(0), used(0) {}
+        bool resident, in_flight;
+        std::size_t bytes, used;
+        clock::time_point requested;
+    };
+
+public:
+    enum side_t { left_side, right_side };
+
+    static const int max_lookahead = 4;
+
+    /// width: number of sites optimized per step, left[step] and right[step+width] are used
+    boundary_residency(std::vector<BoundaryType> & left, std::vector<BoundaryType> & right,
+                       double budget_mb, int width)
+    : left_(left), right_(right)
+    , budget_(std::size_t(budget_mb * 1024 * 1024)), width_(width)
+    , front_(0), lr_(1), clock_(0), resident_bytes_(0), written_bytes_(0)
+    , bandwidth_(0), step_time_(0)
+    { }
+
+    bool active() const { return budget_ > 0 && storage::disk::enabled(); }
+
+    /// the sweep is now at step, moving in direction lr
+    void move_to(int step, int lr)
+    {
+        clock::time_point now = clock::now();
+        if (clock_ > 0) {
+            double t = std::chrono::duration<double>(now - last_move_).count();
+            step_time_ = (step_time_ > 0) ? 0.5 * (step_time_ + t) : t;
+        }
+        last_move_ = now;
+        front_ = step;
+        lr_ = lr;
+        ++clock_;
+    }
+
+    void fetch(side_t s, int i)
+    {
+        entry & e = state(s, i);
+        clock::time_point t0 = clock::now();
+        Transfer::fetch(boundary(s, i));
+
+        if (active()) {
+            clock::time_point t1 = clock::now();
+            std::size_t bytes = size_of(boundary(s, i));
+            // a wait means the transfer has only just finished, so it measures the bandwidth
+            if (std::chrono::duration<double>(t1 - t0).count() > 1e-3)
+                record_bandwidth(bytes, std::chrono::duration<double>(t1 - (e.in_flight ? e.requested : t0)).count());
+            make_resident(e, bytes);
+            e.in_flight = false;
+            enforce();
+        }
+    }
+
+    void prefetch(side_t s, int i)
+    {
+        request(s, i);
+        if (!active())
+            return;
+
+        // only boundaries ahead of the sweep front are worth loading early
+        int dir = (s == right_side) ? +1 : -1;
+        if (dir != lr_)
+            return;
+
+        std::vector<BoundaryType> & b = (s == left_side) ? left_ : right_;
+        int depth = lookahead(size_of(boundary(s, i)));
+        for (int k = 1; k < depth; ++k) {
+            int j = i + dir * k;
+            if (j < 0 || j >= int(b.size()))
+                break;
+            if (state(s, j).resident)
+                continue;
+            if (resident_bytes_ + size_of(b[j]) > budget_)
+                break;
+            request(s, j);
+        }
+    }
+
+    /// waits for a pending write, unless the boundary was kept in memory
+    void pin(side_t s, int i)
+    {
+        if (!active() || !state(s, i).resident)
+            Transfer::pin(boundary(s, i));
+    }
+
+    /// the current step is done with the boundary
+    void release(side_t s, int i)
+    {
+        if (!active()) {
+            Transfer::evict(boundary(s, i));
+            return;
+        }
+
+        entry & e = state(s, i);
+        make_resident(e, size_of(boundary(s, i)));
+        enforce();
+    }
+
+    void drop(side_t s, int i)
+    {
+        Transfer::drop(boundary(s, i));
+        entry & e = state(s, i);
+        if (e.resident) resident_bytes_ -= e.bytes;
+        e = entry();
+    }
+
+    void print_summary() const
+    {
+        if (!active()) return;
+        maquis::cout << "Boundary residency: " << resident_bytes_ / 1024 / 1024 << " MB resident of "
+                     << budget_ / 1024 / 1024 << " MB, " << written_bytes_ / 1024 / 1024 << " MB written, "
+                     << bandwidth_ / 1024 / 1024 << " MB/s" << std::endl;
+    }
+
+private:
+    BoundaryType & boundary(side_t s, int i) { return (s == left_side) ? left_[i] : right_[i]; }
+
+    entry & state(side_t s, int i)
+    {
+        std::vector<entry> & st = (s == left_side) ? left_state_ : right_state_;
+        if (st.size() < left_.size()) st.resize(left_.size());
+        return st[i];
+    }
+
+    void request(side_t s, int i)
+    {
+        Transfer::prefetch(boundary(s, i));
+        if (!active()) return;
+
+        entry & e = state(s, i);
+        if (!e.resident) {
+            e.in_flight = true;
+            e.requested = clock::now();
+        }
+        make_resident(e, size_of(boundary(s, i)));
+    }
+
+    void make_resident(entry & e, std::size_t bytes)
+    {
+        if (e.resident) resident_bytes_ -= e.bytes;
+        e.resident = true;
+        e.bytes = bytes;
+        e.used = clock_;
+        resident_bytes_ += bytes;
+    }
+
+    // steps until the boundary is used again, following the sweep through the turn
+    int distance(side_t s, int i) const
+    {
+        int step = (s == left_side) ? i : i - width_;
+        int last = int(left_.size()) - 1 - width_;
+        if (lr_ > 0)
+            return (step >= front_) ? step - front_ : (last - front_) + (last - step);
+        else
+            return (step <= front_) ? front_ - step : front_ + step;
+    }
+
+    bool in_use(side_t s, int i) const
+    {
+        return (s == left_side) ? (i == front_) : (i == front_ + width_);
+    }
+
+    void enforce()
+    {
+        while (resident_bytes_ > budget_) {
+            side_t victim_side = left_side;
+            int victim = -1, victim_dist = -1;
+            std::size_t victim_used = 0;
+            for (int side = left_side; side <= right_side; ++side) {
+                side_t s = side_t(side);
+                std::vector<entry> const & st = (s == left_side) ? left_state_ : right_state_;
+                for (int i = 0; i < int(st.size()); ++i) {
+                    if (!st[i].resident || st[i].in_flight || in_use(s, i))
+                        continue;
+                    int dist = distance(s, i);
+                    if (dist > victim_dist || (dist == victim_dist && st[i].used < victim_used)) {
+                        victim_side = s; victim = i; victim_dist = dist; victim_used = st[i].used;
+                    }
+                }
+            }
+            if (victim < 0)
+                break;
+
+            entry & e = state(victim_side, victim);
+            Transfer::evict(boundary(victim_side, victim));
+            resident_bytes_ -= e.bytes;
+            written_bytes_ += e.bytes;
+            e.resident = false;
+        }
+    }
+
+    void record_bandwidth(std::size_t bytes, double seconds)
+    {
+        if (seconds <= 0 || bytes == 0) return;
+        double bw = bytes / seconds;
+        bandwidth_ = (bandwidth_ > 0) ? 0.5 * (bandwidth_ + bw) : bw;
+    }
+
+    int lookahead(std::size_t bytes) const
+    {
+        if (bandwidth_ <= 0 || step_time_ <= 0)
+            return 1;
+        return std::min(max_lookahead, 1 + int(bytes / bandwidth_ / step_time_));
+    }
+
+    std::vector<BoundaryType> & left_, & right_;
+    std::vector<entry> left_state_, right_state_;
+
+    std::size_t budget_;
+    int width_, front_, lr_;
+    std::size_t clock_, resident_bytes_, written_bytes_;
+    double bandwidth_, step_time_;
+    clock::time_point last_move_;
+};
+
+template <class Transfer, class BoundaryType> const int boundary_residency<Transfer, BoundaryType>::max_lookahead;
+
+#endif
@@ -30,6 +30,7 @@
 
 #include <chrono>
 #include <tuple>
+#include <cmath>
 
 #if not defined(WIN32) && not defined(WIN64)
 #include <sys/time.h>
@@ -42,6 +43,7 @@
 #include "utils/sizeof.h"
 
 #include "dmrg/optimize/solver_interface.hpp"
+#include "dmrg/mp_tensors/mps_mpo_ops.h"
 
 #include "dmrg/utils/BaseParameters.h"
 #include "dmrg/utils/results_collector.h"
@@ -49,6 +51,10 @@
 #include "dmrg/utils/time_limit_exception.h"
 #include "dmrg/utils/checks.h"
 #include "dmrg/utils/aligned_allocator.hpp"
+#include "dmrg/utils/tracing.h"
+#include "dmrg/utils/memory_tracking.h"
+#include "dmrg/utils/parallel/utils.hpp"
+#include "dmrg/optimize/boundary_residency.h"
 
 #define BEGIN_TIMING(name) \
 now = std::chrono::high_resolution_clock::now();
@@ -89,8 +95,17 @@ public:
     , parms(parms_)
     , stop_callback(stop_callback_)
     , cpu_gpu_ratio(mps.length(), 0.9)
+    , bond_spectra_(parms_["sweep_entropies"] ? mps.length()-1 : 0)
+    , track_memory_(parms_["track_memory"])
+    , predict_memory_(parms_["predict_memory"])
+    , sweep_memory_peak_(memtrack::n_tags, 0)
+    , sweep_bond_dimension_(0)
     {
         std::size_t L = mps.length();
+
+        // counting is switched on by the simulation setup, before the first tracked allocation
+        if ((track_memory_ || predict_memory_) && !memtrack::enabled())
+            throw std::runtime_error("track_memory and predict_memory need memtrack::enable() before any tracked allocation");
         
         mps.canonize(site);
         for(int i = 0; i < mps.length(); ++i)
@@ -119,6 +134,8 @@ public:
             northo++;
         }
         
+        mpo_usage.reset(memtrack::mpo, size_of(mpo));
+
         init_left_right(mpo, site);
         maquis::cout << "Done init_left_right" << std::endl << std::endl;
     }
@@ -129,30 +146,59 @@ public:
     
     results_collector const& iteration_results() const { return iteration_results_; }
 
+    /// Schmidt values of each bond after its last update in the current half sweep, if
+    /// "sweep_entropies" is set; an entry stays empty until the optimizer has split by SVD
+    entanglement_spectrum_type const& bond_spectra() const { return bond_spectra_; }
+
+    /// <mps|mpo|mps> from the boundaries of the last sweep, which ends at site 0 with right_[1]
+    /// matching the final state, so no extra pass over the lattice is needed
+    typename Matrix::value_type boundary_expval()
+    {
+        Storage::sync();
+        Storage::fetch(left_[0]);
+        Storage::fetch(right_[1]);
+        return site_expval(mps[0], left_[0], right_[1], mpo[0]);
+    }
+
 protected:
 
+    // the master's tensors of the sites [first, last) replace those of the other ranks, so that
+    // truncation ties or a different reduction order cannot let the replicated MPS drift apart
+    void broadcast_sites(int first, int last)
+    {
+        if (parallel::size() == 1) return;
+        for (int p = std::max(first, 0); p < std::min<int>(last, mps.length()); ++p)
+            parallel::broadcast(mps[p]);
+    }
+
     inline void boundary_left_step(MPO<Matrix, SymmGroup> const & mpo, int site)
     {
         std::chrono::high_resolution_clock::time_point now, then;
 
+        tracing::span trace("boundary_left_step", "boundary_step");
         BEGIN_TIMING("LSTEP")
         left_[site+1] = contr::overlap_mpo_left_step(mps[site], mps[site], left_[site], mpo[site], true);
         END_TIMING("LSTEP")
+        trace.counter("bytes", size_of(left_[site]) + size_of(left_[site+1]));
         
         for (int n = 0; n < northo; ++n)
             ortho_left_[n][site+1] = mps_detail::overlap_left_step(mps[site], ortho_mps[n][site], ortho_left_[n][site]);
+        mps[site].drop_other_layout(); // the sweep front has moved past site
     }
     
     inline void boundary_right_step(MPO<Matrix, SymmGroup> const & mpo, int site)
     {
         std::chrono::high_resolution_clock::time_point now, then;
 
+        tracing::span trace("boundary_right_step", "boundary_step");
         BEGIN_TIMING("RSTEP")
         right_[site] = contr::overlap_mpo_right_step(mps[site], mps[site], right_[site+1], mpo[site]);
         END_TIMING("RSTEP")
+        trace.counter("bytes", size_of(right_[site]) + size_of(right_[site+1]));
         
         for (int n = 0; n < northo; ++n)
             ortho_right_[n][site] = mps_detail::overlap_right_step(mps[site], ortho_mps[n][site], ortho_right_[n][site+1]);
+        mps[site].drop_other_layout();
     }
 
     void init_left_right(MPO<Matrix, SymmGroup> const & mpo, int site)
@@ -194,6 +240,71 @@ protected:
         maquis::cout << "Boundaries are fully initialized...\n";
     }
 
+    // time, span count and counter totals of each traced phase during this sweep,
+    // stored as Trace/<phase>/Seconds, Trace/<phase>/Calls and Trace/<phase>/<counter>
+    void record_trace_summary(int sweep)
+    {
+        if (!tracing::enabled()) return;
+
+        std::map<std::string, tracing::phase_summary> phases = tracing::summary(sweep);
+        for (auto const & phase : phases) {
+            std::string prefix = "Trace/" + phase.first + "/";
+            iteration_results_[prefix + "Seconds"] << phase.second.seconds;
+            iteration_results_[prefix + "Calls"]   << phase.second.calls;
+            for (auto const & c : phase.second.counters)
+                iteration_results_[prefix + c.first] << c.second;
+        }
+    }
+
+    // current and peak bytes of each memtrack subsystem at this site, stored as
+    // Memory/<subsystem>/Current and Memory/<subsystem>/Peak; the peaks are process-wide
+    // maxima since the previous site, not the usage of this site alone
+    void record_memory(std::size_t bond_dimension)
+    {
+        if (!track_memory_ && !predict_memory_) return;
+
+        sweep_bond_dimension_ = std::max(sweep_bond_dimension_, bond_dimension);
+        for (int t = 0; t < memtrack::n_tags; ++t) {
+            memtrack::tag tag = memtrack::tag(t);
+            sweep_memory_peak_[t] = std::max(sweep_memory_peak_[t], memtrack::peak(tag));
+            if (track_memory_) {
+                std::string prefix = std::string("Memory/") + memtrack::name(tag) + "/";
+                iteration_results_[prefix + "Current"] << memtrack::current(tag);
+                iteration_results_[prefix + "Peak"]    << memtrack::peak(tag);
+            }
+        }
+        memtrack::reset_peaks();
+    }
+
+    // peak of each subsystem during this sweep and the estimate for the next one, which scales
+    // the peak by (M_next / M)^bond_exponent with M the largest bond dimension of this sweep
+    // and M_next the planned one; estimates are stored as Memory/<subsystem>/PredictedPeak
+    void report_memory(int sweep)
+    {
+        if (predict_memory_) {
+            std::size_t Mnext = get_Mmax(sweep+1);
+            double ratio = (sweep_bond_dimension_ > 0) ? double(Mnext) / sweep_bond_dimension_ : 1.;
+            double total = 0, total_next = 0;
+
+            maquis::cout << "Peak memory (MB) in sweep " << sweep << " with M = " << sweep_bond_dimension_
+                         << ", estimate for sweep " << sweep+1 << " with M = " << Mnext << std::endl;
+            for (int t = 0; t < memtrack::n_tags; ++t) {
+                memtrack::tag tag = memtrack::tag(t);
+                double peak = sweep_memory_peak_[t] / 1024. / 1024.;
+                double next = peak * std::pow(ratio, memtrack::bond_exponent(tag));
+                total += peak;
+                total_next += next;
+                maquis::cout << "    " << memtrack::name(tag) << ": " << peak << " -> " << next << std::endl;
+                iteration_results_[std::string("Memory/") + memtrack::name(tag) + "/PredictedPeak"]
+                    << std::size_t(next * 1024 * 1024);
+            }
+            maquis::cout << "    total (sum of peaks): " << total << " -> " << total_next << std::endl;
+        }
+
+        std::fill(sweep_memory_peak_.begin(), sweep_memory_peak_.end(), 0);
+        sweep_bond_dimension_ = 0;
+    }
+
     void print_boundary_stats()
     {
         for (int i = 0; i < left_.size(); ++i)
@@ -252,6 +363,14 @@ protected:
 
     // performance tuning
     std::vector<double> cpu_gpu_ratio;
+
+    entanglement_spectrum_type bond_spectra_;
+
+    // memory accounting, see record_memory and report_memory
+    bool track_memory_, predict_memory_;
+    std::vector<std::size_t> sweep_memory_peak_;
+    std::size_t sweep_bond_dimension_;
+    memtrack::scoped_usage mpo_usage;
 };
 
 #include "ss_optimize.hpp"
@@ -39,6 +39,9 @@ solve_site_problem(MPSTensor<Matrix, SymmGroup> & ket,
 {
     typedef typename Matrix::value_type value_type;
 
+    // copies ket: its blocks are separate matrices, the solver works on one padded buffer,
+    // and the result is copied back block by block into ret
+    // copies ket, see solve_site_problem
     ket.make_right_paired();
     DavidsonVector<value_type> initial(ket.data().data_view(), ket.data().basis().sizes());
 
@@ -47,7 +50,8 @@ solve_site_problem(MPSTensor<Matrix, SymmGroup> & ket,
 
     SuperHamil<value_type> SH(make_bview(left), make_bview(right), eff_matrix);
 
-    MPSTensor<Matrix, SymmGroup> ret = ket;
+    // the solver overwrites every block, so only the block structure of ket is needed here
+    MPSTensor<Matrix, SymmGroup> ret(ket.site_dim(), ket.row_dim(), ket.col_dim(), ket.data().basis(), RightPaired);
     std::vector<value_type*> ret_data = ret.data().data_view_nc();
 
     std::vector<DavidsonVector<value_type>> ortho_vecs_dv(ortho_vecs.size());
@@ -76,4 +80,71 @@ solve_site_problem(MPSTensor<Matrix, SymmGroup> & ket,
     return std::make_tuple(eval, ret, eff_matrix.get_cpu_gpu_ratio());
 }
 
+// exp(-tau H_eff) ket, normalized, for the site Hamiltonian spanned by left, mpo and right;
+// returns <ket| H_eff |ket>, the evolved tensor and the updated cpu/gpu work split.
+// In real time H_eff is antisymmetric, the realified -iH, and ket becomes exp(tau H_eff) ket.
+template <class Matrix, class OtherMatrix, class SymmGroup>
+std::tuple<double, MPSTensor<Matrix, SymmGroup>, double>
+evolve_site_problem(MPSTensor<Matrix, SymmGroup> & ket,
+                    Boundary<OtherMatrix, SymmGroup> const& left,
+                    Boundary<OtherMatrix, SymmGroup> const& right,
+                    MPOTensor<Matrix, SymmGroup> const& mpo,
+                    double tau,
+                    bool real_time,
+                    BaseParameters & parms,
+                    double cpu_gpu_ratio)
+{
+    typedef typename Matrix::value_type value_type;
+
+    ket.make_right_paired();
+    DavidsonVector<value_type> initial(ket.data().data_view(), ket.data().basis().sizes());
+
+    contraction::common::ScheduleNew<typename Matrix::value_type> eff_matrix =
+        contraction::common::create_contraction_schedule(ket, left, right, mpo, cpu_gpu_ratio);
+
+    SuperHamil<value_type> SH(make_bview(left), make_bview(right), eff_matrix);
+
+    MPSTensor<Matrix, SymmGroup> ret(ket.site_dim(), ket.row_dim(), ket.col_dim(), ket.data().basis(), RightPaired);
+    std::vector<value_type*> ret_data = ret.data().data_view_nc();
+
+    double tol = parms["tdvp_krylov_tol"];
+    int max_krylov = parms["tdvp_krylov_maxiter"];
+
+    auto now = std::chrono::high_resolution_clock::now();
+    double eval = evolve<value_type>(ret_data, initial, SH, tau, real_time, tol, max_krylov);
+    auto then = std::chrono::high_resolution_clock::now();
+
+    double expm_time = std::chrono::duration<double>(then-now).count();
+    std::cout << "Time elapsed in Lanczos exponential: " << expm_time << std::endl;
+    eff_matrix.print_stats(expm_time);
+
+    eff_matrix.mps_stage.deallocate();
+    return std::make_tuple(eval, ret, eff_matrix.get_cpu_gpu_ratio());
+}
+
+// <ket| H_eff |ket> for the site Hamiltonian spanned by left, mpo and right,
+// i.e. the full expectation value if left and right are the environments of ket
+template <class Matrix, class OtherMatrix, class SymmGroup>
+typename Matrix::value_type
+site_expval(MPSTensor<Matrix, SymmGroup> & ket,
+            Boundary<OtherMatrix, SymmGroup> const& left,
+            Boundary<OtherMatrix, SymmGroup> const& right,
+            MPOTensor<Matrix, SymmGroup> const& mpo)
+{
+    typedef typename Matrix::value_type value_type;
+
+    // copies ket, see solve_site_problem
+    ket.make_right_paired();
+    DavidsonVector<value_type> vec(ket.data().data_view(), ket.data().basis().sizes());
+
+    contraction::common::ScheduleNew<value_type> eff_matrix =
+        contraction::common::create_contraction_schedule(ket, left, right, mpo, 0.9);
+
+    SuperHamil<value_type> SH(make_bview(left), make_bview(right), eff_matrix);
+    DavidsonVector<value_type> hvec = site_hamil_mv(vec, SH);
+
+    eff_matrix.mps_stage.deallocate();
+    return vec.scalar_overlap(hvec);
+}
+
 #endif
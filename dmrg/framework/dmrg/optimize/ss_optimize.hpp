@@ -35,6 +35,7 @@ public:
     typedef optimizer_base<Matrix, SymmGroup, Storage> base;
     typedef typename base::BoundaryMatrix BoundaryMatrix;
     typedef typename base::contr contr;
+    typedef boundary_residency<Storage, Boundary<BoundaryMatrix, SymmGroup> > residency_t;
     using base::mpo;
     using base::mps;
     using base::left_;
@@ -52,6 +53,7 @@ public:
                 int initial_site_ = 0)
     : base(mps_, mpo_, omps_ptr, parms_, stop_callback_, to_site(mps_.length(), initial_site_))
     , initial_site((initial_site_ < 0) ? 0 : initial_site_)
+    , residency(left_, right_, parms_.template get<double>("storage_memory_budget"), 1)
     { }
     
     inline int to_site(const int L, const int i) const
@@ -89,12 +91,17 @@ public:
             }
         
             maquis::cout << "Sweep " << sweep << ", optimizing site " << site << std::endl;
+            tracing::set_context(sweep, site);
+            residency.move_to(site, lr);
             
-            Storage::fetch(left_[site]);
-            Storage::fetch(right_[site+1]);
+            {
+                tracing::span trace("fetch_boundaries", "io_wait");
+                residency.fetch(residency_t::left_side, site);
+                residency.fetch(residency_t::right_side, site+1);
+            }
             
-            if (lr == +1 && site+2 <= L) Storage::prefetch(right_[site+2]);
-            if (lr == -1 && site > 0)    Storage::prefetch(left_[site-1]);
+            if (lr == +1 && site+2 <= L) residency.prefetch(residency_t::right_side, site+2);
+            if (lr == -1 && site > 0)    residency.prefetch(residency_t::left_side, site-1);
             
             std::chrono::high_resolution_clock::time_point now, then;
 
@@ -120,6 +127,7 @@ public:
                 } else if (parms["eigensolver"] == std::string("IETL_JCD")) {
                     //BEGIN_TIMING("JCD")
                     //res = solve_ietl_jcd(sp, mps[site], parms, ortho_vecs);
+                    tracing::span trace("solve_site_problem", "eigensolver");
                     res = solve_site_problem(mps[site], left_[site], right_[site+1], mpo[site], ortho_vecs, parms, 0.9);
                     //END_TIMING("JCD")
                 } else {
@@ -157,42 +165,63 @@ public:
             double cutoff = this->get_cutoff(sweep);
             std::size_t Mmax = this->get_Mmax(sweep);
             truncation_results trunc;
+
+            // controlled bond expansion replaces the alpha perturbation
+            bool expand = (parms["singlesite_expansion"] == std::string("cbe"));
+            std::size_t Mexp = std::ceil(parms.template get<double>("cbe_fraction") * Mmax);
             
             if (lr == +1) {
-                if (site < L-1) {
+                if (site < L-1 && expand) {
+                    maquis::cout << "Expanding, up to " << Mexp << " states" << std::endl;
+                    tracing::span trace("expand_l2r_sweep", "truncation");
+                    trunc = contr::expand_l2r_sweep(mps, mpo[site], left_[site], site, cutoff, Mmax, Mexp);
+                    trace.counter("bond_dimension", trunc.bond_dimension);
+                } else if (site < L-1) {
                     maquis::cout << "Growing, alpha = " << alpha << std::endl;
+                    tracing::span trace("grow_l2r_sweep", "truncation");
                     trunc = contr::grow_l2r_sweep(mps, mpo[site], left_[site], right_[site+1], site, alpha, cutoff, Mmax);
+                    trace.counter("bond_dimension", trunc.bond_dimension);
                 } else {
                     block_matrix<Matrix, SymmGroup> t = mps[site].normalize_left(DefaultSolver());
                     if (site < L-1)
                         mps[site+1].multiply_from_left(t);
                 }
                 
+                this->broadcast_sites(site, site+2);
                 this->boundary_left_step(mpo, site); // creating left_[site+1]
                 if (site != L-1) {
-                    Storage::drop(right_[site+1]);
-                    Storage::evict(left_[site]);
+                    residency.drop(residency_t::right_side, site+1);
+                    residency.release(residency_t::left_side, site);
                 }
             } else if (lr == -1) {
-                if (site > 0) {
+                if (site > 0 && expand) {
+                    maquis::cout << "Expanding, up to " << Mexp << " states" << std::endl;
+                    tracing::span trace("expand_r2l_sweep", "truncation");
+                    trunc = contr::expand_r2l_sweep(mps, mpo[site], right_[site+1], site, cutoff, Mmax, Mexp);
+                    trace.counter("bond_dimension", trunc.bond_dimension);
+                } else if (site > 0) {
                     maquis::cout << "Growing, alpha = " << alpha << std::endl;
+                    tracing::span trace("grow_r2l_sweep", "truncation");
                     trunc = contr::grow_r2l_sweep(mps, mpo[site], left_[site], right_[site+1], site, alpha, cutoff, Mmax);
+                    trace.counter("bond_dimension", trunc.bond_dimension);
                 } else {
                     block_matrix<Matrix, SymmGroup> t = mps[site].normalize_right(DefaultSolver());
                     if (site > 0)
                         mps[site-1].multiply_from_right(t);
                 }
                 
+                this->broadcast_sites(site-1, site+1);
                 this->boundary_right_step(mpo, site); // creating right_[site]
                 if (site > 0) {
-                    Storage::drop(left_[site]);
-                    Storage::evict(right_[site+1]);
+                    residency.drop(residency_t::left_side, site);
+                    residency.release(residency_t::right_side, site+1);
                 }
             }
 
             iteration_results_["BondDimension"]   << trunc.bond_dimension;
             iteration_results_["TruncatedWeight"] << trunc.truncated_weight;
             iteration_results_["SmallestEV"]      << trunc.smallest_ev;
+            this->record_memory(trunc.bond_dimension);
             
             std::chrono::high_resolution_clock::time_point sweep_then = std::chrono::high_resolution_clock::now();
             double elapsed = std::chrono::duration<double>(sweep_then - sweep_now).count();
@@ -202,10 +231,14 @@ public:
                 throw dmrg::time_limit(sweep, _site+1);
         }
         initial_site = -1;
+        residency.print_summary();
+        this->record_trace_summary(sweep);
+        this->report_memory(sweep);
     }
     
 private:
     int initial_site;
+    residency_t residency;
 };
 
 #endif
@@ -38,6 +38,7 @@ public:
 
     typedef optimizer_base<Matrix, SymmGroup, Storage> base;
     typedef typename base::BoundaryMatrix BoundaryMatrix;
+    typedef boundary_residency<typename Storage::broadcast, Boundary<BoundaryMatrix, SymmGroup> > residency_t;
     using base::mpo;
     using base::mps;
     using base::left_;
@@ -55,8 +56,10 @@ public:
                 int initial_site_ = 0)
     : base(mps_, mpo_, omps_ptr, parms_, stop_callback_, to_site(mps_.length(), initial_site_))
     , initial_site((initial_site_ < 0) ? 0 : initial_site_)
+    , residency(left_, right_, parms_.template get<double>("storage_memory_budget"), 2)
     {
         make_ts_cache_mpo(mpo, ts_cache_mpo, mps);
+        ts_mpo_usage.reset(memtrack::mpo, size_of(ts_cache_mpo));
 
         // temporarily deactivated until SparseOperator has been separated from SiteOperator
 
@@ -147,11 +150,14 @@ public:
 
             maquis::cout << std::endl;
             maquis::cout << "Sweep " << sweep << ", optimizing sites " << site1 << " and " << site2 << std::endl;
+            tracing::set_context(sweep, site1);
+            residency.move_to(site1, lr);
 
             if (_site != L-1)
             { 
-                Storage::broadcast::fetch(left_[site1]);
-                Storage::broadcast::fetch(right_[site2+1]);
+                tracing::span trace("fetch_boundaries", "io_wait");
+                residency.fetch(residency_t::left_side, site1);
+                residency.fetch(residency_t::right_side, site2+1);
             }
 
             std::chrono::high_resolution_clock::time_point now, then;
@@ -174,11 +180,11 @@ public:
 
 
             if (lr == +1) {
-                if (site1 > 0)                  Storage::broadcast::pin(left_[site1-1]);
-                if (site2+2 < right_.size())    Storage::broadcast::prefetch(right_[site2+2]);
+                if (site1 > 0)                  residency.pin(residency_t::left_side, site1-1);
+                if (site2+2 < right_.size())    residency.prefetch(residency_t::right_side, site2+2);
             } else {
-                if (site2+2 < right_.size())    Storage::broadcast::pin(right_[site2+2]);
-                if (site1 > 0)                  Storage::broadcast::prefetch(left_[site1-1]);
+                if (site2+2 < right_.size())    residency.pin(residency_t::right_side, site2+2);
+                if (site1 > 0)                  residency.prefetch(residency_t::left_side, site1-1);
             }
 
             //bool preshot = false;
@@ -236,6 +242,7 @@ public:
                 } else if (parms["eigensolver"] == std::string("IETL_JCD")) {
                     //BEGIN_TIMING("JCD")
                     //res = solve_ietl_jcd(sp, twin_mps, parms, ortho_vecs);
+                    tracing::span trace("solve_site_problem", "eigensolver");
                     res = solve_site_problem(twin_mps, left_[site1], right_[site2+1], ts_cache_mpo[site1],
                                              ortho_vecs, parms, ratio);
                     //END_TIMING("JCD")
@@ -284,16 +291,37 @@ public:
             double cutoff = this->get_cutoff(sweep);
             std::size_t Mmax = this->get_Mmax(sweep);
             truncation_results trunc;
+
+            // Schmidt values kept for the entropy measurements. The split sets the spectrum of
+            // bond site1, which the next pair changes again. The outer bond behind the sweep
+            // direction is not touched any more in this half sweep, so its spectrum is final.
+            bool record_spectrum = this->bond_spectra_.size() > 0;
+            int outer_bond = (lr == +1) ? site1-1 : site2;
+            block_matrix<dmt, SymmGroup> s;
+            if (record_spectrum) {
+                this->bond_spectra_[site1] = typename entanglement_spectrum_type::value_type();
+                if (outer_bond >= 0 && outer_bond < L-1)
+                    this->bond_spectra_[outer_bond] = typename entanglement_spectrum_type::value_type();
+            }
             
             if (lr == +1)
             {
                 // Write back result from optimization
-                if (parms["twosite_truncation"] == "svd")
-                    boost::tie(mps[site1], mps[site2], trunc) = tst.split_mps_l2r(Mmax, cutoff);
-                else
-                    boost::tie(mps[site1], mps[site2], trunc) = contraction::Engine<Matrix, BoundaryMatrix, SymmGroup>::
-                        predict_split_l2r(tst, Mmax, cutoff, alpha, left_[site1], mpo[site1]);
+                {
+                    tracing::span trace("split_l2r", "truncation");
+                    if (parms["twosite_truncation"] == "svd")
+                        boost::tie(mps[site1], mps[site2], trunc) = tst.split_mps_l2r(Mmax, cutoff, record_spectrum ? &s : NULL);
+                    else
+                        boost::tie(mps[site1], mps[site2], trunc) = contraction::Engine<Matrix, BoundaryMatrix, SymmGroup>::
+                            predict_split_l2r(tst, Mmax, cutoff, alpha, left_[site1], mpo[site1]);
+                    trace.counter("bond_dimension", trunc.bond_dimension);
+                }
                 tst.clear();
+                if (record_spectrum && s.n_blocks() > 0) {
+                    this->bond_spectra_[site1] = bond_spectrum(s);
+                    if (site1 > 0)
+                        this->bond_spectra_[outer_bond] = bond_spectrum(outer_spectrum(mps[site1], s, true));
+                }
 
                 block_matrix<Matrix, SymmGroup> t;
 
@@ -305,24 +333,34 @@ public:
                 if (site2 < L-1) mps[site2+1].multiply_from_left(t);
 
                 if (site1 != L-2)
-                    Storage::broadcast::drop(right_[site2+1]);
+                    residency.drop(residency_t::right_side, site2+1);
 
+                this->broadcast_sites(site1, site2+2);
                 this->boundary_left_step(mpo, site1); // creating left_[site2]
-                Storage::broadcast::prefetch(left_[site2]);
+                residency.prefetch(residency_t::left_side, site2);
 
                 if (site1 != L-2){ 
                     Storage::broadcast::evict(mps[site1]);
-                    Storage::broadcast::evict(left_[site1]);
+                    residency.release(residency_t::left_side, site1);
                 }
             }
             if (lr == -1){
                 // Write back result from optimization
-                if (parms["twosite_truncation"] == "svd")
-                    boost::tie(mps[site1], mps[site2], trunc) = tst.split_mps_r2l(Mmax, cutoff);
-                else
-                    boost::tie(mps[site1], mps[site2], trunc) = contraction::Engine<Matrix, BoundaryMatrix, SymmGroup>::
-                        predict_split_r2l(tst, Mmax, cutoff, alpha, right_[site2+1], mpo[site2]);
+                {
+                    tracing::span trace("split_r2l", "truncation");
+                    if (parms["twosite_truncation"] == "svd")
+                        boost::tie(mps[site1], mps[site2], trunc) = tst.split_mps_r2l(Mmax, cutoff, record_spectrum ? &s : NULL);
+                    else
+                        boost::tie(mps[site1], mps[site2], trunc) = contraction::Engine<Matrix, BoundaryMatrix, SymmGroup>::
+                            predict_split_r2l(tst, Mmax, cutoff, alpha, right_[site2+1], mpo[site2]);
+                    trace.counter("bond_dimension", trunc.bond_dimension);
+                }
                 tst.clear();
+                if (record_spectrum && s.n_blocks() > 0) {
+                    this->bond_spectra_[site1] = bond_spectrum(s);
+                    if (site2 < L-1)
+                        this->bond_spectra_[outer_bond] = bond_spectrum(outer_spectrum(mps[site2], s, false));
+                }
 
                 block_matrix<Matrix, SymmGroup> t;
 
@@ -334,14 +372,15 @@ public:
                 if (site1 > 0) mps[site1-1].multiply_from_right(t);
 
                 if(site1 != 0)
-                    Storage::broadcast::drop(left_[site1]);
+                    residency.drop(residency_t::left_side, site1);
 
+                this->broadcast_sites(site1-1, site2+1);
                 this->boundary_right_step(mpo, site2); // creating right_[site2]
-                Storage::broadcast::prefetch(right_[site2]);
+                residency.prefetch(residency_t::right_side, site2);
 
                 if(site1 != 0){
                     Storage::broadcast::evict(mps[site2]);
-                    Storage::broadcast::evict(right_[site2+1]); 
+                    residency.release(residency_t::right_side, site2+1);
                 }
             }
             
@@ -349,6 +388,7 @@ public:
             iteration_results_["TruncatedWeight"]   << trunc.truncated_weight;
             iteration_results_["TruncatedFraction"] << trunc.truncated_fraction;
             iteration_results_["SmallestEV"]        << trunc.smallest_ev;
+            this->record_memory(trunc.bond_dimension);
             
             std::chrono::high_resolution_clock::time_point sweep_then = std::chrono::high_resolution_clock::now();
             double elapsed = std::chrono::duration<double>(sweep_then - sweep_now).count();
@@ -359,11 +399,43 @@ public:
 
         } // for sites
         initial_site = -1;
+        residency.print_summary();
+        this->record_trace_summary(sweep);
+        this->report_memory(sweep);
     } // sweep
 
 private:
+    typedef typename alps::numeric::associated_real_diagonal_matrix<Matrix>::type dmt;
+
+    // Singular values of a split across its outer bond: the left bond of u*s for a left-normalized
+    // u (left == true) or the right bond of s*v for a right-normalized v. The other factor of the
+    // split is orthonormal, so these are the Schmidt values of the state across that bond.
+    static block_matrix<dmt, SymmGroup> outer_spectrum(MPSTensor<Matrix, SymmGroup> const & orth,
+                                                       block_matrix<dmt, SymmGroup> const & s, bool left)
+    {
+        block_matrix<Matrix, SymmGroup> m, u, v;
+        block_matrix<dmt, SymmGroup> ret;
+        if (left) {
+            orth.make_left_paired();
+            gemm(orth.data(), s, m);
+            MPSTensor<Matrix, SymmGroup> us(orth.site_dim(), orth.row_dim(), m.right_basis(), m, LeftPaired);
+            us.make_right_paired();
+            svd(us.data(), u, v, ret);
+        }
+        else {
+            orth.make_right_paired();
+            gemm(s, orth.data(), m);
+            MPSTensor<Matrix, SymmGroup> sv(orth.site_dim(), m.left_basis(), orth.col_dim(), m, RightPaired);
+            sv.make_left_paired();
+            svd(sv.data(), u, v, ret);
+        }
+        return ret;
+    }
+
     int initial_site;
     MPO<Matrix, SymmGroup> ts_cache_mpo;
+    memtrack::scoped_usage ts_mpo_usage;
+    residency_t residency;
 };
 
 #endif
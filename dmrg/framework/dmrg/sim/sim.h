@@ -56,6 +56,7 @@
 
 #include "dmrg/utils/random.hpp"
 #include "dmrg/utils/time_stopper.h"
+#include "dmrg/utils/numa.h"
 #include "utils/timings.h"
 #include "dmrg/utils/md5.h"
 #include "dmrg/utils/checks.h"
@@ -63,6 +64,7 @@
 #include "dmrg/models/lattice.h"
 #include "dmrg/models/model.h"
 #include "dmrg/models/measurements.h"
+#include "dmrg/models/chem/orbital_ordering.h"
 
 
 
@@ -88,11 +90,14 @@ protected:
     
     measurements_type iteration_measurements(int sweep);
     virtual void measure(std::string archive_path, measurements_type & meas);
+    /// Schmidt values per bond recorded while sweeping to the current mps, NULL if there are none
+    virtual entanglement_spectrum_type const* recorded_spectra() const { return NULL; }
 
     // TODO: can be made const, now only problem are parameters
     virtual void checkpoint_simulation(MPS<Matrix, SymmGroup> const& state, status_type const&);
 
     static DmrgParameters complete_parameters(DmrgParameters);
+    void choose_orbital_order();
     
 protected:
     DmrgParameters parms;
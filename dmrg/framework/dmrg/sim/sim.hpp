@@ -38,11 +38,18 @@ sim<Matrix, SymmGroup>::sim(DmrgParameters const & parms_, bool measure_on_mps)
 , stop_callback(static_cast<double>(parms["run_seconds"]))
 { 
     maquis::cout << DMRG_VERSION_STRING << std::endl;
+    // before the model and the MPS exist, nothing tracked is allocated yet
+    if (parms["track_memory"] || parms["predict_memory"])
+        memtrack::enable();
     storage::setup(parms);
+    numa::setup(parms["numa_placement"].str(), parms["thread_affinity"].str());
     dmrg_random::engine.seed(parms["seed"]);
 
     accelerator::setup(parms["GPU"]);
     
+    /// Orbital ordering, the lattice takes the site types from it
+    choose_orbital_order();
+
     /// Model initialization
     lat = Lattice(parms);
     model = Model<Matrix, SymmGroup>(lat, parms);
@@ -92,13 +99,22 @@ sim<Matrix, SymmGroup>::sim(DmrgParameters const & parms_, bool measure_on_mps)
 
             std::string hash = (parms.is_set("integral_file")) ? md5sum(parms["integral_file"], true)
                                                                : md5sum(parms["integrals"], false);
-            if (hash == previous_hash)
+
+            // the MPO was built for the orbital order stored with it
+            std::string previous_order, order = parms.is_set("orbital_order") ? parms["orbital_order"].str() : "";
+            if (ar_props.is_data("/orbital_order"))
+                ar_props["/orbital_order"] >> previous_order;
+
+            if (hash == previous_hash && order == previous_order)
                 restore_mpo = true;
             else
-                maquis::cout << "Integral file changed, building a new MPO\n";
+                maquis::cout << "Integral file or orbital order changed, building a new MPO\n";
         }
     }
 
+    // all ranks have read the checkpoint before the master rewrites mpo.h5 and props.h5
+    parallel::sync();
+
     /// MPO initialization
     if (restore_mpo)
     {
@@ -111,12 +127,12 @@ sim<Matrix, SymmGroup>::sim(DmrgParameters const & parms_, bool measure_on_mps)
     {
         if (parms["verbosity"] == 0) { maquis::silence(); }
 
-        mpo = make_mpo(lat, model);
+        mpo = make_mpo(lat, model, parms);
 
         maquis::cout  << std::endl;
         maquis::cout.clear();
 
-        if (!dns && have_integrals)
+        if (!dns && have_integrals && parallel::master())
         {
             if (!boost::filesystem::exists(chkpfile)) boost::filesystem::create_directory(chkpfile);
 
@@ -128,6 +144,8 @@ sim<Matrix, SymmGroup>::sim(DmrgParameters const & parms_, bool measure_on_mps)
             std::string hash = (parms.is_set("integral_file")) ? md5sum(parms["integral_file"], true)
                                                                : md5sum(parms["integrals"], false);
             ar["/integral_hash"] << hash;
+            if (parms.is_set("orbital_order"))
+                ar["/orbital_order"] << parms["orbital_order"].str();
         }
     }
 
@@ -170,7 +188,8 @@ sim<Matrix, SymmGroup>::sim(DmrgParameters const & parms_, bool measure_on_mps)
         ar["/parameters"] << parms;
         ar["/version"] << DMRG_VERSION_STRING;
     }
-    if (!dns)
+    parallel::sync();
+    if (!dns && parallel::master())
     {
         if (!boost::filesystem::exists(chkpfile)) boost::filesystem::create_directory(chkpfile);
         storage::archive ar(chkpfile+"/props.h5", "w");
@@ -261,14 +280,24 @@ void sim<Matrix, SymmGroup>::measure(std::string archive_path, measurements_type
         measure_es_where = new std::vector<int>();
         *measure_es_where = parms.template get<std::vector<int> >("entanglement_spectra");
     }
+    // use the spectra of the last sweep if the optimizer recorded every bond
+    entanglement_spectrum_type const* recorded = this->recorded_spectra();
+    if (recorded != NULL && (recorded->size() + 1 != mps.length()
+                             || std::find_if(recorded->begin(), recorded->end(),
+                                             [](typename entanglement_spectrum_type::value_type const& b)
+                                             { return b.second.empty(); }) != recorded->end()))
+        recorded = NULL;
+
     std::vector<double> entropies, renyi2;
     if (parms["MEASURE[Entropy]"]) {
         maquis::cout << "Calculating vN entropy." << std::endl;
-        entropies = calculate_bond_entropies(mps);
+        entropies = (recorded != NULL) ? recorded_bond_renyi_entropies(*recorded, 1)
+                                       : calculate_bond_entropies(mps);
     }
     if (parms["MEASURE[Renyi2]"]) {
         maquis::cout << "Calculating n=2 Renyi entropy." << std::endl;
-        renyi2 = calculate_bond_renyi_entropies(mps, 2, measure_es_where, spectra);
+        renyi2 = (recorded != NULL) ? recorded_bond_renyi_entropies(*recorded, 2, measure_es_where, spectra)
+                                    : calculate_bond_renyi_entropies(mps, 2, measure_es_where, spectra);
     }
 
     {
@@ -309,6 +338,46 @@ namespace detail {
     };
 }
 
+template <class Matrix, class SymmGroup>
+void sim<Matrix, SymmGroup>::choose_orbital_order()
+{
+    if (parms["orbital_ordering"] == "none" || parms.is_set("orbital_order")
+        || !(parms.is_set("integral_file") || parms.is_set("integrals")))
+        return;
+
+    // a checkpoint for the same integrals keeps its ordering, the MPS in it depends on it
+    std::string order;
+    boost::filesystem::path p(chkpfile);
+    if (boost::filesystem::exists(p / "props.h5"))
+    {
+        storage::archive ar_props(chkpfile+"/props.h5");
+        if (ar_props.is_data("/integral_hash") && ar_props.is_data("/orbital_order"))
+        {
+            std::string previous_hash;
+            ar_props["/integral_hash"] >> previous_hash;
+            std::string hash = (parms.is_set("integral_file")) ? md5sum(parms["integral_file"], true)
+                                                               : md5sum(parms["integrals"], false);
+            if (hash == previous_hash)
+                ar_props["/orbital_order"] >> order;
+        }
+    }
+
+    if (order.empty() && (boost::filesystem::exists(p / "mps0.h5") || !parms["initfile"].empty()))
+    {
+        // an MPS without a stored ordering was optimized in the identity order
+        maquis::cout << "No orbital order stored with the initial MPS, keeping the identity order" << std::endl;
+        return;
+    }
+
+    if (order.empty())
+        order = chem::optimize_orbital_order(parms);
+    else
+        maquis::cout << "Orbital order restored from the checkpoint" << std::endl;
+
+    maquis::cout << "Orbital order: " << order << std::endl;
+    parms.set("orbital_order", order);
+}
+
 template <class Matrix, class SymmGroup>
 DmrgParameters sim<Matrix, SymmGroup>::complete_parameters(DmrgParameters parms)
 {
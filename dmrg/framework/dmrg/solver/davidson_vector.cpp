@@ -33,6 +33,7 @@
 
 #include "dmrg/utils/utils.hpp"
 #include "dmrg/utils/aligned_allocator.hpp"
+#include "dmrg/utils/numa.h"
 
 #include "dmrg/solver/accelerator.h"
 #include "dmrg/solver/numeric/gpu.h"
@@ -96,7 +97,8 @@ DavidsonVector<T>::DavidsonVector(std::vector<const T*> const& bm,
     for (size_t b = 0; b < block_sizes.size(); ++b)
         sz += bit_twiddling::round_up<BUFFER_ALIGNMENT>(block_sizes[b]);
 
-    buffer = std::vector<T>(sz);
+    buffer.resize(sz);
+    numa::first_touch(buffer.data(), sz, T(0));
     
     create_view(); 
 
@@ -112,7 +114,8 @@ DavidsonVector<T>::DavidsonVector(std::vector<std::size_t> block_sizes_)
     for (size_t b = 0; b < block_sizes.size(); ++b)
         sz += bit_twiddling::round_up<BUFFER_ALIGNMENT>(block_sizes[b]);
 
-    buffer = std::vector<T>(sz);
+    buffer.resize(sz);
+    numa::first_touch(buffer.data(), sz, T(0));
     
     create_view(); 
 }
@@ -120,11 +123,20 @@ DavidsonVector<T>::DavidsonVector(std::vector<std::size_t> block_sizes_)
 template <class T>
 DavidsonVector<T>::DavidsonVector(DavidsonVector const& other)
 {
-    buffer = other.buffer;
+    buffer.resize(other.buffer.size());
+    numa::first_touch_copy(buffer.data(), other.buffer.data(), buffer.size());
     block_sizes = other.block_sizes;
     create_view();
 }
 
+template <class T>
+DavidsonVector<T>::DavidsonVector(DavidsonVector && other) noexcept
+    : buffer(std::move(other.buffer))
+    , view(std::move(other.view))
+    , block_sizes(std::move(other.block_sizes))
+{
+}
+
 template <class T>
 DavidsonVector<T>& DavidsonVector<T>::operator=(DavidsonVector rhs)
 {
@@ -180,6 +192,19 @@ std::vector<std::size_t> const& DavidsonVector<T>::blocks() const {
     return block_sizes;
 }
 
+template <class T>
+T* DavidsonVector<T>::data() { return buffer.data(); }
+
+template <class T>
+const T* DavidsonVector<T>::data() const { return buffer.data(); }
+
+template <class T>
+void DavidsonVector<T>::copy_to(std::vector<T*> const& out) const
+{
+    for (size_t b = 0; b < block_sizes.size(); ++b)
+        std::copy(view[b], view[b] + block_sizes[b], out[b]);
+}
+
 
 template <class T>
 void DavidsonVector<T>::swap_with(DavidsonVector & other)
@@ -30,6 +30,9 @@
 
 #include <vector>
 
+#include "dmrg/utils/aligned_allocator.hpp"
+#include "dmrg/utils/memory_tracking.h"
+
 
 template <class T>
 class DavidsonVector
@@ -45,6 +48,8 @@ public:
     DavidsonVector(std::vector<std::size_t> block_sizes);
 
     DavidsonVector(DavidsonVector const&);
+    // steals the buffer, the block views stay valid
+    DavidsonVector(DavidsonVector&&) noexcept;
 
     DavidsonVector& operator=(DavidsonVector);
 
@@ -60,6 +65,12 @@ public:
 
     std::vector<std::size_t> const& blocks() const;
 
+    // all blocks live in one buffer, padded to BUFFER_ALIGNMENT
+    T*       data();
+    const T* data() const;
+
+    void copy_to(std::vector<T*> const& out) const;
+
     DavidsonVector const& operator*=(const value_type);
     DavidsonVector const& operator/=(const value_type);
 
@@ -74,7 +85,9 @@ public:
     friend void swap(DavidsonVector<T_>& a, DavidsonVector<T_>& b);
 
 private:
-    std::vector<T> buffer;
+    // zeroed through numa::first_touch instead of by the allocating thread,
+    // counted as solver memory (the JCD subspace consists of DavidsonVectors)
+    std::vector<T, memtrack::allocator<T, memtrack::solver, maquis::first_touch_allocator<T, 64>>> buffer;
     std::vector<T*> view;
     std::vector<std::size_t> block_sizes;
 
@@ -86,44 +99,51 @@ template <class T>
 DavidsonVector<T> operator*(T scal, DavidsonVector<T> const& rhs)
 {
     DavidsonVector<T> ret = rhs;
-    return ret*=scal;
+    ret *= scal;
+    return ret;
 }
 template <class T>
 DavidsonVector<T> operator*(DavidsonVector<T> const& rhs, T scal)
 {
     DavidsonVector<T> ret = rhs;
-    return ret*=scal;
+    ret *= scal;
+    return ret;
 }
 template <class T>
 DavidsonVector<T> operator/(T scal, DavidsonVector<T> const& rhs)
 {
     DavidsonVector<T> ret = rhs;
-    return ret/=scal;
+    ret /= scal;
+    return ret;
 }
 template <class T>
 DavidsonVector<T> operator/(DavidsonVector<T> const& rhs, T scal)
 {
     DavidsonVector<T> ret = rhs;
-    return ret/=scal;
+    ret /= scal;
+    return ret;
 }
 
 template <class T>
 DavidsonVector<T> operator+(DavidsonVector<T> const& a, DavidsonVector<T> const& b)
 {
     DavidsonVector<T> ret = a;
-    return ret+=b;
+    ret += b;
+    return ret;
 }
 template <class T>
 DavidsonVector<T> operator-(DavidsonVector<T> const& a, DavidsonVector<T> const& b)
 {
     DavidsonVector<T> ret = a;
-    return ret-=b;
+    ret -= b;
+    return ret;
 }
 template <class T>
 DavidsonVector<T> operator-(DavidsonVector<T> const& a)
 {
     DavidsonVector<T> ret = a;
-    return ret*=-1.0;
+    ret *= -1.0;
+    return ret;
 }
 
 // explicit instantiation declaration
@@ -0,0 +1,158 @@
+/*****************************************************************************
+ *
+ * ALPS MPS DMRG Project
+ *
+ * Copyright (C) 2026 Department of Chemistry and the PULSE Institute, Stanford University
+ *                    Laboratory for Physical Chemistry, ETH Zurich
+ *
+ * This software is part of the ALPS Applications, published under the ALPS
+ * Application License; you can use, redistribute it and/or modify it under
+ * the terms of the license, either version 1 or (at your option) any later
+ * version.
+ *
+ * You should have received a copy of the ALPS Application License along with
+ * the ALPS Applications; see the file LICENSE.txt. If not, the license is also
+ * available from http://alps.comp-phys.org/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef LANCZOS_EXPM_H
+#define LANCZOS_EXPM_H
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+extern "C" {
+    void dstev_(const char* jobz, const int* n, double* d, double* e, double* z, const int* ldz,
+                double* work, int* info);
+}
+
+namespace lanczos_detail {
+
+    // Eigenvalues d (ascending) and eigenvectors z of the symmetric tridiagonal matrix with
+    // diagonal d and off-diagonal e[i] = T(i,i+1); z is column major, column k belongs to d[k]
+    inline void tridiagonal_eigen(std::vector<double> & d, std::vector<double> e, std::vector<double> & z)
+    {
+        int n = d.size(), info = 0;
+        e.resize(std::max(n, 1), 0.);
+        z.resize(n * n);
+        std::vector<double> work(std::max(1, 2*n-2));
+
+        dstev_("V", &n, &d[0], &e[0], &z[0], &n, &work[0], &info);
+        if (info != 0)
+            throw std::runtime_error("tridiagonal_eigen: dstev failed\n");
+    }
+
+    // exp(-tau T) e_0 for the tridiagonal T with diagonal alpha and off-diagonal beta,
+    // up to a positive factor
+    inline std::vector<double> expm_e0(std::vector<double> d, std::vector<double> const & e, double tau)
+    {
+        std::vector<double> z;
+        tridiagonal_eigen(d, e, z);
+        int n = d.size();
+
+        // shift all exponents below zero, the result is normalized by the caller anyway
+        double shift = (tau > 0) ? d[0] : d[n-1];
+        std::vector<double> ret(n, 0.);
+        for (int k = 0; k < n; ++k) {
+            double w = std::exp(-tau * (d[k] - shift)) * z[k*n];
+            for (int i = 0; i < n; ++i)
+                ret[i] += z[i + k*n] * w;
+        }
+        return ret;
+    }
+
+    // exp(t S) e_0 for the skew symmetric tridiagonal S with S(i+1,i) = beta[i] = -S(i,i+1).
+    // With D = diag(1, i, -1, -i, ...), D^-1 S D = -i B for the symmetric B with zero diagonal
+    // and off-diagonal beta, so exp(t S) e_0 = D exp(-i t B) e_0, which is real.
+    inline std::vector<double> expm_e0_skew(std::vector<double> const & e, double t)
+    {
+        int n = e.size() + 1;
+        std::vector<double> d(n, 0.), z;
+        tridiagonal_eigen(d, e, z);
+
+        std::vector<double> re(n, 0.), im(n, 0.);
+        for (int k = 0; k < n; ++k) {
+            double c = std::cos(t * d[k]) * z[k*n], s = std::sin(t * d[k]) * z[k*n];
+            for (int i = 0; i < n; ++i) {
+                re[i] += z[i + k*n] * c;
+                im[i] -= z[i + k*n] * s;
+            }
+        }
+
+        // real part of i^i (re + i im)
+        std::vector<double> ret(n);
+        for (int i = 0; i < n; ++i)
+            switch (i % 4) {
+                case 0: ret[i] =  re[i]; break;
+                case 1: ret[i] = -im[i]; break;
+                case 2: ret[i] = -re[i]; break;
+                case 3: ret[i] =  im[i]; break;
+            }
+        return ret;
+    }
+}
+
+/// exp(-tau H) v / |exp(-tau H) v| by a Lanczos projection of the operator applied by mv.
+/// In real time (real_time == true) mv applies an antisymmetric generator K, the realified
+/// form of -iH, and v becomes exp(tau K) v; the projection of K is skew tridiagonal.
+/// The Krylov space grows until the weight of the projected exponential on the newest Lanczos
+/// vector drops below tol or max_krylov vectors have been built. Returns <v|mv|v>/<v|v>, which
+/// is the energy in imaginary time and vanishes in real time.
+/// Vector needs scalar_norm, scalar_overlap and the vector space operators.
+template <class Vector, class MatVec>
+double lanczos_expm(MatVec const & mv, Vector & v, double tau, bool real_time,
+                    double tol, int max_krylov, int & krylov_dim)
+{
+    double beta0 = v.scalar_norm();
+    if (beta0 == 0.)
+        throw std::runtime_error("lanczos_expm: zero input vector\n");
+
+    std::vector<Vector> basis(1, v / beta0);
+    std::vector<double> alpha, beta;
+    std::vector<double> c(1, 1.);
+
+    for (int j = 0; j < max_krylov; ++j) {
+        Vector w = mv(basis[j]);
+        alpha.push_back(basis[j].scalar_overlap(w));
+
+        // full reorthogonalization, the Krylov spaces are short compared to one matvec
+        for (int k = 0; k <= j; ++k)
+            w -= basis[k].scalar_overlap(w) * basis[k];
+
+        c = real_time ? lanczos_detail::expm_e0_skew(beta, tau)
+                      : lanczos_detail::expm_e0(alpha, beta, tau);
+        double b = w.scalar_norm();
+
+        double cnorm = 0.;
+        for (std::size_t k = 0; k < c.size(); ++k) cnorm += c[k] * c[k];
+        cnorm = std::sqrt(cnorm);
+
+        // invariant subspace, or the next vector would not contribute
+        if (b < tol || b * std::abs(c[j]) / cnorm < tol || j+1 == max_krylov)
+            break;
+
+        beta.push_back(b);
+        basis.push_back(w / b);
+    }
+
+    krylov_dim = c.size();
+    v = c[0] * basis[0];
+    for (std::size_t k = 1; k < c.size(); ++k)
+        v += c[k] * basis[k];
+    v /= v.scalar_norm();
+
+    return alpha[0];
+}
+
+#endif
@@ -9,6 +9,7 @@
 
 #include "super_hamil_mv.hpp"
 #include "ietl_jacobi_davidson.h"
+#include "lanczos_expm.h"
 
 template <class T>
 double solve(std::vector<T*>& out, DavidsonVector<T>& dv,
@@ -20,15 +21,38 @@ double solve(std::vector<T*>& out, DavidsonVector<T>& dv,
     res = solve_ietl_jcd(SH, dv, ortho_vecs, jcd_gmres, jcd_tol, jcd_max_iter);
 
     // copy optimized vector into output
-    std::vector<T*> opt_view = res.second.data_view();
-    for (unsigned b = 0; b < opt_view.size(); ++b)
-        std::copy(opt_view[b], opt_view[b] + dv.blocks()[b], out[b]);
+    res.second.copy_to(out);
 
     return res.first;
 }
 
+template <class T>
+double evolve(std::vector<T*>& out, DavidsonVector<T>& dv,
+              SuperHamil<T> const& SH,
+              double tau, bool real_time, double tol, int max_krylov)
+{
+    int krylov_dim;
+    auto mv = [&SH](DavidsonVector<T> const& x) { return contraction::common::super_hamil_mv(x, SH); };
+    double energy = lanczos_expm(mv, dv, tau, real_time, tol, max_krylov, krylov_dim);
+    maquis::cout << "Lanczos exponential used " << krylov_dim << " Krylov vectors." << std::endl;
+    SH.contraction_schedule.niter = krylov_dim;
+
+    dv.copy_to(out);
+    return energy;
+}
+
+template <class T>
+DavidsonVector<T> site_hamil_mv(DavidsonVector<T> const& dv, SuperHamil<T> const& SH)
+{
+    return contraction::common::super_hamil_mv(dv, SH);
+}
+
 // explicit instantiation
 template double solve<double>(std::vector<double*>&, DavidsonVector<double>&,
                               SuperHamil<double> const&,
                               std::vector<DavidsonVector<double>> const&,
                               double, double, int);
+template double evolve<double>(std::vector<double*>&, DavidsonVector<double>&,
+                               SuperHamil<double> const&,
+                               double, bool, double, int);
+template DavidsonVector<double> site_hamil_mv<double>(DavidsonVector<double> const&, SuperHamil<double> const&);
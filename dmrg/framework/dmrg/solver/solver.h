@@ -67,4 +67,14 @@ double solve(std::vector<T*>&, DavidsonVector<T>& initial,
              std::vector<DavidsonVector<T>> const&,
              double, double, int);
 
+// overwrites out with exp(-tau H) initial, normalized; returns <initial|H|initial>.
+// In real time H is the antisymmetric realified generator and out becomes exp(tau H) initial.
+template <class T>
+double evolve(std::vector<T*>&, DavidsonVector<T>& initial,
+              SuperHamil<T> const&,
+              double tau, bool real_time, double tol, int max_krylov);
+
+template <class T>
+DavidsonVector<T> site_hamil_mv(DavidsonVector<T> const&, SuperHamil<T> const&);
+
 #endif
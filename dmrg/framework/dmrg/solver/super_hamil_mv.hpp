@@ -34,6 +34,8 @@
 
 #include <cuda_runtime.h>
 #include "dmrg/utils/cuda_helpers.hpp"
+#include "dmrg/utils/parallel/utils.hpp"
+#include "dmrg/utils/tracing.h"
 
 #include "solver.h"
 
@@ -106,6 +108,8 @@ super_hamil_mv(DavidsonVector<T> const& ket_tensor,
     ScheduleNew<T> const& tasks        = H.contraction_schedule;
     
     ScheduleNew<value_type>::solv_timer.begin();
+    tracing::span trace("super_hamil_mv", "matvec");
+    trace.counter("flops", tasks.total_flops);
 
     DavidsonVector<T> ret(ket_tensor.blocks());
 
@@ -149,6 +153,10 @@ super_hamil_mv(DavidsonVector<T> const& ket_tensor,
             }
     }
 
+    // each rank contracted only its own MPSBlocks; called on every rank, also for an empty
+    // vector, since allreduce_sum is collective and checks that the lengths agree
+    parallel::allreduce_sum(ret.data(), ret.num_elements());
+
     ScheduleNew<value_type>::solv_timer.end();
 
     return ret;
@@ -33,6 +33,7 @@
 #include <mutex>
 
 #include "dmrg/utils/cuda_helpers.hpp"
+#include "dmrg/utils/parallel/utils.hpp"
 
 #include "dmrg/solver/accelerator.h"
 #include "dmrg/solver/numeric/axpy_template.h"
@@ -197,10 +198,10 @@ namespace detail{
 
     template <class VT>
     void Cohort<VT>::prop_l(const value_type* bra_mps,
-                std::vector<std::vector<value_type>> const & T,
+                tile_buffers<value_type> const & T,
                 value_type* new_left) const
     {
-        std::vector<value_type> sloc = create_s(T);
+        tile_buffer<value_type> sloc = create_s(T);
 
         int M = ls;
         int N = nSrows * rs;
@@ -242,10 +243,10 @@ namespace detail{
 
     template <class VT>
     void Cohort<VT>::prop_r(const value_type* bra_mps,
-                std::vector<std::vector<value_type>> const & T,
+                tile_buffers<value_type> const & T,
                 value_type* new_right) const
     {
-        std::vector<value_type> sloc = create_s_r(T);
+        tile_buffer<value_type> sloc = create_s_r(T);
 
         int M = nSrows * ls;
         int N = rs;
@@ -286,11 +287,11 @@ namespace detail{
     template <class VT>
     void Cohort<VT>::contract(
         std::vector<const value_type*> const & left,
-        std::vector<std::vector<value_type>> const & T,
+        tile_buffers<value_type> const & T,
         value_type* output,
         std::mutex & out_mutex) const
     {
-        std::vector<value_type> sloc = create_s_r(T);
+        tile_buffer<value_type> sloc = create_s_r(T);
 
         int M = rs;
         int N = stripe;
@@ -344,12 +345,12 @@ namespace detail{
     }
 
     template <class VT>
-    void Cohort<VT>::lbtm(std::vector<std::vector<VT>> const & T,
+    void Cohort<VT>::lbtm(tile_buffers<VT> const & T,
               value_type* out,
               double alpha
              ) const
     {
-        std::vector<value_type> sloc = create_s(T);
+        tile_buffer<value_type> sloc = create_s(T);
 
         int M = stripe;
         int K = sloc.size() / M;
@@ -362,12 +363,12 @@ namespace detail{
     }
 
     template <class VT>
-    void Cohort<VT>::rbtm(std::vector<std::vector<value_type>> const & T,
+    void Cohort<VT>::rbtm(tile_buffers<value_type> const & T,
               value_type* out,
               double alpha
              ) const
     {
-        std::vector<value_type> sloc = create_s_r(T);
+        tile_buffer<value_type> sloc = create_s_r(T);
 
         int M = stripe;
         int K = nSrows * ls;
@@ -423,9 +424,9 @@ namespace detail{
     std::size_t Cohort<VT>::get_l_size() const { return nSrows * rs * std::size_t(ls); }
 
     template <class VT>
-    std::vector<VT> Cohort<VT>::create_s(std::vector<std::vector<value_type>> const& T) const
+    tile_buffer<VT> Cohort<VT>::create_s(tile_buffers<value_type> const& T) const
     {
-        std::vector<value_type> ret(get_S_size());
+        tile_buffer<value_type> ret(get_S_size());
         for (auto const& x : suv)
         {
             if (!x.alpha.size()) continue;
@@ -464,9 +465,9 @@ namespace detail{
     }
 
     template <class VT>
-    std::vector<VT> Cohort<VT>::create_s_r(std::vector<std::vector<value_type>> const & T) const
+    tile_buffer<VT> Cohort<VT>::create_s_r(tile_buffers<value_type> const & T) const
     {
-        std::vector<value_type> ret(get_S_size());
+        tile_buffer<value_type> ret(get_S_size());
         for (auto const& x : suv)
         {
             if (!x.alpha.size()) continue;
@@ -543,11 +544,11 @@ namespace detail{
     typename MPSBlock<T>::iterator MPSBlock<T>::end() { return data.end(); }
 
     template <class T>
-    std::vector<std::vector<T>>
+    tile_buffers<T>
     MPSBlock<T>::create_T_left(std::vector<const value_type*> const & left,
                   std::vector<const value_type*> const & mps) const
     {
-        std::vector<std::vector<value_type>> ret(t_schedule.size());
+        tile_buffers<value_type> ret(t_schedule.size());
         for (unsigned ti = 0; ti < t_schedule.size(); ++ti)
         {
             unsigned mps_offset = std::get<0>(t_schedule[ti]);
@@ -582,7 +583,7 @@ namespace detail{
             int K = brs;
 
             const value_type* mpsdata = mps[lb_ket] + size_t(K) * mps_offset;
-            ret[ti] = std::vector<value_type>(M * size_t(N) * nb);
+            ret[ti].resize(M * size_t(N) * nb);
             for (unsigned b = 0; b < nb; ++b)
             {
                 size_t loff = b*M*size_t(K);
@@ -648,11 +649,11 @@ namespace detail{
     }
 
     template <class T>
-    std::vector<std::vector<T>>
+    tile_buffers<T>
     MPSBlock<T>::create_T(std::vector<const value_type*> const & right,
              std::vector<const value_type*> const& mps) const
     {
-        std::vector<std::vector<value_type>> ret(t_schedule.size());
+        tile_buffers<value_type> ret(t_schedule.size());
         for (unsigned ti = 0; ti < t_schedule.size(); ++ti)
         {
             unsigned mps_offset = std::get<0>(t_schedule[ti]);
@@ -686,7 +687,7 @@ namespace detail{
             //blas_gemm('N', 'N', M, N, K, value_type(1), mpsdata, M, r_use, K, value_type(0), ret[ti].data(), M);
 
             const value_type* mpsdata = mps[lb_ket] + M * mps_offset;
-            ret[ti] = std::vector<value_type>(M * size_t(N));
+            ret[ti].resize(M * size_t(N));
             for (unsigned b = 0; b < right_rt.n_blocks(ci_eff); ++b)
             {
                 int N = brs;
@@ -766,12 +767,7 @@ namespace detail{
     template <class T>
     unsigned MPSBlock<T>::get_ti(unsigned mps_offset, unsigned ci_virt) const
     {
-        for (unsigned ti = 0; ti < t_schedule.size(); ++ti)
-            if (std::get<0>(t_schedule[ti]) == mps_offset && std::get<1>(t_schedule[ti]) == ci_virt)
-                return ti;
-
-        //throw std::runtime_error("ti not found\n");
-        return std::numeric_limits<unsigned>::max();
+        return t_schedule.find(mps_offset, ci_virt);
     }
 
     template <class T>
@@ -818,6 +814,21 @@ namespace detail{
     template <class T>
     MPSBlock<T>::TSched_type::TSched_type() : buf_size(0) {}
 
+    template <class T>
+    void MPSBlock<T>::TSched_type::push_back(typename base::value_type const & t)
+    {
+        // the first tile with a given key wins, as in a linear search
+        index.emplace(key(std::get<0>(t), std::get<1>(t)), base::size());
+        base::push_back(t);
+    }
+
+    template <class T>
+    unsigned MPSBlock<T>::TSched_type::find(unsigned mps_offset, unsigned ci) const
+    {
+        auto match = index.find(key(mps_offset, ci));
+        return (match != index.end()) ? match->second : std::numeric_limits<unsigned>::max();
+    }
+
     template <class T>
     void MPSBlock<T>::set_rb_ket(unsigned v) { rb_ket = v; }
 
@@ -892,6 +903,22 @@ namespace detail{
 
         std::vector<size_t> mpsb_sorted = sort_invert(flops_list);
 
+        // with several ranks, keep only the blocks of this rank, assigned largest first to the least loaded rank
+        if (parallel::size() > 1)
+        {
+            std::vector<std::size_t> rank_flops(parallel::size(), 0);
+            std::vector<size_t> local_blocks;
+            for (std::size_t idx : mpsb_sorted)
+            {
+                int r = std::min_element(rank_flops.begin(), rank_flops.end()) - rank_flops.begin();
+                rank_flops[r] += flops_list[idx];
+                if (r == parallel::rank())
+                    local_blocks.push_back(idx);
+            }
+            mpsb_sorted.swap(local_blocks);
+            total_flops = rank_flops[parallel::rank()];
+        }
+
         std::size_t nflops = 0, cut = 0;
         for ( ; cut < mpsb_sorted.size(); ++cut) {
             nflops += flops_list[mpsb_sorted[cut]];
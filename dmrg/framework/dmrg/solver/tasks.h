@@ -32,9 +32,12 @@
 #include <thread>
 #include <mutex>
 #include <tuple>
+#include <cstdint>
+#include <unordered_map>
 
 #include "utils/timings.h"
 #include "dmrg/utils/utils.hpp"
+#include "dmrg/utils/memory_tracking.h"
 
 #include "accelerator.h"
 #include "constants.h"
@@ -47,6 +50,12 @@ namespace common {
 
 template <class T> class WorkSet;
 
+// intermediate T and S tiles, counted as contraction schedule memory
+template <class T>
+using tile_buffer = std::vector<T, memtrack::allocator<T, memtrack::schedule>>;
+template <class T>
+using tile_buffers = std::vector<tile_buffer<T>>;
+
 template <class VT>
 class Cohort
 {
@@ -132,9 +141,9 @@ public:
 
     void finalize();
 
-    void prop_l(const value_type* bra_mps, std::vector<std::vector<value_type>> const & T,
+    void prop_l(const value_type* bra_mps, tile_buffers<value_type> const & T,
                 value_type* new_left) const;
-    void prop_r(const value_type* bra_mps, std::vector<std::vector<value_type>> const & T,
+    void prop_r(const value_type* bra_mps, tile_buffers<value_type> const & T,
                 value_type* new_right) const;
 
     void prop_l_gpu(value_type* bra_mps, value_type** dev_T,
@@ -143,13 +152,13 @@ public:
                     value_type* new_right, value_type* dev_new_right) const;
 
     void contract(std::vector<const value_type*> const & left,
-                  std::vector<std::vector<value_type>> const & T,
+                  tile_buffers<value_type> const & T,
                   value_type* output, std::mutex & out_mutex) const;
 
     void contract_gpu(std::vector<void*> const & left, value_type** dev_T, void* dev_out) const;
 
-    void lbtm(std::vector<std::vector<value_type>> const & T, value_type* out, double alpha) const;
-    void rbtm(std::vector<std::vector<value_type>> const & T, value_type* out, double alpha) const;
+    void lbtm(tile_buffers<value_type> const & T, value_type* out, double alpha) const;
+    void rbtm(tile_buffers<value_type> const & T, value_type* out, double alpha) const;
 
     std::size_t n_tasks() const;
     std::size_t n_flops() const;
@@ -180,8 +189,8 @@ private:
     WorkSet<value_type>* ws;
     value_type* dev_S;
 
-    std::vector<value_type> create_s(std::vector<std::vector<value_type>> const& T) const;
-    std::vector<value_type> create_s_r(std::vector<std::vector<value_type>> const & T) const;
+    tile_buffer<value_type> create_s(tile_buffers<value_type> const& T) const;
+    tile_buffer<value_type> create_s_r(tile_buffers<value_type> const & T) const;
 
     void create_s_l_gpu(value_type** dev_T) const;
     void create_s_r_gpu(value_type** dev_T) const;
@@ -209,14 +218,14 @@ public:
     iterator begin();
     iterator end();
 
-    std::vector<std::vector<value_type>>
+    tile_buffers<value_type>
     create_T_left(std::vector<const value_type*> const & left,
                   std::vector<const value_type*> const & mps) const;
 
     value_type** create_T_left_gpu(std::vector<void*> const & left,
                                    std::vector<void*> const & mps) const;
 
-    std::vector<std::vector<value_type>>
+    tile_buffers<value_type>
     create_T(std::vector<const value_type*> const & right,
              std::vector<const value_type*> const& mps) const;
 
@@ -231,11 +240,28 @@ public:
 
     void stage(accelerator::device* dev, WorkSet<value_type>* ws_);
 
+    // (mps_offset, ci, ci_eff, lb_ket, aligned size) of each T tile
     struct TSched_type : public
     std::vector<std::tuple<unsigned, unsigned, unsigned, unsigned, size_t>>
     {
+        typedef std::vector<std::tuple<unsigned, unsigned, unsigned, unsigned, size_t>> base;
+
         TSched_type();
+
+        // also records the tile in the (mps_offset, ci) -> ti index used by get_ti
+        void push_back(typename base::value_type const & t);
+
+        unsigned find(unsigned mps_offset, unsigned ci) const;
+
         size_t buf_size;
+
+    private:
+        static std::uint64_t key(unsigned mps_offset, unsigned ci)
+        {
+            return (std::uint64_t(mps_offset) << 32) | ci;
+        }
+
+        std::unordered_map<std::uint64_t, unsigned> index;
     } t_schedule;
 
     bool on_gpu = false;
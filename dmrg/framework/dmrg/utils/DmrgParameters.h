@@ -64,6 +64,8 @@ private:
 
         add_option("optimization", "singlesite or twosite", value("twosite"));
         add_option("twosite_truncation", "`svd` on the two-site mps or `heev` on the reduced density matrix (with alpha factor)", value("svd"));
+        add_option("singlesite_expansion", "`alpha` density matrix perturbation or `cbe` controlled bond expansion of the singlesite bond", value("alpha"));
+        add_option("cbe_fraction", "states added per `cbe` step, as a fraction of the max. bond dimension", value(0.1));
         
         add_option("alpha_initial","", value(1e-2));
         add_option("alpha_main", "", value(1e-4));
@@ -88,19 +90,33 @@ private:
         add_option("force_keep_result_file", "keep result file from previous calculation even if MPO changed", value(0));
         add_option("run_seconds", "", value(0));
         add_option("storagedir", "", value(""));
-        add_option("use_compressed", "", value(0));
+        add_option("storage_memory_budget", "MB of boundaries kept in memory with `storagedir`, 0 evicts all not in use", value(0));
+        add_option("numa_placement", "first touch of boundaries and Davidson vectors: none (allocating thread), interleave (pages round robin over the threads) or cohort (one thread per boundary cohort)", value("none"));
+        add_option("thread_affinity", "bind the OpenMP worker threads to NUMA nodes: none, compact (fill nodes in order) or spread (round robin over the nodes)", value("none"));
+        add_option("rdm_cache_memory", "MB of left boundaries each thread keeps to share between RDM elements with a common operator prefix", value(256));
+        add_option("rdm_partial_file", "file for partial RDM results, an interrupted RDM measurement resumes from it", value(""));
+        add_option("trace_file", "write a Chrome trace (JSON) of the sweeps to this file (one file per MPI rank, suffixed .rank<r>) and per-sweep trace summaries to the results", value(""));
+        add_option("track_memory", "store current bytes of boundaries, contraction schedule, MPO, solver and SVD at every site in the results, with the process-wide peak since the previous site", value(false));
+        add_option("predict_memory", "print the peak memory of each subsystem after every sweep with an estimate for the next sweep from its planned bond dimension", value(false));
+        add_option("use_compressed", "compress the MPO of the Energy and EnergyVariance measurements: truncated SVD for abelian symmetries, exact folding of parallel bonds for SU2. The sweeps keep the uncompressed MPO and its Hermitian bond pairs", value(0));
         add_option("seed", "", value(42));
         add_option("ALWAYS_MEASURE", "comma separated list of measurements", value(""));
         add_option("measure_each", "", value(1)); 
         add_option("chkp_each", "", value(1)); 
         add_option("update_each", "", value(-1));
         add_option("entanglement_spectra", "", value(0));
+        add_option("sweep_entropies", "take Entropy, Renyi2 and entanglement_spectra from the singular values of the last two-site sweep instead of an extra pass", value(false));
         add_option("conv_thresh", "energy convergence threshold to stop the simulation", value(-1));
         
         add_option("expm_method", "algorithm used for exp(-i H dt): heev (default), geev", value("heev"));
-        add_option("te_type", "time evolution algorithm: nn (default), mpo", value("nn"));
+        add_option("te_type", "time evolution algorithm: nn (default), mpo, tdvp (two-site, one-site with optimization=singlesite; in real time the imaginary part is kept on the end index, entropies then belong to the stacked real and imaginary parts)", value("nn"));
+        add_option("tdvp_krylov_tol", "tdvp: Lanczos exponential stops when the next Krylov vector weighs less", value(1e-10));
+        add_option("tdvp_krylov_maxiter", "tdvp: maximum dimension of the Krylov space", value(20));
         add_option("te_optim", "optimized nn time evolution", value(true));
+        add_option("te_parallel", "nn time evolution: keep Schmidt values on every bond and apply the gates of a layer concurrently", value(false));
 		add_option("te_order", "trotter decomposition: second, fourth (default)", value("fourth"));
+        add_option("te_fit_maxiter", "mpo time evolution: maximum number of fitting sweeps per step", value(6));
+        add_option("te_fit_tol", "mpo time evolution: relative change of the fit distance that stops the fitting sweeps", value(1e-6));
         add_option("dt", "time step in time eovlution", value(1e-3));
         add_option("nsweeps_img", "number of imaginary time steps", value(0));
         
@@ -116,6 +132,7 @@ private:
         add_option("lattice_library", "", value("coded"));
         add_option("model_library", "", value("coded"));
         add_option("model_file", "path to model parameters", value(""));
+        add_option("mpo_construction", "tagged: merge operator strings by key, bipartite: minimal bond dimension per cut from bipartite vertex covers, without hermitian pairs", value("tagged"));
         
         add_option("beta_mode", "", value(0));
         
@@ -217,6 +234,8 @@ private:
         add_option("u1_total_charge2", "");
 
         add_option("orbital_order", "comma separated list of orbital numbers");
+        add_option("orbital_ordering", "compute orbital_order from the integrals if it is not set: none, fiedler (spectral ordering of the exchange integrals)", value("none"));
+        add_option("orbital_ordering_passes", "sweeps of pairwise orbital swaps refining the fiedler ordering", value(10));
         add_option("hf_occ", "comma separated list of orbital occupancies for Hartree Fock initial state");
 
         add_option("MEASURE_CONTINUUM[Psi energy]", "", value(false));
@@ -171,6 +171,38 @@ class aligned_allocator {
     }
 };
 
+// Same as aligned_allocator, but value-less construction leaves the element
+// uninitialized: vector::resize only reserves the pages, they get mapped by
+// whichever thread writes to them first (see numa::first_touch)
+template <typename T, unsigned int Alignment>
+class first_touch_allocator : public aligned_allocator<T,Alignment> {
+  public:
+    template <typename U>
+    struct rebind {
+        typedef first_touch_allocator<U,Alignment> other;
+    };
+
+    first_touch_allocator() NOEXCEPT_SPEC {
+    }
+
+    first_touch_allocator(first_touch_allocator const& a) NOEXCEPT_SPEC {
+    }
+
+    template <typename U>
+    first_touch_allocator(first_touch_allocator<U,Alignment> const& b) NOEXCEPT_SPEC {
+    }
+
+    template <typename C>
+    void construct(C* c) {
+        new ((void*)c) C;
+    }
+
+    template <typename C, class... Args>
+    void construct(C* c, Args&&... args) {
+        new ((void*)c) C(std::forward<Args>(args)...);
+    }
+};
+
 }
 
 #undef NOEXPECT_SPEC
@@ -0,0 +1,193 @@
+/*****************************************************************************
+ *
+ * ALPS MPS DMRG Project
+ *
+ * Copyright (C) 2014 Institute for Theoretical Physics, ETH Zurich
+ *
+ * This software is part of the ALPS Applications, published under the ALPS
+ * Application License; you can use, redistribute it and/or modify it under
+ * the terms of the license, either version 1 or (at your option) any later
+ * version.
+ *
+ * You should have received a copy of the ALPS Application License along with
+ * the ALPS Applications; see the file LICENSE.txt. If not, the license is also
+ * available from http://alps.comp-phys.org/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef MAQUIS_DMRG_UTILS_MEMORY_TRACKING_H
+#define MAQUIS_DMRG_UTILS_MEMORY_TRACKING_H
+
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+/// Current and peak bytes per subsystem.
+///
+/// Containers opt in with memtrack::allocator, memory allocated elsewhere (LAPACK
+/// workspaces, operator tables) is reported with a scoped_usage of estimated size.
+/// Counting is off by default; a disabled update costs one relaxed atomic load, an
+/// enabled one two relaxed atomic updates. enable() has to come before the first tracked
+/// allocation and cannot be undone, so that every counted release has a counted allocation.
+/// The counters are process-wide: a peak covers all threads and all live objects of a tag.
+namespace memtrack {
+
+    enum tag { boundaries, schedule, mpo, solver, svd, n_tags };
+
+    inline const char * name(tag t)
+    {
+        static const char * names[n_tags] = { "Boundaries", "Schedule", "MPO", "Solver", "SVD" };
+        return names[t];
+    }
+
+    /// Power of the bond dimension the usage of a tag grows with
+    inline int bond_exponent(tag t) { return (t == mpo) ? 0 : 2; }
+
+    namespace detail {
+
+        struct counters
+        {
+            counters()
+            {
+                for (int t = 0; t < n_tags; ++t) {
+                    current[t].store(0);
+                    peak[t].store(0);
+                }
+            }
+
+            std::atomic<std::int64_t> current[n_tags];
+            std::atomic<std::int64_t> peak[n_tags];
+        };
+
+        inline counters & global()
+        {
+            static counters c;
+            return c;
+        }
+
+        inline std::atomic<bool> & enabled_flag()
+        {
+            static std::atomic<bool> e(false);
+            return e;
+        }
+    }
+
+    inline void enable() { detail::enabled_flag().store(true, std::memory_order_relaxed); }
+
+    inline bool enabled() { return detail::enabled_flag().load(std::memory_order_relaxed); }
+
+    inline void allocated(tag t, std::size_t bytes)
+    {
+        if (!enabled()) return;
+        detail::counters & c = detail::global();
+        std::int64_t now = c.current[t].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        std::int64_t peak = c.peak[t].load(std::memory_order_relaxed);
+        while (now > peak && !c.peak[t].compare_exchange_weak(peak, now, std::memory_order_relaxed));
+    }
+
+    inline void released(tag t, std::size_t bytes)
+    {
+        if (!enabled()) return;
+        std::int64_t before = detail::global().current[t].fetch_sub(bytes, std::memory_order_relaxed);
+        assert(before >= std::int64_t(bytes)); // released memory that was allocated before enable()
+        (void)before;
+    }
+
+    inline std::size_t current(tag t) { return detail::global().current[t].load(std::memory_order_relaxed); }
+
+    inline std::size_t peak(tag t) { return detail::global().peak[t].load(std::memory_order_relaxed); }
+
+    /// Start a new peak interval, the peaks restart from the current usage
+    inline void reset_peaks()
+    {
+        detail::counters & c = detail::global();
+        for (int t = 0; t < n_tags; ++t)
+            c.peak[t].store(c.current[t].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    /// Allocator adaptor counting the storage obtained from Base under Tag
+    template <class T, tag Tag, class Base = std::allocator<T> >
+    class allocator : public Base
+    {
+        typedef std::allocator_traits<Base> traits;
+
+    public:
+        typedef T value_type;
+        typedef typename traits::pointer pointer;
+        typedef typename traits::size_type size_type;
+
+        template <class U>
+        struct rebind {
+            typedef allocator<U, Tag, typename traits::template rebind_alloc<U> > other;
+        };
+
+        allocator() {}
+
+        template <class U, class BaseU>
+        allocator(allocator<U, Tag, BaseU> const & b) : Base(static_cast<BaseU const &>(b)) {}
+
+        pointer allocate(size_type n)
+        {
+            pointer p = Base::allocate(n);
+            allocated(Tag, n * sizeof(T));
+            return p;
+        }
+
+        void deallocate(pointer p, size_type n)
+        {
+            released(Tag, n * sizeof(T));
+            Base::deallocate(p, n);
+        }
+    };
+
+    template <class T, class U, tag Tag, class BaseT, class BaseU>
+    bool operator==(allocator<T, Tag, BaseT> const &, allocator<U, Tag, BaseU> const &) { return true; }
+
+    template <class T, class U, tag Tag, class BaseT, class BaseU>
+    bool operator!=(allocator<T, Tag, BaseT> const &, allocator<U, Tag, BaseU> const &) { return false; }
+
+    /// Counts bytes under a tag until reset or destroyed
+    class scoped_usage
+    {
+    public:
+        scoped_usage() : t(n_tags), bytes(0) {}
+        scoped_usage(tag t_, std::size_t bytes_) : t(n_tags), bytes(0) { reset(t_, bytes_); }
+        ~scoped_usage() { reset(); }
+
+        void reset()
+        {
+            if (t != n_tags) released(t, bytes);
+            t = n_tags;
+            bytes = 0;
+        }
+
+        void reset(tag t_, std::size_t bytes_)
+        {
+            reset();
+            if (!enabled()) return;
+            t = t_;
+            bytes = bytes_;
+            allocated(t, bytes);
+        }
+
+    private:
+        scoped_usage(scoped_usage const &);
+        scoped_usage & operator=(scoped_usage const &);
+
+        tag t;
+        std::size_t bytes;
+    };
+
+} // namespace memtrack
+
+#endif
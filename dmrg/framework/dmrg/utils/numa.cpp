@@ -0,0 +1,222 @@
+/*****************************************************************************
+ *
+ * ALPS MPS DMRG Project
+ *
+ * Copyright (C) 2014 Institute for Theoretical Physics, ETH Zurich
+ *
+ * This software is part of the ALPS Applications, published under the ALPS
+ * Application License; you can use, redistribute it and/or modify it under
+ * the terms of the license, either version 1 or (at your option) any later
+ * version.
+ *
+ * You should have received a copy of the ALPS Application License along with
+ * the ALPS Applications; see the file LICENSE.txt. If not, the license is also
+ * available from http://alps.comp-phys.org/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#include "dmrg/utils/numa.h"
+
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#ifdef MAQUIS_OPENMP
+#include <omp.h>
+#endif
+
+#include "utils/io.hpp"
+
+namespace numa {
+
+    namespace {
+
+        // parses the kernel's cpu/node list format, e.g. "0-3,8,10-11"
+        std::vector<int> parse_list(std::string const & list)
+        {
+            std::vector<int> ret;
+            std::istringstream ss(list);
+            std::string range;
+            while (std::getline(ss, range, ',')) {
+                if (range.empty() || range == "\n") continue;
+                std::size_t dash = range.find('-');
+                int first = std::atoi(range.substr(0, dash).c_str());
+                int last = (dash == std::string::npos) ? first : std::atoi(range.substr(dash+1).c_str());
+                for (int i = first; i <= last; ++i)
+                    ret.push_back(i);
+            }
+            return ret;
+        }
+
+        std::string read_line(std::string const & file)
+        {
+            std::string ret;
+            std::ifstream ifs(file.c_str());
+            if (ifs) std::getline(ifs, ret);
+            return ret;
+        }
+
+        // cpus of every online node, a single node without cpu list if the topology is unknown
+        std::vector<std::vector<int> > node_cpus()
+        {
+            std::vector<std::vector<int> > ret;
+            std::vector<int> nodes = parse_list(read_line("/sys/devices/system/node/online"));
+            for (int n : nodes) {
+                std::ostringstream fname;
+                fname << "/sys/devices/system/node/node" << n << "/cpulist";
+                ret.push_back(parse_list(read_line(fname.str())));
+            }
+            if (ret.empty())
+                ret.resize(1);
+            return ret;
+        }
+
+        placement_t parse_placement(std::string const & p)
+        {
+            if (p == "none")       return none;
+            if (p == "interleave") return interleave;
+            if (p == "cohort")     return cohort;
+            throw std::runtime_error("numa_placement must be none, interleave or cohort, not " + p);
+        }
+
+#if defined(__linux__) && defined(MAQUIS_OPENMP)
+        // binds every OpenMP worker thread to all allowed cpus of one node, returns the node of
+        // each thread. The master thread keeps the process mask, so threads it spawns later
+        // (OpenMP threads added by a larger team, library threads) are not confined to one node.
+        std::vector<int> bind_threads(std::vector<std::vector<int> > const & topology, std::string const & affinity)
+        {
+            cpu_set_t allowed;
+            CPU_ZERO(&allowed);
+            sched_getaffinity(0, sizeof(allowed), &allowed);
+
+            // nodes we may run on, with their allowed cpus
+            std::vector<std::vector<int> > nodes;
+            std::vector<int> node_id;
+            for (std::size_t n = 0; n < topology.size(); ++n) {
+                std::vector<int> mine;
+                for (int c : topology[n])
+                    if (CPU_ISSET(c, &allowed)) mine.push_back(c);
+                if (mine.size()) {
+                    nodes.push_back(mine);
+                    node_id.push_back(n);
+                }
+            }
+
+            int nthreads = omp_get_max_threads();
+            std::vector<int> thread_node(nthreads, 0);
+            if (nodes.size() == 0)
+                return thread_node;
+
+            if (affinity == "spread") {
+                for (int t = 0; t < nthreads; ++t)
+                    thread_node[t] = t % nodes.size();
+            }
+            else {
+                // fill the nodes in order, one thread per cpu, then wrap around
+                std::vector<int> cpu_node;
+                for (std::size_t n = 0; n < nodes.size(); ++n)
+                    cpu_node.insert(cpu_node.end(), nodes[n].size(), n);
+                for (int t = 0; t < nthreads; ++t)
+                    thread_node[t] = cpu_node[t % cpu_node.size()];
+            }
+
+            #pragma omp parallel num_threads(nthreads)
+            if (omp_get_thread_num() != 0)
+            {
+                std::vector<int> const & cpus = nodes[thread_node[omp_get_thread_num()]];
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                for (int c : cpus)
+                    CPU_SET(c, &set);
+                sched_setaffinity(0, sizeof(set), &set);
+            }
+
+            for (int t = 0; t < nthreads; ++t)
+                thread_node[t] = node_id[thread_node[t]];
+            thread_node[0] = -1;
+            return thread_node;
+        }
+#endif
+
+        // affinity of the last setup and the team size it was applied to
+        std::string & bound_affinity()
+        {
+            static std::string a = "none";
+            return a;
+        }
+
+        int & bound_threads()
+        {
+            static int n = 0;
+            return n;
+        }
+    }
+
+    int num_nodes()
+    {
+        return node_cpus().size();
+    }
+
+    void setup(std::string const & placement_, std::string const & affinity)
+    {
+        placement() = parse_placement(placement_);
+        if (affinity != "none" && affinity != "compact" && affinity != "spread")
+            throw std::runtime_error("thread_affinity must be none, compact or spread, not " + affinity);
+
+        std::vector<std::vector<int> > topology = node_cpus();
+
+        int nthreads = 1;
+        #ifdef MAQUIS_OPENMP
+        nthreads = omp_get_max_threads();
+        #endif
+
+        std::vector<int> thread_node;
+        #if defined(__linux__) && defined(MAQUIS_OPENMP)
+        if (affinity != "none")
+            thread_node = bind_threads(topology, affinity);
+        #endif
+        bound_affinity() = affinity;
+        bound_threads() = nthreads;
+
+        maquis::cout << "NUMA nodes: " << topology.size() << ", threads: " << nthreads
+                     << ", placement: " << placement_ << ", affinity: " << affinity;
+        const char* bind = std::getenv("OMP_PROC_BIND");
+        if (bind) maquis::cout << ", OMP_PROC_BIND=" << bind;
+        maquis::cout << std::endl;
+
+        if (thread_node.size()) {
+            std::vector<int> per_node(topology.size(), 0);
+            for (int n : thread_node)
+                if (n >= 0) ++per_node[n];
+            maquis::cout << "Worker threads per NUMA node:";
+            for (int c : per_node)
+                maquis::cout << " " << c;
+            maquis::cout << ", master thread unbound" << std::endl;
+        }
+        else if (affinity != "none")
+            maquis::cout << "Thread affinity is not supported in this build, threads are not bound" << std::endl;
+    }
+
+    void rebind()
+    {
+        #if defined(__linux__) && defined(MAQUIS_OPENMP)
+        if (bound_affinity() == "none" || bound_threads() == omp_get_max_threads())
+            return;
+        bind_threads(node_cpus(), bound_affinity());
+        bound_threads() = omp_get_max_threads();
+        #endif
+    }
+}
@@ -0,0 +1,142 @@
+/*****************************************************************************
+ *
+ * ALPS MPS DMRG Project
+ *
+ * Copyright (C) 2014 Institute for Theoretical Physics, ETH Zurich
+ *
+ * This software is part of the ALPS Applications, published under the ALPS
+ * Application License; you can use, redistribute it and/or modify it under
+ * the terms of the license, either version 1 or (at your option) any later
+ * version.
+ *
+ * You should have received a copy of the ALPS Application License along with
+ * the ALPS Applications; see the file LICENSE.txt. If not, the license is also
+ * available from http://alps.comp-phys.org/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef DMRG_UTILS_NUMA_H
+#define DMRG_UTILS_NUMA_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+/// Page placement of the large working arrays (boundary cohorts, Davidson vectors).
+///
+/// Linux maps a page on the NUMA node of the thread that first writes to it. With
+/// `none` the allocating thread initializes everything, so all pages end up on its
+/// node. `interleave` has the OpenMP threads zero the array page by page in a static
+/// round robin, which spreads shared data evenly over the nodes of the threads.
+/// `cohort` hands out whole boundary cohorts round robin instead, so a cohort lives
+/// on a single node (Davidson vectors are interleaved in this mode).
+namespace numa {
+
+    enum placement_t { none, interleave, cohort };
+
+    inline placement_t & placement()
+    {
+        static placement_t p = none;
+        return p;
+    }
+
+    /// arrays smaller than this many pages are not worth a parallel region
+    static const std::size_t page_size = 4096;
+    static const std::size_t min_pages = 16;
+
+    namespace detail {
+        template <class T>
+        bool touch_in_parallel(std::size_t n)
+        {
+        #ifdef MAQUIS_OPENMP
+            return placement() != none && n * sizeof(T) >= min_pages * page_size;
+        #else
+            return false;
+        #endif
+        }
+    }
+
+    /// Initializes [p, p+n) with value according to the current placement
+    template <class T>
+    void first_touch(T* p, std::size_t n, T value)
+    {
+        if (!detail::touch_in_parallel<T>(n)) {
+            std::fill(p, p + n, value);
+            return;
+        }
+
+        const std::ptrdiff_t chunk = std::max(std::size_t(1), page_size / sizeof(T));
+        const std::ptrdiff_t sn = n;
+        #ifdef MAQUIS_OPENMP
+        #pragma omp parallel for schedule(static, 1)
+        #endif
+        for (std::ptrdiff_t b = 0; b < sn; b += chunk)
+            std::fill(p + b, p + std::min(b + chunk, sn), value);
+    }
+
+    /// Copies [src, src+n) to the uninitialized dst with the same page distribution as first_touch
+    template <class T>
+    void first_touch_copy(T* dst, T const* src, std::size_t n)
+    {
+        if (!detail::touch_in_parallel<T>(n)) {
+            std::copy(src, src + n, dst);
+            return;
+        }
+
+        const std::ptrdiff_t chunk = std::max(std::size_t(1), page_size / sizeof(T));
+        const std::ptrdiff_t sn = n;
+        #ifdef MAQUIS_OPENMP
+        #pragma omp parallel for schedule(static, 1)
+        #endif
+        for (std::ptrdiff_t b = 0; b < sn; b += chunk)
+            std::copy(src + b, src + std::min(b + chunk, sn), dst + b);
+    }
+
+    /// Resizes the vectors in data to sizes[i] elements and zeroes the new ones according to the
+    /// current placement. Vector must use an allocator that leaves resized elements uninitialized.
+    template <class Vector>
+    void allocate_cohorts(std::vector<Vector> & data, std::vector<std::size_t> const & sizes)
+    {
+        typedef typename Vector::value_type value_type;
+
+        #ifdef MAQUIS_OPENMP
+        if (placement() == cohort) {
+            #pragma omp parallel for schedule(static, 1)
+            for (std::size_t ci = 0; ci < data.size(); ++ci) {
+                std::size_t old = std::min(data[ci].size(), sizes[ci]);
+                data[ci].resize(sizes[ci]);
+                std::fill(data[ci].begin() + old, data[ci].end(), value_type(0));
+            }
+            return;
+        }
+        #endif
+
+        for (std::size_t ci = 0; ci < data.size(); ++ci) {
+            std::size_t old = std::min(data[ci].size(), sizes[ci]);
+            data[ci].resize(sizes[ci]);
+            first_touch(data[ci].data() + old, sizes[ci] - old, value_type(0));
+        }
+    }
+
+    /// Sets the placement and pins the OpenMP worker threads according to affinity
+    /// (`none`, `compact` or `spread`), then reports the resulting layout.
+    void setup(std::string const & placement, std::string const & affinity);
+
+    /// Repeats the thread binding of setup if the OpenMP thread count changed since,
+    /// call after omp_set_num_threads
+    void rebind();
+
+    /// Number of NUMA nodes of the machine, 1 if the topology is not available
+    int num_nodes();
+}
+
+#endif
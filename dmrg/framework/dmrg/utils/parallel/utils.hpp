@@ -29,33 +29,164 @@
 #define UTILS_PARALLEL_UTILS_HPP
 
 #include <iostream>
+#include <string>
+#include <complex>
+#include <algorithm>
 #include "dmrg/utils/proc_status.h"
 
+#ifdef MAQUIS_MPI
+#include <mpi.h>
+#include <sstream>
+#include <stdexcept>
+#include <boost/archive/binary_oarchive.hpp>
+#include <boost/archive/binary_iarchive.hpp>
+#endif
+
 namespace parallel {
 
+    // With MAQUIS_MPI all ranks run the same simulation on replicated data and only the
+    // contraction work of the site Hamiltonian is split between them, see ScheduleNew::compute_workload.
+    // Every rank holds the full MPS, MPO and boundaries, so this spreads flops, not memory.
+    // The optimizers broadcast the master's site tensors after every truncation to keep the
+    // replicas identical. Without an initialized MPI environment everything falls back to a
+    // single process.
+
     inline void meminfo(){
         std::cout << "Memory usage : " << proc_status_mem() << std::endl;
     }
+#ifdef MAQUIS_MPI
+    inline bool mpi_enabled(){
+        int init = 0, fin = 0;
+        MPI_Initialized(&init);
+        MPI_Finalized(&fin);
+        return init && !fin;
+    }
     inline void sync(){
+        if (mpi_enabled()) MPI_Barrier(MPI_COMM_WORLD);
     }
-    inline void sync_mkl_parallel(){
+    inline int rank(){
+        int r = 0;
+        if (mpi_enabled()) MPI_Comm_rank(MPI_COMM_WORLD, &r);
+        return r;
+    }
+    inline int size(){
+        int s = 1;
+        if (mpi_enabled()) MPI_Comm_size(MPI_COMM_WORLD, &s);
+        return s;
+    }
+#else
+    inline void sync(){
     }
     inline int rank(){
         return 0;
     }
+    inline int size(){
+        return 1;
+    }
+#endif
+    inline void sync_mkl_parallel(){
+    }
     inline std::string rank_str(){
-        return "0";
+        return std::to_string(rank());
     }
     inline bool master(){
-        return true;
+        return rank() == 0;
     }
     inline bool uniq(){
-        return true;
+        return master();
     }
+    // data is replicated on all ranks, only the master writes it
     inline bool local(){
+        return master();
+    }
+
+#ifdef MAQUIS_MPI
+    inline MPI_Datatype mpi_type(double*) { return MPI_DOUBLE; }
+    inline MPI_Datatype mpi_type(std::complex<double>*) { return MPI_CXX_DOUBLE_COMPLEX; }
+#endif
+
+    // true if n has the same value on every rank
+    inline bool same_on_all_ranks(std::size_t n){
+#ifdef MAQUIS_MPI
+        if (size() == 1) return true;
+        unsigned long long in[2] = { n, ~(unsigned long long)n }, out[2];
+        MPI_Allreduce(in, out, 2, MPI_UNSIGNED_LONG_LONG, MPI_MAX, MPI_COMM_WORLD);
+        return out[0] == n && out[1] == ~(unsigned long long)n;
+#else
         return true;
+#endif
+    }
+
+    // in-place sum over all ranks, n must agree on every rank
+    template <class T>
+    inline void allreduce_sum(T* data, std::size_t n){
+#ifdef MAQUIS_MPI
+        if (size() == 1) return;
+        if (!same_on_all_ranks(n))
+            throw std::runtime_error("allreduce_sum: the vector length differs between ranks");
+        const std::size_t chunk = 1 << 30;
+        for (std::size_t offset = 0; offset < n; offset += chunk)
+            MPI_Allreduce(MPI_IN_PLACE, data + offset, (int)std::min(chunk, n - offset), mpi_type(data),
+                          MPI_SUM, MPI_COMM_WORLD);
+#endif
+    }
+
+    // replaces obj on every rank by the master's copy, T must be boost serializable
+    template <class T>
+    inline void broadcast(T & obj){
+#ifdef MAQUIS_MPI
+        if (size() == 1) return;
+        std::string buf;
+        if (master()) {
+            std::ostringstream oss;
+            {
+                boost::archive::binary_oarchive oa(oss);
+                oa << obj;
+            }
+            buf = oss.str();
+        }
+        unsigned long long n = buf.size();
+        MPI_Bcast(&n, 1, MPI_UNSIGNED_LONG_LONG, 0, MPI_COMM_WORLD);
+        buf.resize(n);
+        const std::size_t chunk = 1 << 30;
+        for (std::size_t offset = 0; offset < n; offset += chunk)
+            MPI_Bcast(&buf[offset], (int)std::min<std::size_t>(chunk, n - offset), MPI_CHAR, 0, MPI_COMM_WORLD);
+        if (!master()) {
+            std::istringstream iss(buf);
+            boost::archive::binary_iarchive ia(iss);
+            ia >> obj;
+        }
+#endif
     }
 
+    // MPI_Init / MPI_Finalize for the lifetime of main, non-master ranks do not write to stdout
+    class environment {
+    public:
+        environment(int & argc, char ** & argv) : cout_buf(NULL) {
+#ifdef MAQUIS_MPI
+            int provided;
+            MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+            // MPI is called from the master thread between OpenMP regions
+            if (provided < MPI_THREAD_FUNNELED) {
+                std::cerr << "MPI library does not provide MPI_THREAD_FUNNELED, aborting.\n";
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            if (!master())
+                cout_buf = std::cout.rdbuf(NULL);
+#endif
+        }
+        ~environment() {
+#ifdef MAQUIS_MPI
+            if (cout_buf)
+                std::cout.rdbuf(cout_buf);
+            MPI_Finalize();
+#endif
+        }
+    private:
+        environment(environment const&);
+        std::streambuf* cout_buf;
+    };
+
 }
 
 #endif
@@ -0,0 +1,227 @@
+/*****************************************************************************
+ *
+ * ALPS MPS DMRG Project
+ *
+ * Copyright (C) 2014 Institute for Theoretical Physics, ETH Zurich
+ *
+ * This software is part of the ALPS Applications, published under the ALPS
+ * Application License; you can use, redistribute it and/or modify it under
+ * the terms of the license, either version 1 or (at your option) any later
+ * version.
+ *
+ * You should have received a copy of the ALPS Application License along with
+ * the ALPS Applications; see the file LICENSE.txt. If not, the license is also
+ * available from http://alps.comp-phys.org/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef MAQUIS_DMRG_UTILS_TRACING_H
+#define MAQUIS_DMRG_UTILS_TRACING_H
+
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <map>
+#include <string>
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+
+/// Scoped, thread-aware spans tagged with the current sweep and site.
+///
+/// Tracing is off by default; a disabled span costs one relaxed atomic load.
+/// Each thread appends to its own buffer, so spans may be opened from OpenMP
+/// workers. Exporting and clearing must not run concurrently with tracing,
+/// i.e. call them between sites or sweeps.
+///
+/// Span names and categories must be string literals, they are stored as pointers.
+namespace tracing {
+
+    struct event
+    {
+        static const int max_counters = 3;
+
+        const char * name;
+        const char * category;
+        int sweep, site;
+        double start, duration; // microseconds since the trace started
+        int ncounters;
+        const char * counter_names[max_counters];
+        double counter_values[max_counters];
+    };
+
+    namespace detail {
+
+        typedef std::chrono::high_resolution_clock clock;
+
+        struct thread_buffer
+        {
+            int tid;
+            std::vector<event> events;
+        };
+
+        struct state
+        {
+            std::atomic<bool> enabled{false};
+            std::atomic<int> sweep{-1}, site{-1};
+            clock::time_point origin = clock::now();
+
+            std::mutex mutex; // guards buffers and trace_file
+            std::vector<std::unique_ptr<thread_buffer> > buffers;
+            std::string trace_file; // file append_chrome_trace has started
+        };
+
+        inline state & global()
+        {
+            static state s;
+            return s;
+        }
+
+        inline thread_buffer & local_buffer()
+        {
+            thread_local thread_buffer * buffer = NULL;
+            if (!buffer) {
+                state & s = global();
+                std::lock_guard<std::mutex> lock(s.mutex);
+                s.buffers.emplace_back(new thread_buffer());
+                buffer = s.buffers.back().get();
+                buffer->tid = s.buffers.size() - 1;
+            }
+            return *buffer;
+        }
+
+        inline double now()
+        {
+            return std::chrono::duration<double, std::micro>(clock::now() - global().origin).count();
+        }
+    }
+
+    inline void enable(bool on = true) { detail::global().enabled.store(on, std::memory_order_relaxed); }
+
+    inline bool enabled() { return detail::global().enabled.load(std::memory_order_relaxed); }
+
+    /// Tag all subsequent spans with sweep and site
+    inline void set_context(int sweep, int site)
+    {
+        detail::global().sweep.store(sweep, std::memory_order_relaxed);
+        detail::global().site.store(site, std::memory_order_relaxed);
+    }
+
+    class span
+    {
+    public:
+        span(const char * name, const char * category) : active(enabled())
+        {
+            if (!active) return;
+            ev.name = name;
+            ev.category = category;
+            ev.sweep = detail::global().sweep.load(std::memory_order_relaxed);
+            ev.site = detail::global().site.load(std::memory_order_relaxed);
+            ev.ncounters = 0;
+            ev.start = detail::now();
+        }
+
+        ~span()
+        {
+            if (!active) return;
+            ev.duration = detail::now() - ev.start;
+            detail::local_buffer().events.push_back(ev);
+        }
+
+        /// Attach a counter (flops, bytes, ...) to the span, at most event::max_counters
+        void counter(const char * name, double value)
+        {
+            if (!active || ev.ncounters == event::max_counters) return;
+            ev.counter_names[ev.ncounters] = name;
+            ev.counter_values[ev.ncounters++] = value;
+        }
+
+    private:
+        span(span const &);
+        span & operator=(span const &);
+
+        bool active;
+        event ev;
+    };
+
+    struct phase_summary
+    {
+        phase_summary() : seconds(0), calls(0) {}
+
+        double seconds;
+        std::size_t calls;
+        std::map<std::string, double> counters;
+    };
+
+    /// Total time, number of spans and counter sums per category for one sweep.
+    /// Nested spans of different categories are each counted in full.
+    inline std::map<std::string, phase_summary> summary(int sweep)
+    {
+        std::map<std::string, phase_summary> ret;
+        detail::state & s = detail::global();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (std::size_t b = 0; b < s.buffers.size(); ++b)
+            for (event const & ev : s.buffers[b]->events)
+                if (ev.sweep == sweep) {
+                    phase_summary & ps = ret[ev.category];
+                    ps.seconds += ev.duration * 1e-6;
+                    ps.calls += 1;
+                    for (int c = 0; c < ev.ncounters; ++c)
+                        ps.counters[ev.counter_names[c]] += ev.counter_values[c];
+                }
+        return ret;
+    }
+
+    /// Append the spans recorded since the last call to filename in the Chrome trace event
+    /// format (chrome://tracing, Perfetto) and drop them. The first call for a file truncates
+    /// it. The JSON array format is used, whose closing bracket is optional, so the file is
+    /// a valid trace after every call. pid distinguishes the traces of several processes.
+    inline void append_chrome_trace(std::string const & filename, int pid = 0)
+    {
+        detail::state & s = detail::global();
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        bool start = s.trace_file != filename;
+        std::ofstream ofs(filename.c_str(), start ? std::ios::trunc : std::ios::app);
+        if (!ofs)
+            throw std::runtime_error("cannot open trace file " + filename);
+        if (start) {
+            ofs << "[\n";
+            s.trace_file = filename;
+        }
+
+        for (std::size_t b = 0; b < s.buffers.size(); ++b) {
+            for (event const & ev : s.buffers[b]->events) {
+                ofs << "{\"name\": \"" << ev.name << "\", \"cat\": \"" << ev.category << "\", \"ph\": \"X\""
+                    << ", \"pid\": " << pid << ", \"tid\": " << s.buffers[b]->tid
+                    << ", \"ts\": " << ev.start << ", \"dur\": " << ev.duration
+                    << ", \"args\": {\"sweep\": " << ev.sweep << ", \"site\": " << ev.site;
+                for (int c = 0; c < ev.ncounters; ++c)
+                    ofs << ", \"" << ev.counter_names[c] << "\": " << ev.counter_values[c];
+                ofs << "}},\n";
+            }
+            s.buffers[b]->events.clear();
+        }
+    }
+
+    /// Drop all recorded spans, the thread buffers stay registered
+    inline void clear()
+    {
+        detail::state & s = detail::global();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        for (std::size_t b = 0; b < s.buffers.size(); ++b)
+            s.buffers[b]->events.clear();
+    }
+
+} // namespace tracing
+
+#endif
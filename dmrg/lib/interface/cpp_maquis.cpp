@@ -33,6 +33,7 @@
 
 #include "dmrg/utils/DmrgParameters.h"
 #include "dmrg/sim/symmetry_factory.h"
+#include "dmrg/utils/numa.h"
 
 #include "../../../dmrg/applications/dmrg/simulation.h"
 #include "cpp_maquis.h"
@@ -143,6 +144,7 @@ void Interface::set_threads()
     else
         dmrg_num_threads = omp_get_num_procs();
     omp_set_num_threads(dmrg_num_threads);
+    numa::rebind();
     #endif
 }
 
@@ -368,6 +370,65 @@ void Interface::tpdm(double** ret, int bra, int ket)
     }
 }
 
+void Interface::stream_rdm(std::string const & name, int bra, int ket,
+                           std::function<void(std::vector<int> const &, double)> const & visit)
+{
+    if (bra >= simv.size() || ket >= simv.size())
+        throw std::runtime_error("State index specified is out of range (corresponding excited state has not been computed)\n");
+
+    set_threads();
+    simv[bra]->measure_observable(name, visit, (bra==ket) ? NULL : simv[ket]);
+    restore_threads();
+}
+
+void Interface::opdm(std::function<void(int, int, double)> const & f, int bra, int ket)
+{
+    stream_rdm("oneptdm", bra, ket, [&f](std::vector<int> const & lab, double val) { f(lab[0], lab[1], val); });
+}
+
+void Interface::tpdm(std::function<void(int, int, int, int, double)> const & f, int bra, int ket)
+{
+    stream_rdm("twoptdm", bra, ket, [&f](std::vector<int> const & lab, double val)
+    {
+        // same reordering and scaling as tpdm(double**)
+        f(lab[0], lab[3], lab[1], lab[2], 0.5 * val);
+    });
+}
+
+std::size_t Interface::opdm_packed_index(int i, int j)
+{
+    if (i < j) std::swap(i, j);
+    return std::size_t(i) * (i+1) / 2 + j;
+}
+
+std::size_t Interface::tpdm_packed_index(int i, int j, int k, int l, int L)
+{
+    std::size_t ij = std::size_t(i) * L + j;
+    std::size_t kl = std::size_t(k) * L + l;
+    if (ij < kl) std::swap(ij, kl);
+    return ij * (ij+1) / 2 + kl;
+}
+
+void Interface::opdm_packed(double *ret, int state)
+{
+    // transition 1-rdms are not symmetric
+    opdm([ret](int i, int j, double value) { ret[opdm_packed_index(i, j)] = value; }, state, state);
+}
+
+void Interface::tpdm_packed(double *ret, int bra, int ket)
+{
+    int acti = detail::parms["L"];
+    bool transition = (bra != ket);
+
+    // Gklij and Glkji share the slots of Gijkl and Gjilk
+    tpdm([ret, acti, transition](int I, int J, int K, int L, double value)
+    {
+        ret[tpdm_packed_index(I, J, K, L, acti)] = value;
+        if (!transition)
+            ret[tpdm_packed_index(J, I, L, K, acti)] = value;
+    }, bra, ket);
+}
+
 //////////////////////////////////////////////////
 // Super interface to manage total spin
 //////////////////////////////////////////////////
@@ -444,6 +505,23 @@ void DmrgInterface::tpdm(double** ret, int bra, int ket)
     iface_[bra_sn.first].tpdm(ret, bra_sn.second, ket_sn.second);
 }
 
+void DmrgInterface::opdm_packed(double* ret, int state)
+{
+    auto sn = state_to_s_n(state);
+    iface_[sn.first].opdm_packed(ret, sn.second);
+}
+
+void DmrgInterface::tpdm_packed(double* ret, int bra, int ket)
+{
+    auto bra_sn = state_to_s_n(bra);
+    auto ket_sn = state_to_s_n(ket);
+
+    // if bra and ket have different spin
+    if (bra_sn.first != ket_sn.first) return;
+
+    iface_[bra_sn.first].tpdm_packed(ret, bra_sn.second, ket_sn.second);
+}
+
 double DmrgInterface::energy(int state)
 {
     auto sn = state_to_s_n(state);
@@ -36,6 +36,8 @@
 #include <stdexcept>
 #include <utility>
 #include <tuple>
+#include <functional>
+#include <cstddef>
 
 
 
@@ -91,10 +93,30 @@ public:
     void opdm(double **Gij, int bra=0, int ket=0);
     void tpdm(double **Gijkl, int bra=0, int ket=0);
 
+    // In-memory RDMs: the elements go straight from the measurement to the caller,
+    // without the result file, label vectors or full L^2 / L^4 arrays.
+
+    /// Calls f(i, j, Gij) once per measured element, i <= j unless bra != ket
+    void opdm(std::function<void(int, int, double)> const & f, int bra=0, int ket=0);
+    /// Calls f(i, j, k, l, Gijkl) once per measured element, in the index order of tpdm(double**)
+    void tpdm(std::function<void(int, int, int, int, double)> const & f, int bra=0, int ket=0);
+
+    /// Writes the state's 1-RDM into Gij[opdm_packed_index(i,j)], L(L+1)/2 elements
+    void opdm_packed(double *Gij, int state=0);
+    /// Writes the (transition) 2-RDM into Gijkl[tpdm_packed_index(i,j,k,l,L)], L^2(L^2+1)/2 elements
+    void tpdm_packed(double *Gijkl, int bra=0, int ket=0);
+
+    static std::size_t opdm_packed_index(int i, int j);
+    /// Lower triangle over the pair indices ij and kl, Gijkl == Gklij
+    static std::size_t tpdm_packed_index(int i, int j, int k, int l, int L);
+
     double energy(int state);
 
 private:
 
+    void stream_rdm(std::string const & name, int bra, int ket,
+                    std::function<void(std::vector<int> const &, double)> const & visit);
+
     void set_threads();
     void restore_threads();
 
@@ -124,6 +146,9 @@ public:
     void opdm(double **Gij, int bra=0, int ket=0);
     void tpdm(double **Gijkl, int bra=0, int ket=0);
 
+    void opdm_packed(double *Gij, int state=0);
+    void tpdm_packed(double *Gijkl, int bra=0, int ket=0);
+
     double energy(int state);
 
 private:
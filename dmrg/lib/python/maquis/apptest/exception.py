@@ -34,3 +34,11 @@ class ObservableNotMatch(TestFailed):
         self.tol  = float(tol)
     def __str__(self):
         return 'Observable `%s` does not match. `%s` more than %s different compared to %s.' % (self.obs, self.tval, self.tol, self.rval)
+
+class ObservableBelowMinimum(TestFailed):
+    def __init__(self, obs, tval, minval):
+        self.obs    = str(obs)
+        self.tval   = float(tval)
+        self.minval = float(minval)
+    def __str__(self):
+        return 'Observable `%s` reaches at most %s, expected at least %s.' % (self.obs, self.tval, self.minval)
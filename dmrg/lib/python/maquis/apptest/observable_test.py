@@ -12,6 +12,7 @@ from maquis.fileio import loadEigenstateMeasurements, loadDmrgSweeps, flatten, D
 
 from .exception import ObservableNotFound
 from .exception import ObservableNotMatch
+from .exception import ObservableBelowMinimum
 
 def load_spectrum_observable(fname, observable, remove_equal_indexes=False):
     if not os.path.exists(fname):
@@ -63,7 +64,7 @@ def load_iterations_observable(fname, observable, remove_equal_indexes=False):
         raise IOError('Archive `%s` not found.' % fname)
     if remove_equal_indexes:
         print('WARNING:', 'removing index not implemented for iterations meas.')
-    data = LoadDMRGSweeps([fname], [observable])
+    data = loadDmrgSweeps([fname], [observable])
     obs = collectXY(data, 'sweep', observable)
     obs = flatten(obs)
     if len(obs) == 0:
@@ -119,3 +120,22 @@ class reference_value(object):
     def __str__(self):
         return 'Reference value for `%s`' % self.observable
 
+class minimum_value(object):
+    def __init__(self, observable, value, load_type='iterations'):
+        self.observable = str(observable)
+        self.value      = float(value)
+        if load_type == 'spectrum':
+            self.loader = load_spectrum_observable
+        elif load_type == 'iterations':
+            self.loader = load_iterations_observable
+        else:
+            raise RuntimeError('`%s` not a valid type.' % load_type)
+    
+    def __call__(self, test_file):
+        obs = self.loader(test_file, self.observable)
+        tmax = max(np.max(y) for y in obs.y)
+        if tmax < self.value:
+            raise ObservableBelowMinimum(self.observable, tmax, self.value)
+    
+    def __str__(self):
+        return 'Minimum value for `%s`' % self.observable
@@ -9,6 +9,7 @@
 import sys,os
 from os.path import expanduser
 import tempfile
+import shlex
 import shutil
 from datetime import datetime as dt
 import subprocess
@@ -90,9 +91,10 @@ class DMRGTestBase(object):
         remove_if_exists( self.testname+'.out.log'           )
         remove_if_exists( self.testname+'.out.meas.log'      )
         
-        ## Execute DMRG app
+        ## Execute DMRG app, optionally through a launcher such as `mpirun -np 2`
         if dmrg_app is not None:
-            cmd = [expanduser(dmrg_app), self.testname+'.parms', self.testname+'.model']
+            launcher = shlex.split(os.environ.get('MAQUIS_APPTEST_LAUNCHER', ''))
+            cmd = launcher + [expanduser(dmrg_app), self.testname+'.parms', self.testname+'.model']
             exec_with_log(cmd, self.testname+'.out')
         
         ## Execute measure app
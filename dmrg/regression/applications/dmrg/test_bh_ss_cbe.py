@@ -0,0 +1,70 @@
+#!/usr/bin/env python
+
+import sys
+
+from maquis import apptest
+import sys, os
+
+testname       = os.path.splitext( os.path.basename(sys.argv[0]) )[0]
+
+class mytest(apptest.DMRGTestBase):
+    testname = testname
+    
+    inputs   = {
+                'parms': {
+                            'nsweeps'                    : 5,
+                            'nmainsweeps'                : 1,
+                            'ngrowsweeps'                : 1,
+                            
+                            'init_bond_dimension'        : 5,
+                            'max_bond_dimension'         : 200,
+                            
+                            'truncation_final'           : 1e-10,
+                            
+                            'resultfile'                 : testname+'.out.h5',
+                            'chkpfile'                   : testname+'.out.ckp.h5',
+                            
+                            'optimization'               : 'singlesite',
+                            'singlesite_expansion'       : 'cbe',
+                            'cbe_fraction'               : 0.1,
+                            'symmetry'                   : 'u1',
+                          },
+                'model': {
+                            'model_library'             : 'alps',
+                            'lattice_library'           : 'alps',
+                            'LATTICE'                   : 'open chain lattice',
+                            'L'                         : 10,
+                            
+                            'MODEL'                     : 'boson Hubbard',
+                            'Nmax'                      : 2,
+                            't'                         : 1,
+                            'U'                         : 8,
+                            
+                            'CONSERVED_QUANTUMNUMBERS'  : 'N',
+                            'N_total'                   : 5,
+                            
+                            'MEASURE_LOCAL[Local density]' : 'n',
+                            'MEASURE[Entropy]'      : 1,
+                          },
+                  }
+    # without expansion the single-site sweeps keep the 5 initial states, cbe has to grow the bonds
+    observables = [
+                    apptest.observable_test.reference_value('Energy',        value=-6.881090360639349,
+                                                            tolerance=1e-7),
+                    apptest.observable_test.reference_value('Local density', value=[0.39303194698174188,
+                                                                                    0.54302419722113426,
+                                                                                    0.51400554735345949,
+                                                                                    0.52780042423515783,
+                                                                                    0.5221378842084331,
+                                                                                    0.52213788420366136,
+                                                                                    0.52780042424107332,
+                                                                                    0.5140055473576155,
+                                                                                    0.54302419721735529,
+                                                                                    0.39303194698034677],
+                                                            tolerance=1e-5),
+                    apptest.observable_test.minimum_value('BondDimension', value=6),
+                  ]
+
+
+if __name__ == '__main__':
+    apptest.main()
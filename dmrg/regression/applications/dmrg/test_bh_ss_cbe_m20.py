@@ -0,0 +1,56 @@
+#!/usr/bin/env python
+
+import sys
+
+from maquis import apptest
+import sys, os
+
+testname       = os.path.splitext( os.path.basename(sys.argv[0]) )[0]
+
+class mytest(apptest.DMRGTestBase):
+    testname = testname
+    
+    inputs   = {
+                'parms': {
+                            'nsweeps'                    : 5,
+                            'nmainsweeps'                : 1,
+                            'ngrowsweeps'                : 1,
+                            
+                            'init_bond_dimension'        : 5,
+                            'max_bond_dimension'         : 20,
+                            
+                            'truncation_final'           : 1e-10,
+                            
+                            'resultfile'                 : testname+'.out.h5',
+                            'chkpfile'                   : testname+'.out.ckp.h5',
+                            
+                            'optimization'               : 'singlesite',
+                            'singlesite_expansion'       : 'cbe',
+                            'cbe_fraction'               : 0.1,
+                            'symmetry'                   : 'u1',
+                          },
+                'model': {
+                            'model_library'             : 'alps',
+                            'lattice_library'           : 'alps',
+                            'LATTICE'                   : 'open chain lattice',
+                            'L'                         : 10,
+                            
+                            'MODEL'                     : 'boson Hubbard',
+                            'Nmax'                      : 2,
+                            't'                         : 1,
+                            'U'                         : 8,
+                            
+                            'CONSERVED_QUANTUMNUMBERS'  : 'N',
+                            'N_total'                   : 5,
+                          },
+                  }
+    # the middle bonds saturate at 20 states, the truncated energy is within 1e-6 of the exact one
+    observables = [
+                    apptest.observable_test.reference_value('Energy',        value=-6.881090360639349,
+                                                            tolerance=1e-6),
+                    apptest.observable_test.minimum_value('BondDimension', value=20),
+                  ]
+
+
+if __name__ == '__main__':
+    apptest.main()
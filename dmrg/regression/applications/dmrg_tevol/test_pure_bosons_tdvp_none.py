@@ -0,0 +1,65 @@
+#!/usr/bin/env python
+
+from maquis import apptest
+import sys, os
+
+testname       = os.path.splitext( os.path.basename(sys.argv[0]) )[0]
+reference_dir  = os.path.join( os.path.dirname(os.path.abspath(__file__)), 'ref/' )
+
+# real time TDVP with real arithmetic, against the exact diagonalization of test_pure_bosons_none
+parms = {
+            'nsweeps_img'                : 0,
+            'nsweeps'                    : 50,
+            
+            'max_bond_dimension'         : 100,
+            
+            'truncation_final'           : 1e-10,
+            
+            'dt'                         : 0.1,
+            'te_type'                    : 'tdvp',
+            'tdvp_krylov_tol'            : 1e-12,
+            
+            'measure_each'               : 10,
+            'chkp_each'                  : 50,
+            
+            'resultfile'                 : testname+'.out.h5',
+            'chkpfile'                   : testname+'.out.ckp.h5',
+            
+            'init_state'                 : 'basis_state',
+            'init_basis_state'           : '0,1,0',
+            
+            'ALWAYS_MEASURE'             : 'Local density',
+            
+            'symmetry'                   : 'none',
+            'model_library'              : 'coded',
+            
+            'COMPLEX'                    : 0,
+        }
+
+model = {
+            'LATTICE'                   : 'open chain lattice',
+            'L'                         : 3,
+            
+            'MODEL'                     : 'boson Hubbard',
+            'Nmax'                      : 3,
+            't'                         : 1,
+            'U'                         : 1,
+            
+            'MEASURE[Local density]' : 1,
+        }
+
+class mytest_twosite(apptest.DMRGTestBase):
+    testname = testname + '_twosite'
+    
+    inputs   = {
+                'parms': dict(parms, optimization='twosite'),
+                'model': model,
+                  }
+    observables = [
+                    apptest.observable_test.reference_file('Local density', load_type = 'iterations', tolerance=0.01,
+                                                           file=os.path.join(reference_dir, 'pure_bosons.diag.h5')),
+                  ]
+
+
+if __name__ == '__main__':
+    apptest.main()
@@ -0,0 +1,281 @@
+/*****************************************************************************
+ *
+ * ALPS MPS DMRG Project
+ *
+ * Copyright (C) 2014 Institute for Theoretical Physics, ETH Zurich
+ *               2011-2013 by Michele Dolfi <dolfim@phys.ethz.ch>
+ *                            Bela Bauer <bauerb@comp-phys.org>
+ * 
+ * This software is part of the ALPS Applications, published under the ALPS
+ * Application License; you can use, redistribute it and/or modify it under
+ * the terms of the license, either version 1 or (at your option) any later
+ * version.
+ * 
+ * You should have received a copy of the ALPS Application License along with
+ * the ALPS Applications; see the file LICENSE.txt. If not, the license is also
+ * available from http://alps.comp-phys.org/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT 
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE 
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE, 
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER 
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+// Self-contained CPU benchmark of the contraction kernels.
+//
+// The MPS is random (init_state = default), the Hamiltonian is a boson Hubbard
+// model for U1 and a quantum chemistry model with random integrals otherwise,
+// so no checkpoint, integral file or dumped boundaries are needed.
+// Parameters are given as key=value arguments, e.g.
+//
+//     kernels_2u1 L=12 max_bond_dimension=512 bench_threads=1,2,4,8
+//
+// M is max_bond_dimension, the physical dimension is Nmax+1 for U1, the MPO
+// bond dimension grows with W (U1) or bench_integral_density (chemistry).
+// One JSON object per kernel and thread count is written to bench_output.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+#include <memory>
+
+#ifdef MAQUIS_OPENMP
+#include <omp.h>
+#endif
+
+#include "matrix_selector.hpp" /// define matrix
+#include "symm_selector.hpp"   /// define grp
+
+#include "dmrg/models/lattice.h"
+#include "dmrg/models/model.h"
+#include "dmrg/models/generate_mpo.hpp"
+
+#include "dmrg/mp_tensors/mps.h"
+#include "dmrg/mp_tensors/twositetensor.h"
+#include "dmrg/mp_tensors/contractions.h"
+
+#include "dmrg/optimize/solver_interface.hpp"
+
+#include "dmrg/utils/DmrgParameters.h"
+#include "dmrg/utils/storage.h"
+#include "dmrg/utils/random.hpp"
+
+#include "../tests/random_integrals.h"
+
+typedef maquis::traits::aligned_matrix<matrix, maquis::aligned_allocator, ALIGNMENT>::type amatrix_t;
+typedef storage::constrained<amatrix_t>::type bmatrix;
+typedef contraction::Engine<matrix, bmatrix, grp> contr;
+typedef alps::numeric::associated_real_diagonal_matrix<matrix>::type dmt;
+
+void set_default(DmrgParameters & parms, std::string const & key, std::string const & value)
+{
+    if (!parms.is_set(key)) parms.set(key, value);
+}
+
+void complete_parameters(DmrgParameters & parms)
+{
+    set_default(parms, "max_bond_dimension", "256");
+    set_default(parms, "bench_threads", "0"); // 0: the default OpenMP thread count
+    set_default(parms, "bench_repeat", "3");
+    set_default(parms, "bench_output", "kernels.json");
+    set_default(parms, "bench_integral_density", "1.0");
+    set_default(parms, "donotsave", "1");
+    parms.set("init_state", "default");
+    parms.set("init_bond_dimension", parms["max_bond_dimension"].str());
+
+    if (std::is_same<grp, U1>::value) {
+        set_default(parms, "MODEL", "boson Hubbard");
+        set_default(parms, "LATTICE", "open square lattice");
+        set_default(parms, "L", "8");
+        set_default(parms, "W", "2");
+        set_default(parms, "Nmax", "2");
+        set_default(parms, "t", "1");
+        set_default(parms, "U", "4");
+        set_default(parms, "u1_total_charge", std::to_string(int(parms["L"]) * int(parms["W"]) / 2));
+    }
+    else {
+        set_default(parms, "MODEL", "quantum_chemistry");
+        set_default(parms, "LATTICE", "orbitals");
+        set_default(parms, "L", "12");
+        int L = parms["L"];
+        set_default(parms, "nelec", std::to_string(L));
+        set_default(parms, "spin", "0");
+        set_default(parms, "irrep", "0");
+        set_default(parms, "u1_total_charge1", std::to_string(L / 2));
+        set_default(parms, "u1_total_charge2", std::to_string(L - L / 2));
+        if (!parms.is_set("site_types")) {
+            std::string types;
+            for (int p = 0; p < L; ++p) types += (p ? ",0" : "0");
+            parms.set("site_types", types);
+        }
+        if (!parms.is_set("integral_file") && !parms.is_set("integrals"))
+            parms.set("integrals", random_integrals(L, parms["seed"], parms["bench_integral_density"]));
+    }
+}
+
+// best wall time of repeat calls
+template <class F>
+double time_best(F f, int repeat)
+{
+    double best = std::numeric_limits<double>::max();
+    for (int r = 0; r < repeat; ++r) {
+        std::chrono::high_resolution_clock::time_point t0 = std::chrono::high_resolution_clock::now();
+        f();
+        std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+        best = std::min(best, std::chrono::duration<double>(t1 - t0).count());
+    }
+    return best;
+}
+
+struct reporter
+{
+    std::ostream & os;
+    std::string context;
+
+    // flops and bytes are per call, 0 if not known; bytes is the compulsory traffic
+    // (operands read once, result written once), so GB/s is a lower bound
+    void operator()(std::string const & kernel, int threads, double seconds, double flops, double bytes)
+    {
+        std::ostringstream line;
+        line << "{\"kernel\": \"" << kernel << "\", " << context << ", \"threads\": " << threads
+             << ", \"seconds\": " << seconds;
+        if (flops > 0) line << ", \"flops\": " << flops << ", \"gflops\": " << flops / seconds / 1e9;
+        else           line << ", \"flops\": null, \"gflops\": null";
+        if (bytes > 0) line << ", \"bytes\": " << bytes << ", \"gbytes_per_s\": " << bytes / seconds / 1e9;
+        else           line << ", \"bytes\": null, \"gbytes_per_s\": null";
+        line << "}";
+
+        os << line.str() << std::endl;
+        maquis::cout << line.str() << std::endl;
+    }
+};
+
+int main(int argc, char ** argv)
+{
+    try {
+        DmrgParameters parms;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg(argv[i]);
+            std::size_t eq = arg.find('=');
+            if (eq == std::string::npos)
+                throw std::runtime_error("arguments are key=value, got " + arg);
+            parms.set(arg.substr(0, eq), arg.substr(eq + 1));
+        }
+        complete_parameters(parms);
+        dmrg_random::engine.seed(parms["seed"]);
+
+        std::size_t Mmax = parms["max_bond_dimension"];
+        int repeat = parms["bench_repeat"];
+        double alpha = 1e-3;
+        double cutoff = 1e-16;
+        std::vector<int> thread_counts = parms["bench_threads"].as<std::vector<int> >();
+
+        Lattice lattice(parms);
+        Model<matrix, grp> model(lattice, parms);
+        MPO<matrix, grp> mpo = make_mpo(lattice, model);
+
+        int L = lattice.size();
+        MPS<matrix, grp> mps(L, *(model.initializer(lattice, parms)));
+
+        // two-site problem on the middle bond
+        int site = L / 2 - 1;
+        mps.canonize(site);
+
+        std::vector<Boundary<bmatrix, grp> > left(L + 1), right(L + 1);
+        left[0] = mps.left_boundary();
+        for (int i = 0; i < site + 1; ++i)
+            left[i + 1] = contr::overlap_mpo_left_step(mps[i], mps[i], left[i], mpo[i], true);
+        right[L] = mps.right_boundary();
+        for (int i = L - 1; i > site; --i)
+            right[i] = contr::overlap_mpo_right_step(mps[i], mps[i], right[i + 1], mpo[i]);
+
+        MPO<matrix, grp> ts_mpo;
+        make_ts_cache_mpo(mpo, ts_mpo, mps);
+
+        TwoSiteTensor<matrix, grp> tst(mps[site], mps[site + 1]);
+        MPSTensor<matrix, grp> twin_mps = tst.make_mps();
+
+        std::ostringstream context;
+        context << "\"symmetry\": \"" << grp_name << "\", \"L\": " << L << ", \"M\": " << Mmax
+                << ", \"site_dim\": " << mps[site].site_dim().sum_of_sizes()
+                << ", \"mpo_dim\": " << mpo[site].col_dim()
+                << ", \"bond_dim\": " << mps[site].col_dim().sum_of_sizes();
+
+        std::ofstream out(parms["bench_output"].str().c_str());
+        reporter report = { out, context.str() };
+
+        for (int threads : thread_counts)
+        {
+            #ifdef MAQUIS_OPENMP
+            if (threads > 0) omp_set_num_threads(threads);
+            threads = omp_get_max_threads();
+            #else
+            threads = 1;
+            #endif
+
+            double t, bytes;
+
+            Boundary<bmatrix, grp> lstep, rstep;
+            t = time_best([&]() { lstep = contr::overlap_mpo_left_step(mps[site], mps[site], left[site], mpo[site], true); },
+                          repeat);
+            bytes = size_of(left[site]) + size_of(lstep) + 2. * size_of(mps[site]);
+            report("overlap_mpo_left_step", threads, t, 0, bytes);
+
+            t = time_best([&]() { rstep = contr::overlap_mpo_right_step(mps[site + 1], mps[site + 1], right[site + 2], mpo[site + 1]); },
+                          repeat);
+            bytes = size_of(right[site + 2]) + size_of(rstep) + 2. * size_of(mps[site + 1]);
+            report("overlap_mpo_right_step", threads, t, 0, bytes);
+
+            // the schedule is move-only, each repetition replaces the previous one
+            std::unique_ptr<contr::schedule_t> sched;
+            t = time_best([&]() {
+                if (sched) sched->mps_stage.deallocate();
+                sched.reset(new contr::schedule_t(contraction::common::create_contraction_schedule(
+                                twin_mps, left[site], right[site + 2], ts_mpo[site], 0.)));
+            }, repeat);
+            report("create_contraction_schedule", threads, t, 0, 0);
+
+            {
+                SuperHamil<double> SH(make_bview(left[site]), make_bview(right[site + 2]), *sched);
+                twin_mps.make_right_paired();
+                DavidsonVector<double> x(twin_mps.data().data_view(), twin_mps.data().basis().sizes());
+                DavidsonVector<double> y(x);
+
+                t = time_best([&]() { y = site_hamil_mv(x, SH); }, repeat);
+                bytes = size_of(left[site]) + size_of(right[site + 2]) + 2. * size_of(twin_mps);
+                report("super_hamil_mv", threads, t, sched->total_flops, bytes);
+            }
+            sched->mps_stage.deallocate();
+
+            MPSTensor<matrix, grp> m1, m2;
+            truncation_results trunc;
+            t = time_best([&]() { boost::tie(m1, m2, trunc) = contr::predict_split_l2r(tst, Mmax, cutoff, alpha, left[site], mpo[site]); },
+                          repeat);
+            report("predict_split_l2r", threads, t, 0, 2. * size_of(tst.data()) + size_of(m1) + size_of(m2));
+
+            t = time_best([&]() { boost::tie(m1, m2, trunc) = contr::predict_split_r2l(tst, Mmax, cutoff, alpha, right[site + 2], mpo[site + 1]); },
+                          repeat);
+            report("predict_split_r2l", threads, t, 0, 2. * size_of(tst.data()) + size_of(m1) + size_of(m2));
+
+            tst.make_both_paired();
+            block_matrix<matrix, grp> u, v;
+            block_matrix<dmt, grp> s;
+            t = time_best([&]() { svd_truncate(tst.data(), u, v, s, cutoff, Mmax, false); }, repeat);
+            report("svd_truncate", threads, t, 0, size_of(tst.data()) + size_of(u) + size_of(v));
+        }
+
+    } catch (std::exception & e) {
+        maquis::cerr << "Exception caught:" << std::endl << e.what() << std::endl;
+        exit(1);
+    }
+}
@@ -31,11 +31,19 @@
 
 #ifdef USE_TWOU1
 typedef TwoU1 grp;
+static const char grp_name[] = "TwoU1";
+#else
+#ifdef USE_SU2U1
+typedef SU2U1 grp;
+static const char grp_name[] = "SU2U1";
 #else
 #ifdef USE_NONE
 typedef TrivialGroup grp;
+static const char grp_name[] = "none";
 #else
 typedef U1 grp;
+static const char grp_name[] = "U1";
+#endif
 #endif
 #endif
 
@@ -0,0 +1,170 @@
+/*****************************************************************************
+ *
+ * ALPS MPS DMRG Project
+ *
+ * Copyright (C) 2014 Institute for Theoretical Physics, ETH Zurich
+ *
+ * This software is part of the ALPS Applications, published under the ALPS
+ * Application License; you can use, redistribute it and/or modify it under
+ * the terms of the license, either version 1 or (at your option) any later
+ * version.
+ *
+ * You should have received a copy of the ALPS Application License along with
+ * the ALPS Applications; see the file LICENSE.txt. If not, the license is also
+ * available from http://alps.comp-phys.org/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+// Checks the hashed Index / DualIndex lookups against a plain binary search
+// and reports the time per lookup for both.
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+
+#include "dmrg/block_matrix/indexing.h"
+#include "dmrg/block_matrix/symmetry.h"
+
+template <class Charge>
+Charge make_charge(int n, int s, int irrep)
+{
+    Charge c;
+    c[0] = n; c[1] = s; c[2] = irrep;
+    return c;
+}
+
+template <>
+int make_charge<int>(int n, int s, int irrep) { return 64 * n + 8 * s + irrep; }
+
+template <class SymmGroup>
+std::vector<typename SymmGroup::charge> make_charges(int nmax)
+{
+    std::vector<typename SymmGroup::charge> ret;
+    for (int n = 0; n < nmax; ++n)
+        for (int s = 0; s < 4; ++s)
+            for (int irrep = 0; irrep < 8; ++irrep)
+                ret.push_back(make_charge<typename SymmGroup::charge>(n, s, irrep));
+    return ret;
+}
+
+template <class SymmGroup>
+std::size_t reference_position(Index<SymmGroup> const & idx, typename SymmGroup::charge c)
+{
+    typename Index<SymmGroup>::const_iterator match
+        = std::lower_bound(idx.begin(), idx.end(), std::make_pair(c, 0), index_detail::gt<SymmGroup>());
+    if (match != idx.end() && match->first != c) match = idx.end();
+    return match - idx.begin();
+}
+
+template <class SymmGroup>
+std::size_t reference_position(DualIndex<SymmGroup> const & idx, typename SymmGroup::charge r,
+                               typename SymmGroup::charge c)
+{
+    typedef typename DualIndex<SymmGroup>::value_type value_type;
+    typename DualIndex<SymmGroup>::const_iterator match
+        = std::lower_bound(idx.begin(), idx.end(), value_type(r, c, 0, 0), dual_index_detail::gt<SymmGroup>());
+    if (match != idx.end() && (match->lc != r || match->rc != c)) match = idx.end();
+    return match - idx.begin();
+}
+
+template <class F>
+double time_per_call(F f, std::size_t calls)
+{
+    std::chrono::high_resolution_clock::time_point t0 = std::chrono::high_resolution_clock::now();
+    f();
+    std::chrono::high_resolution_clock::time_point t1 = std::chrono::high_resolution_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / calls;
+}
+
+template <class SymmGroup>
+bool run(std::string const & name, int nmax, int repeat)
+{
+    typedef typename SymmGroup::charge charge;
+
+    std::vector<charge> charges = make_charges<SymmGroup>(nmax);
+
+    Index<SymmGroup> idx;
+    for (std::size_t k = 0; k < charges.size(); k += 2)
+        idx.insert(std::make_pair(charges[k], k));
+
+    DualIndex<SymmGroup> didx;
+    for (std::size_t k = 0; k < charges.size(); k += 2)
+        for (std::size_t l = k % 7; l < charges.size(); l += 7)
+            didx.insert(typename DualIndex<SymmGroup>::value_type(charges[k], charges[l], 1, 1));
+
+    Index<SymmGroup> const & cidx = idx;
+    DualIndex<SymmGroup> const & cdidx = didx;
+
+    // every charge is probed, half of them are absent from the index
+    for (std::size_t k = 0; k < charges.size(); ++k)
+        if (cidx.position(charges[k]) != reference_position(cidx, charges[k])
+            || cidx.has(charges[k]) != (k % 2 == 0)) {
+            std::cout << name << ": Index lookup mismatch for " << charges[k] << std::endl;
+            return false;
+        }
+    for (std::size_t k = 0; k < charges.size(); ++k)
+        for (std::size_t l = 0; l < charges.size(); l += 3)
+            if (cdidx.position(charges[k], charges[l]) != reference_position(cdidx, charges[k], charges[l])) {
+                std::cout << name << ": DualIndex lookup mismatch for " << charges[k] << charges[l] << std::endl;
+                return false;
+            }
+
+    std::size_t sink = 0, calls = repeat * charges.size();
+    double t_old = time_per_call([&]() { for (int i = 0; i < repeat; ++i)
+                                             for (std::size_t k = 0; k < charges.size(); ++k)
+                                                 sink += reference_position(cidx, charges[k]); }, calls);
+    double t_new = time_per_call([&]() { for (int i = 0; i < repeat; ++i)
+                                             for (std::size_t k = 0; k < charges.size(); ++k)
+                                                 sink += cidx.position(charges[k]); }, calls);
+    std::cout << name << " Index(" << idx.size() << "): binary search " << t_old << " ns, hashed "
+              << t_new << " ns" << std::endl;
+
+    calls = repeat * charges.size();
+    t_old = time_per_call([&]() { for (int i = 0; i < repeat; ++i)
+                                      for (std::size_t k = 0; k < charges.size(); ++k)
+                                          sink += reference_position(cdidx, charges[k], charges[(7*k) % charges.size()]); }, calls);
+    t_new = time_per_call([&]() { for (int i = 0; i < repeat; ++i)
+                                      for (std::size_t k = 0; k < charges.size(); ++k)
+                                          sink += cdidx.position(charges[k], charges[(7*k) % charges.size()]); }, calls);
+    std::cout << name << " DualIndex(" << didx.size() << "): binary search " << t_old << " ns, hashed "
+              << t_new << " ns" << (sink == 0 ? " " : "") << std::endl;
+
+    // the table must follow mutations
+    idx.insert(std::make_pair(charges[1], 1));
+    if (cidx.position(charges[1]) != reference_position(cidx, charges[1])
+        || cidx.position(charges[0]) != reference_position(cidx, charges[0])) {
+        std::cout << name << ": stale Index lookup after insert" << std::endl;
+        return false;
+    }
+
+    // moving takes the table along, the moved-from index is empty
+    Index<SymmGroup> moved(std::move(idx));
+    idx = Index<SymmGroup>();
+    for (std::size_t k = 0; k < charges.size(); ++k)
+        if (moved.position(charges[k]) != reference_position(moved, charges[k]) || cidx.has(charges[k])) {
+            std::cout << name << ": Index lookup mismatch after move for " << charges[k] << std::endl;
+            return false;
+        }
+    return true;
+}
+
+int main(int argc, char ** argv)
+{
+    int repeat = (argc > 1) ? std::atoi(argv[1]) : 200;
+
+    bool ok = run<U1>("U1", 1, repeat)
+           && run<U1>("U1", 16, repeat)
+           && run<TwoU1PG>("TwoU1PG", 16, repeat)
+           && run<SU2U1PG>("SU2U1PG", 16, repeat);
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,99 @@
+/*****************************************************************************
+ *
+ * ALPS MPS DMRG Project
+ *
+ * Copyright (C) 2014 Institute for Theoretical Physics, ETH Zurich
+ *
+ * This software is part of the ALPS Applications, published under the ALPS
+ * Application License; you can use, redistribute it and/or modify it under
+ * the terms of the license, either version 1 or (at your option) any later
+ * version.
+ *
+ * You should have received a copy of the ALPS Application License along with
+ * the ALPS Applications; see the file LICENSE.txt. If not, the license is also
+ * available from http://alps.comp-phys.org/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#define BOOST_TEST_MAIN
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "cpp_maquis.h"
+
+#include "../random_integrals.h"
+
+/// Ground state of a small active space, measured once through the full and once through the packed RDM calls
+struct PackedRDMFixture
+{
+    PackedRDMFixture() : L(4)
+    {
+        std::map<std::string, std::string> input;
+        input["symmetry"]           = "su2u1";
+        input["LATTICE"]            = "orbitals";
+        input["MODEL"]              = "quantum_chemistry";
+        input["L"]                  = std::to_string(L);
+        input["nelec"]              = std::to_string(L);
+        input["irrep"]              = "0";
+        input["site_types"]         = "0,0,0,0";
+        input["integrals"]          = random_integrals(L, 5);
+        input["max_bond_dimension"] = "16";
+        input["nsweeps"]            = "2";
+        input["chkpfile"]           = "packed_rdm.checkpoint.h5";
+        input["resultfile"]         = "packed_rdm.results.h5";
+        input["MEASURE[1rdm]"]      = "1";
+        input["MEASURE[2rdm]"]      = "1";
+
+        iface = DmrgInterface(input, 1, 0, 0, 0, 0, 0, 0);
+        iface.calc_states();
+    }
+
+    int L;
+    DmrgInterface iface;
+};
+
+BOOST_FIXTURE_TEST_CASE( opdm_packed_matches_full, PackedRDMFixture )
+{
+    std::vector<double> full_data(L*L, 0.);
+    std::vector<double *> full(L);
+    for (int i = 0; i < L; ++i) full[i] = &full_data[i*L];
+    iface.opdm(&full[0]);
+
+    std::vector<double> packed(L*(L+1)/2, 0.);
+    iface.opdm_packed(&packed[0]);
+
+    for (int i = 0; i < L; ++i)
+    for (int j = 0; j < L; ++j)
+        BOOST_CHECK_EQUAL(full[i][j], packed[Interface::opdm_packed_index(i, j)]);
+}
+
+BOOST_FIXTURE_TEST_CASE( tpdm_packed_matches_full, PackedRDMFixture )
+{
+    int L2 = L*L;
+    std::vector<double> full_data(L2*L2, 0.);
+    std::vector<double *> full(L2);
+    for (int ij = 0; ij < L2; ++ij) full[ij] = &full_data[ij*L2];
+    iface.tpdm(&full[0]);
+
+    std::vector<double> packed(L2*(L2+1)/2, 0.);
+    iface.tpdm_packed(&packed[0]);
+
+    // every element of the full array, including the ones filled by symmetry
+    for (int i = 0; i < L; ++i)
+    for (int j = 0; j < L; ++j)
+    for (int k = 0; k < L; ++k)
+    for (int l = 0; l < L; ++l)
+        BOOST_CHECK_EQUAL(full[i*L+j][k*L+l], packed[Interface::tpdm_packed_index(i, j, k, l, L)]);
+}
@@ -0,0 +1,141 @@
+/*****************************************************************************
+ *
+ * ALPS MPS DMRG Project
+ *
+ * Copyright (C) 2014 Institute for Theoretical Physics, ETH Zurich
+ *
+ * This software is part of the ALPS Applications, published under the ALPS
+ * Application License; you can use, redistribute it and/or modify it under
+ * the terms of the license, either version 1 or (at your option) any later
+ * version.
+ *
+ * You should have received a copy of the ALPS Application License along with
+ * the ALPS Applications; see the file LICENSE.txt. If not, the license is also
+ * available from http://alps.comp-phys.org/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#define BOOST_TEST_MAIN
+
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+#include <boost/mpl/list.hpp>
+
+#include <iostream>
+
+#include "dmrg/block_matrix/detail/alps.hpp"
+
+#include "dmrg/utils/DmrgParameters.h"
+
+#include "dmrg/models/generate_mpo.hpp"
+#include "dmrg/models/lattice.h"
+#include "dmrg/models/model.h"
+
+#include "dmrg/mp_tensors/mps.h"
+#include "dmrg/mp_tensors/mps_mpo_ops.h"
+
+#include "../random_integrals.h"
+
+typedef alps::numeric::matrix<double> matrix;
+
+DmrgParameters chem_parms(int L)
+{
+    DmrgParameters p;
+    p.set("max_bond_dimension", 16);
+    p.set("LATTICE", "orbitals");
+    p.set("MODEL", "quantum_chemistry");
+    p.set("L", L);
+    p.set("nelec", L);
+    p.set("spin", 0);
+    p.set("irrep", 0);
+    p.set("u1_total_charge1", L/2);
+    p.set("u1_total_charge2", L - L/2);
+    std::string types;
+    for (int i = 0; i < L; ++i) types += (i ? ",0" : "0");
+    p.set("site_types", types);
+    p.set("integrals", random_integrals(L, 7));
+    return p;
+}
+
+struct TwoU1System {
+    static const bool chemistry = true;
+    typedef TwoU1 grp;
+    static DmrgParameters parms() { return chem_parms(6); }
+};
+
+struct SU2U1System {
+    static const bool chemistry = true;
+    typedef SU2U1 grp;
+    static DmrgParameters parms() { return chem_parms(6); }
+};
+
+struct U1System {
+    static const bool chemistry = false;
+    typedef U1 grp;
+    static DmrgParameters parms()
+    {
+        DmrgParameters p;
+        p.set("max_bond_dimension", 16);
+        p.set("LATTICE", "open square lattice");
+        p.set("L", 3);
+        p.set("W", 2);
+        p.set("MODEL", "boson Hubbard");
+        p.set("Nmax", 2);
+        p.set("t", 1.);
+        p.set("U", 4.);
+        p.set("u1_total_charge", 3);
+        return p;
+    }
+};
+
+typedef boost::mpl::list<TwoU1System, SU2U1System, U1System> test_systems;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE( bipartite_matches_tagged, ML, test_systems )
+{
+    typedef typename ML::grp grp;
+
+    DmrgParameters parms = ML::parms();
+    Lattice lat(parms);
+
+    parms.set("mpo_construction", "tagged");
+    Model<matrix, grp> model(lat, parms);
+    MPO<matrix, grp> tagged = make_mpo(lat, model, parms);
+
+    parms.set("mpo_construction", "bipartite");
+    Model<matrix, grp> model2(lat, parms);
+    MPO<matrix, grp> bipartite = make_mpo(lat, model2, parms);
+
+    MPS<matrix, grp> mps(lat.size(), *(model.initializer(lat, parms)));
+
+    BOOST_CHECK_CLOSE(tagged.getCoreEnergy(), bipartite.getCoreEnergy(), 1e-10);
+    BOOST_CHECK_CLOSE(maquis::real(expval(mps, tagged)), maquis::real(expval(mps, bipartite)), 1e-8);
+
+    BOOST_REQUIRE_EQUAL(tagged.length(), bipartite.length());
+    std::size_t tagged_sum = 0, bipartite_sum = 0;
+    for (std::size_t p = 0; p < lat.size(); ++p)
+    {
+        BOOST_CHECK(bipartite[p].col_dim() <= tagged[p].col_dim());
+        tagged_sum += tagged[p].col_dim();
+        bipartite_sum += bipartite[p].col_dim();
+
+        // the bipartite bonds have no hermitian partners, the tagged ones skip half of the paired blocks
+        std::size_t paired = 0;
+        for (std::size_t b = 0; b < tagged[p].col_dim(); ++b)
+            if (tagged[p].rightBond().conj().conj(b) < tagged[p].col_dim() && tagged[p].rightBond().conj().conj(b) != b)
+                ++paired;
+        BOOST_TEST_MESSAGE("bond " << p << ": tagged " << tagged[p].col_dim() << " (" << paired << " paired), bipartite "
+                           << bipartite[p].col_dim() << " (0 paired)");
+    }
+
+    // the dense integrals leave room below the key merging of TaggedMPOMaker
+    if (ML::chemistry)
+        BOOST_CHECK(bipartite_sum < tagged_sum);
+}
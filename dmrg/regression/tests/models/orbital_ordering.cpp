@@ -0,0 +1,127 @@
+/*****************************************************************************
+ *
+ * ALPS MPS DMRG Project
+ *
+ * Copyright (C) 2014 Institute for Theoretical Physics, ETH Zurich
+ *
+ * This software is part of the ALPS Applications, published under the ALPS
+ * Application License; you can use, redistribute it and/or modify it under
+ * the terms of the license, either version 1 or (at your option) any later
+ * version.
+ *
+ * You should have received a copy of the ALPS Application License along with
+ * the ALPS Applications; see the file LICENSE.txt. If not, the license is also
+ * available from http://alps.comp-phys.org/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#define BOOST_TEST_MAIN
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <cstring>
+#include <numeric>
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <iostream>
+
+#include "dmrg/block_matrix/detail/alps.hpp"
+
+#include "dmrg/utils/DmrgParameters.h"
+#include "dmrg/models/chem/orbital_ordering.h"
+
+using namespace chem::ordering_detail;
+
+// exchange integrals of a chain of orbitals hidden behind a permutation, on a weak uniform background,
+// in the packed binary format of the "integrals" parameter
+std::string chain_integrals(std::vector<int> const & chain)
+{
+    int L = chain.size();
+    std::vector<double> elements;
+    std::vector<int> indices;
+    auto add = [&](double v, int i, int j, int k, int l) {
+        elements.push_back(v);
+        indices.push_back(i); indices.push_back(j); indices.push_back(k); indices.push_back(l);
+    };
+
+    std::vector<double> K(L*L, 0.01);
+    for (int p = 0; p+1 < L; ++p)
+        K[chain[p]*L + chain[p+1]] = K[chain[p+1]*L + chain[p]] = 1.;
+
+    for (int i = 1; i <= L; ++i) {
+        add(1., i, i, i, i);
+        add(-2., i, i, 0, 0);
+        for (int j = 1; j < i; ++j) {
+            add(0.5, i, i, j, j);
+            add(K[(i-1)*L + j-1], i, j, j, i);
+        }
+    }
+    add(1., 0, 0, 0, 0);
+
+    std::string ret(elements.size() * sizeof(double) + indices.size() * sizeof(int), '\0');
+    std::memcpy(&ret[0], &elements[0], elements.size() * sizeof(double));
+    std::memcpy(&ret[elements.size() * sizeof(double)], &indices[0], indices.size() * sizeof(int));
+    return ret;
+}
+
+std::vector<int> parse_order(std::string const & s)
+{
+    std::vector<int> ret;
+    std::istringstream iss(s);
+    std::string tok;
+    while (std::getline(iss, tok, ','))
+        ret.push_back(std::stoi(tok) - 1);
+    return ret;
+}
+
+BOOST_AUTO_TEST_CASE( fiedler_ordering_lowers_cost )
+{
+    const int L = 10;
+    std::vector<int> chain(L);
+    std::iota(chain.begin(), chain.end(), 0);
+    std::shuffle(chain.begin(), chain.end(), std::mt19937(3));
+
+    DmrgParameters parms;
+    parms.set("L", L);
+    parms.set("integrals", chain_integrals(chain));
+    parms.set("orbital_ordering", "fiedler");
+
+    weight_matrix W = exchange_weights(parms, L);
+    std::vector<int> identity(L);
+    std::iota(identity.begin(), identity.end(), 0);
+
+    std::vector<int> order = parse_order(chem::optimize_orbital_order(parms));
+    BOOST_REQUIRE_EQUAL(order.size(), std::size_t(L));
+    BOOST_CHECK(std::is_permutation(order.begin(), order.end(), identity.begin()));
+
+    std::cout << "cost: " << cost(identity, W) << " (identity), " << cost(chain, W) << " (chain), "
+              << cost(order, W) << " (optimized)" << std::endl;
+    BOOST_CHECK_LT(cost(order, W), cost(identity, W));
+    BOOST_CHECK_LE(cost(order, W), cost(chain, W) + 1e-10);
+}
+
+BOOST_AUTO_TEST_CASE( refine_never_raises_cost )
+{
+    const int L = 8;
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> dist(0., 1.);
+    weight_matrix W(L, L, 0.);
+    for (int i = 0; i < L; ++i)
+        for (int j = 0; j < i; ++j)
+            W(i,j) = W(j,i) = dist(rng);
+
+    std::vector<int> order(L);
+    std::iota(order.begin(), order.end(), 0);
+    double before = cost(order, W);
+    refine(order, W, 10);
+    BOOST_CHECK_LE(cost(order, W), before);
+}
@@ -0,0 +1,161 @@
+/*****************************************************************************
+ *
+ * ALPS MPS DMRG Project
+ *
+ * Copyright (C) 2014 Institute for Theoretical Physics, ETH Zurich
+ *
+ * This software is part of the ALPS Applications, published under the ALPS
+ * Application License; you can use, redistribute it and/or modify it under
+ * the terms of the license, either version 1 or (at your option) any later
+ * version.
+ *
+ * You should have received a copy of the ALPS Application License along with
+ * the ALPS Applications; see the file LICENSE.txt. If not, the license is also
+ * available from http://alps.comp-phys.org/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#define BOOST_TEST_MAIN
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <set>
+#include <vector>
+#include <utility>
+
+#include "dmrg/block_matrix/detail/alps.hpp"
+
+#include "dmrg/optimize/boundary_residency.h"
+
+/// Stands in for a boundary, only its size matters to the residency
+struct mock_boundary
+{
+    mock_boundary() : bytes(1 << 20) {}
+    std::size_t bytes;
+};
+
+std::size_t size_of(mock_boundary const & b) { return b.bytes; }
+
+/// Records every storage call instead of moving data
+struct mock_transfer
+{
+    enum op_t { fetch_op, prefetch_op, pin_op, evict_op, drop_op };
+    typedef std::pair<op_t, mock_boundary const *> event;
+
+    static std::vector<event> & log() { static std::vector<event> l; return l; }
+
+    static void fetch(mock_boundary const & b)    { log().push_back(event(fetch_op, &b)); }
+    static void prefetch(mock_boundary const & b) { log().push_back(event(prefetch_op, &b)); }
+    static void pin(mock_boundary const & b)      { log().push_back(event(pin_op, &b)); }
+    static void evict(mock_boundary const & b)    { log().push_back(event(evict_op, &b)); }
+    static void drop(mock_boundary const & b)     { log().push_back(event(drop_op, &b)); }
+};
+
+typedef boundary_residency<mock_transfer, mock_boundary> residency_t;
+
+struct ResidencyFixture
+{
+    /// a budget of 3.5 boundaries: two in use, the prefetched one and one released
+    ResidencyFixture() : L(6), left(L+1), right(L+1), residency(left, right, 3.5, 1)
+    {
+        storage::disk::init("/tmp/");
+        mock_transfer::log().clear();
+    }
+
+    /// (side, index) of a boundary seen by the mock
+    std::pair<int, int> locate(mock_boundary const * b) const
+    {
+        if (b >= &left[0] && b < &left[0] + left.size())
+            return std::make_pair(int(residency_t::left_side), int(b - &left[0]));
+        return std::make_pair(int(residency_t::right_side), int(b - &right[0]));
+    }
+
+    /// one sweep with the calls of ss_optimize, the evictions of each direction in order
+    void sweep(std::vector<std::pair<int, int> > & evicted_l2r, std::vector<std::pair<int, int> > & evicted_r2l)
+    {
+        std::set<std::pair<int, int> > resident;
+        for (int _site = 0; _site < 2*L; ++_site) {
+            int lr = (_site < L) ? +1 : -1;
+            int site = (_site < L) ? _site : 2*L - 1 - _site;
+            std::size_t first = mock_transfer::log().size();
+
+            residency.move_to(site, lr);
+            residency.fetch(residency_t::left_side, site);
+            residency.fetch(residency_t::right_side, site+1);
+            if (lr == +1 && site+2 <= L) residency.prefetch(residency_t::right_side, site+2);
+            if (lr == -1 && site > 0)    residency.prefetch(residency_t::left_side, site-1);
+
+            if (lr == +1 && site != L-1) {
+                residency.drop(residency_t::right_side, site+1);
+                residency.release(residency_t::left_side, site);
+            }
+            if (lr == -1 && site > 0) {
+                residency.drop(residency_t::left_side, site);
+                residency.release(residency_t::right_side, site+1);
+            }
+
+            for (std::size_t k = first; k < mock_transfer::log().size(); ++k) {
+                mock_transfer::event const & e = mock_transfer::log()[k];
+                std::pair<int, int> b = locate(e.second);
+                if (e.first == mock_transfer::fetch_op || e.first == mock_transfer::prefetch_op)
+                    resident.insert(b);
+                else if (e.first == mock_transfer::drop_op)
+                    resident.erase(b);
+                else if (e.first == mock_transfer::evict_op) {
+                    // never the boundaries of the current step
+                    BOOST_CHECK(b != std::make_pair(int(residency_t::left_side), site));
+                    BOOST_CHECK(b != std::make_pair(int(residency_t::right_side), site+1));
+                    resident.erase(b);
+                    (lr == +1 ? evicted_l2r : evicted_r2l).push_back(b);
+                }
+            }
+
+            BOOST_CHECK(resident.size() * mock_boundary().bytes <= std::size_t(3.5 * 1024 * 1024));
+        }
+    }
+
+    int L;
+    std::vector<mock_boundary> left, right;
+    residency_t residency;
+};
+
+BOOST_FIXTURE_TEST_CASE( residency_evicts_farthest_boundary, ResidencyFixture )
+{
+    std::vector<std::pair<int, int> > evicted_l2r, evicted_r2l;
+    sweep(evicted_l2r, evicted_r2l);
+
+    // left to right, the released left boundaries are needed again in reverse order on the way
+    // back, so the oldest goes first; right to left the same holds for the right boundaries
+    BOOST_REQUIRE(!evicted_l2r.empty());
+    BOOST_REQUIRE(!evicted_r2l.empty());
+    for (std::size_t k = 0; k < evicted_l2r.size(); ++k) {
+        BOOST_CHECK_EQUAL(evicted_l2r[k].first, int(residency_t::left_side));
+        if (k > 0) BOOST_CHECK(evicted_l2r[k].second > evicted_l2r[k-1].second);
+    }
+    for (std::size_t k = 0; k < evicted_r2l.size(); ++k) {
+        BOOST_CHECK_EQUAL(evicted_r2l[k].first, int(residency_t::right_side));
+        if (k > 0) BOOST_CHECK(evicted_r2l[k].second < evicted_r2l[k-1].second);
+    }
+    BOOST_CHECK_EQUAL(evicted_l2r.front().second, 0);
+    BOOST_CHECK_EQUAL(evicted_r2l.front().second, L);
+}
+
+BOOST_FIXTURE_TEST_CASE( residency_without_budget_evicts_at_release, ResidencyFixture )
+{
+    residency_t unbudgeted(left, right, 0., 1);
+    unbudgeted.move_to(0, +1);
+    unbudgeted.fetch(residency_t::left_side, 0);
+    unbudgeted.release(residency_t::left_side, 0);
+
+    BOOST_REQUIRE_EQUAL(mock_transfer::log().size(), 2u);
+    BOOST_CHECK(mock_transfer::log()[0] == mock_transfer::event(mock_transfer::fetch_op, &left[0]));
+    BOOST_CHECK(mock_transfer::log()[1] == mock_transfer::event(mock_transfer::evict_op, &left[0]));
+}
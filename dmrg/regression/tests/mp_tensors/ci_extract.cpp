@@ -0,0 +1,166 @@
+/*****************************************************************************
+ *
+ * ALPS MPS DMRG Project
+ *
+ * Copyright (C) 2014 Institute for Theoretical Physics, ETH Zurich
+ *
+ * This software is part of the ALPS Applications, published under the ALPS
+ * Application License; you can use, redistribute it and/or modify it under
+ * the terms of the license, either version 1 or (at your option) any later
+ * version.
+ *
+ * You should have received a copy of the ALPS Application License along with
+ * the ALPS Applications; see the file LICENSE.txt. If not, the license is also
+ * available from http://alps.comp-phys.org/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#define BOOST_TEST_MAIN
+
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <random>
+#include <numeric>
+#include <algorithm>
+#include <iostream>
+
+#include "dmrg/block_matrix/detail/alps.hpp"
+
+#include "dmrg/utils/DmrgParameters.h"
+
+#include "dmrg/block_matrix/indexing.h"
+#include "dmrg/mp_tensors/mps.h"
+#include "dmrg/mp_tensors/mps_initializers.h"
+
+#include "../../../applications/tools/ci_encode.hpp"
+
+typedef TwoU1 SymmGroup;
+typedef SymmGroup::charge charge;
+typedef alps::numeric::matrix<double> matrix;
+
+charge make_charge(int up, int down)
+{
+    charge c;
+    c[0] = up;
+    c[1] = down;
+    return c;
+}
+
+/// Random spin orbital MPS and all determinants of its particle sector, in order of their index
+struct ExtractFixture
+{
+    ExtractFixture() : L(6)
+    {
+        phys.insert(std::make_pair(make_charge(1,1), 1));
+        phys.insert(std::make_pair(make_charge(1,0), 1));
+        phys.insert(std::make_pair(make_charge(0,1), 1));
+        phys.insert(std::make_pair(make_charge(0,0), 1));
+
+        charge total = make_charge(3,2);
+        DmrgParameters parms;
+        parms.set("init_bond_dimension", 8);
+        default_mps_init<matrix, SymmGroup> initializer(parms, std::vector<Index<SymmGroup> >(1, phys),
+                                                         total, std::vector<int>(L,0));
+        mps.resize(L);
+        initializer(mps);
+        mps.normalize_left();
+
+        std::size_t n = 1;
+        for (int p = 0; p < L; ++p) n *= phys.size();
+        for (std::size_t code = 0; code < n; ++code) {
+            std::vector<charge> det(L);
+            std::size_t c = code;
+            for (int p = 0; p < L; ++p, c /= phys.size())
+                det[p] = phys[c % phys.size()].first;
+            if (std::accumulate(det.begin(), det.end(), SymmGroup::IdentityCharge) == total)
+                dets.push_back(det);
+        }
+    }
+
+    int L;
+    Index<SymmGroup> phys;
+    MPS<matrix, SymmGroup> mps;
+    std::vector<std::vector<charge> > dets;
+};
+
+BOOST_FIXTURE_TEST_CASE( shared_prefixes_match_single_determinants, ExtractFixture )
+{
+    std::vector<double> batch = extract_coefficients(mps, dets);
+
+    BOOST_REQUIRE_EQUAL(batch.size(), dets.size());
+    double norm = 0;
+    for (std::size_t i = 0; i < dets.size(); ++i) {
+        double single = extract_coefficient(mps, dets[i]);
+        BOOST_CHECK_SMALL(batch[i] - single, 1e-12);
+        norm += single * single;
+    }
+    // the determinants span the whole sector of a normalized state
+    BOOST_CHECK_CLOSE(norm, 1., 1e-8);
+}
+
+// unsorted input with repeated determinants comes back in input order
+BOOST_FIXTURE_TEST_CASE( input_order_is_kept, ExtractFixture )
+{
+    std::vector<std::vector<charge> > shuffled = dets;
+    shuffled.insert(shuffled.end(), dets.begin(), dets.begin() + dets.size()/2);
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(3));
+
+    std::vector<double> batch = extract_coefficients(mps, shuffled);
+    for (std::size_t i = 0; i < shuffled.size(); ++i)
+        BOOST_CHECK_SMALL(batch[i] - extract_coefficient(mps, shuffled[i]), 1e-12);
+}
+
+// one extractor serving a sequence of queries, as in the CI-DEAS sampler
+BOOST_FIXTURE_TEST_CASE( extractor_reuses_prefixes, ExtractFixture )
+{
+    ci_extractor<matrix, SymmGroup> coefficient(mps);
+    for (std::size_t i = 0; i < dets.size(); i += 3) {
+        std::size_t j = dets.size() - 1 - i;
+        BOOST_CHECK_SMALL(coefficient(dets[i]) - extract_coefficient(mps, dets[i]), 1e-12);
+        BOOST_CHECK_SMALL(coefficient(dets[j]) - extract_coefficient(mps, dets[j]), 1e-12);
+    }
+}
+
+// a determinant through a charge or a sector the MPS does not have has coefficient zero,
+// and the prefixes shared with the following determinants stay valid
+BOOST_FIXTURE_TEST_CASE( missing_sectors_give_zero, ExtractFixture )
+{
+    // (2,0) is not a charge of the physical index
+    std::vector<std::vector<charge> > queries = dets;
+    std::vector<charge> absent(L, make_charge(0,0));
+    absent[0] = make_charge(2,0);
+    absent[1] = make_charge(1,1);
+    absent[2] = make_charge(0,1);
+    queries.push_back(absent);
+
+    // drop the first block of site 3, the determinants through that sector disappear
+    MPS<matrix, SymmGroup> reduced = mps;
+    reduced[3].make_left_paired();
+    charge dropped = reduced[3].data().basis().left_charge(0);
+    reduced[3].data().remove_block(std::size_t(0));
+
+    std::vector<double> batch = extract_coefficients(reduced, queries);
+
+    BOOST_REQUIRE_EQUAL(batch.size(), queries.size());
+    BOOST_CHECK_EQUAL(batch.back(), 0.);
+    std::size_t zeros = 0;
+    for (std::size_t i = 0; i < dets.size(); ++i) {
+        charge prefix = std::accumulate(dets[i].begin(), dets[i].begin() + 4, SymmGroup::IdentityCharge);
+        if (prefix == dropped) {
+            BOOST_CHECK_EQUAL(batch[i], 0.);
+            ++zeros;
+        }
+        else
+            BOOST_CHECK_SMALL(batch[i] - extract_coefficient(mps, dets[i]), 1e-12);
+    }
+    BOOST_CHECK(zeros > 0);
+}
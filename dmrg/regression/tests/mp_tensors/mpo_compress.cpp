@@ -0,0 +1,305 @@
+/*****************************************************************************
+ *
+ * ALPS MPS DMRG Project
+ *
+ * Copyright (C) 2014 Institute for Theoretical Physics, ETH Zurich
+ *
+ * This software is part of the ALPS Applications, published under the ALPS
+ * Application License; you can use, redistribute it and/or modify it under
+ * the terms of the license, either version 1 or (at your option) any later
+ * version.
+ *
+ * You should have received a copy of the ALPS Application License along with
+ * the ALPS Applications; see the file LICENSE.txt. If not, the license is also
+ * available from http://alps.comp-phys.org/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#define BOOST_TEST_MAIN
+
+#include <boost/test/included/unit_test.hpp>
+#include <boost/test/floating_point_comparison.hpp>
+
+#include <iostream>
+
+#include "dmrg/block_matrix/detail/alps.hpp"
+
+#include "dmrg/utils/DmrgParameters.h"
+
+#include "dmrg/models/generate_mpo.hpp"
+#include "dmrg/models/lattice.h"
+#include "dmrg/models/model.h"
+
+#include "dmrg/block_matrix/indexing.h"
+#include "dmrg/mp_tensors/mps.h"
+#include "dmrg/mp_tensors/mpo.h"
+#include "dmrg/mp_tensors/mpo_ops.h"
+#include "dmrg/mp_tensors/mps_initializers.h"
+#include "dmrg/mp_tensors/mps_mpo_ops.h"
+
+#include "../random_integrals.h"
+
+typedef U1 SymmGroup;
+typedef alps::numeric::matrix<double> matrix;
+typedef operator_selector<matrix, SymmGroup>::type op_t;
+typedef OPTable<matrix, SymmGroup>::tag_type tag_type;
+typedef MPOTensor<matrix, SymmGroup>::prempo_t prempo_type;
+typedef prempo_type::value_type prempo_element;
+
+/// H = sum_{i<j} n_i n_j + 1/2 (b+_i b_j + b_i b+_j) for hard-core bosons, built with
+/// a separate channel for every left site i: the bond dimension grows as 2 + 3b although
+/// the operator only needs 5 states on any bond
+MPO<matrix, SymmGroup> naive_mpo(int L, Index<SymmGroup> const & phys)
+{
+    op_t ident = identity_matrix<op_t>(phys), dens, create, destroy;
+    dens.insert_block(matrix(1,1,1.), 1, 1);
+    create.insert_block(matrix(1,1,1.), 1, 0);
+    destroy.insert_block(matrix(1,1,1.), 0, 1);
+
+    boost::shared_ptr<OPTable<matrix, SymmGroup> > op_table(new OPTable<matrix, SymmGroup>());
+    tag_type ident_tag = op_table->register_op(ident);
+    tag_type open[3] = { op_table->register_op(dens), op_table->register_op(create), op_table->register_op(destroy) };
+    tag_type close[3] = { open[0], open[2], open[1] };
+    double coeff[3] = { 1., 0.5, 0.5 };
+
+    MPO<matrix, SymmGroup> mpo(L);
+    for (int b = 0; b < L; ++b) {
+        bool last = (b == L-1);
+        int rows = (b == 0) ? 1 : 2 + 3*b;
+        int cols = last ? 1 : 2 + 3*(b+1);
+        int done = last ? 0 : 1;
+
+        prempo_type terms;
+        if (!last)
+            terms.push_back(prempo_element(0, 0, ident_tag, 1.));
+        if (b > 0)
+            terms.push_back(prempo_element(1, done, ident_tag, 1.));
+        for (int k = 0; k < 3; ++k) {
+            if (!last)
+                terms.push_back(prempo_element(0, 2+3*b+k, open[k], 1.));
+            for (int i = 0; i < b; ++i) {
+                if (!last)
+                    terms.push_back(prempo_element(2+3*i+k, 2+3*i+k, ident_tag, 1.));
+                terms.push_back(prempo_element(2+3*i+k, done, close[k], coeff[k]));
+            }
+        }
+        mpo[b] = MPOTensor<matrix, SymmGroup>(rows, cols, terms, op_table);
+    }
+    return mpo;
+}
+
+struct CompressFixture
+{
+    CompressFixture() : L(6)
+    {
+        phys.insert(std::make_pair(0, 1));
+        phys.insert(std::make_pair(1, 1));
+
+        DmrgParameters parms;
+        parms.set("max_bond_dimension", 8);
+        default_mps_init<matrix, SymmGroup> initializer(parms, std::vector<Index<SymmGroup> >(1, phys),
+                                                         L/2, std::vector<int>(L,0));
+        mps.resize(L);
+        initializer(mps);
+        mps.normalize_left();
+
+        mpo = naive_mpo(L, phys);
+    }
+
+    int L;
+    Index<SymmGroup> phys;
+    MPS<matrix, SymmGroup> mps;
+    MPO<matrix, SymmGroup> mpo;
+};
+
+BOOST_FIXTURE_TEST_CASE( compress_keeps_expectation_value, CompressFixture )
+{
+    double before = maquis::real(expval(mps, mpo));
+
+    MPO<matrix, SymmGroup> mpoc = mpo;
+    mpoc.compress(1e-12);
+
+    BOOST_CHECK_CLOSE(before, maquis::real(expval(mps, mpoc)), 1e-8);
+    for (int p = 1; p < L; ++p) {
+        BOOST_CHECK(mpoc[p].row_dim() <= 5);
+        BOOST_CHECK(mpoc[p].row_dim() == mpoc[p-1].col_dim());
+        // the naive construction carries 2 + 3p channels on bond p
+        if (p > 1)
+            BOOST_CHECK(mpoc[p].row_dim() < mpo[p].row_dim());
+    }
+}
+
+// entries equal up to a scale share one operator of the compressed MPO
+BOOST_FIXTURE_TEST_CASE( compress_shares_operator_tags, CompressFixture )
+{
+    MPO<matrix, SymmGroup> mpoc = mpo;
+    mpoc.compress(1e-12);
+
+    std::size_t entries = 0;
+    for (int p = 0; p < L; ++p) {
+        BOOST_CHECK(mpoc[p].get_operator_table() == mpoc[0].get_operator_table());
+        for (std::size_t r = 0; r < mpoc[p].row_dim(); ++r)
+            for (std::size_t c = 0; c < mpoc[p].col_dim(); ++c)
+                entries += mpoc[p].has(r,c);
+    }
+    BOOST_CHECK(mpoc[0].get_operator_table()->size() < entries);
+}
+
+BOOST_FIXTURE_TEST_CASE( compress_twice_is_stable, CompressFixture )
+{
+    MPO<matrix, SymmGroup> mpoc = mpo;
+    mpoc.compress(1e-12);
+    std::vector<std::size_t> dims;
+    for (int p = 1; p < L; ++p)
+        dims.push_back(mpoc[p].row_dim());
+
+    double once = maquis::real(expval(mps, mpoc));
+    mpoc.compress(1e-12);
+
+    BOOST_CHECK_CLOSE(once, maquis::real(expval(mps, mpoc)), 1e-8);
+    for (int p = 1; p < L; ++p)
+        BOOST_CHECK_EQUAL(mpoc[p].row_dim(), dims[p-1]);
+}
+
+// entries of the squared MPO carry their coefficient in the operator, not in the scale
+BOOST_FIXTURE_TEST_CASE( compress_squared_mpo, CompressFixture )
+{
+    MPO<matrix, SymmGroup> sq = square_mpo(mpo);
+    double before = maquis::real(expval(mps, sq));
+
+    sq.compress(1e-12);
+
+    BOOST_CHECK_CLOSE(before, maquis::real(expval(mps, sq)), 1e-8);
+    for (int p = 1; p < L; ++p)
+        BOOST_CHECK(sq[p].row_dim() <= 25);
+}
+
+/// Quantum chemistry Hamiltonian with spin adaptation, compressed by merging parallel bond indices
+struct SU2CompressFixture
+{
+    typedef SU2U1 grp;
+
+    SU2CompressFixture() : L(6)
+    {
+        parms.set("max_bond_dimension", 16);
+        parms.set("LATTICE", "orbitals");
+        parms.set("MODEL", "quantum_chemistry");
+        parms.set("L", L);
+        parms.set("nelec", L);
+        parms.set("spin", 0);
+        parms.set("irrep", 0);
+        parms.set("site_types", "0,0,0,0,0,0");
+        parms.set("integrals", random_integrals(L, 11));
+        parms.set("mpo_construction", "tagged");
+
+        Lattice lat(parms);
+        Model<matrix, grp> model(lat, parms);
+        mpo = make_mpo(lat, model, parms);
+        mps = MPS<matrix, grp>(L, *(model.initializer(lat, parms)));
+    }
+
+    int L;
+    DmrgParameters parms;
+    MPS<matrix, grp> mps;
+    MPO<matrix, grp> mpo;
+};
+
+BOOST_FIXTURE_TEST_CASE( su2_compress_keeps_expectation_value, SU2CompressFixture )
+{
+    double before = maquis::real(expval(mps, mpo));
+
+    MPO<matrix, grp> mpoc = mpo;
+    mpoc.compress(1e-12);
+
+    BOOST_CHECK_CLOSE(before, maquis::real(expval(mps, mpoc)), 1e-8);
+    for (int p = 1; p < L; ++p) {
+        BOOST_CHECK(mpoc[p].row_dim() <= mpo[p].row_dim());
+        BOOST_CHECK(mpoc[p].row_dim() == mpoc[p-1].col_dim());
+        BOOST_CHECK(mpoc[p].leftBond().size() == mpoc[p].row_dim());
+    }
+}
+
+// copy column c of W[p-1] into a new bond index and split row c of W[p] evenly between the two:
+// the operator is unchanged, the new bond index is redundant by construction
+template <class Matrix, class SymmGroup>
+MPO<Matrix, SymmGroup> duplicate_bond(MPO<Matrix, SymmGroup> const & mpo, std::size_t p, std::size_t c)
+{
+    typedef MPOTensor<Matrix, SymmGroup> tensor_t;
+    typedef typename tensor_t::prempo_t prempo_t;
+    typedef typename tensor_t::BondProperty bond_t;
+
+    MPO<Matrix, SymmGroup> ret = mpo;
+    tensor_t const & W = mpo[p-1], & X = mpo[p];
+    std::size_t D = W.col_dim();
+
+    prempo_t w_terms, x_terms;
+    for (std::size_t r = 0; r < W.row_dim(); ++r)
+        for (std::size_t b = 0; b < D; ++b) {
+            if (!W.has(r,b)) continue;
+            MPOTensor_detail::term_descriptor<Matrix, SymmGroup, true> term = W.at(r,b);
+            for (std::size_t k = 0; k < term.size(); ++k) {
+                w_terms.push_back(boost::make_tuple(r, b, W.tag_number(r,b,k), term.scale(k)));
+                if (b == c)
+                    w_terms.push_back(boost::make_tuple(r, D, W.tag_number(r,b,k), term.scale(k)));
+            }
+        }
+    for (std::size_t b = 0; b < D; ++b)
+        for (std::size_t s = 0; s < X.col_dim(); ++s) {
+            if (!X.has(b,s)) continue;
+            MPOTensor_detail::term_descriptor<Matrix, SymmGroup, true> term = X.at(b,s);
+            for (std::size_t k = 0; k < term.size(); ++k) {
+                double f = (b == c) ? 0.5 : 1.;
+                x_terms.push_back(boost::make_tuple(b, s, X.tag_number(b,s,k), f * term.scale(k)));
+                if (b == c)
+                    x_terms.push_back(boost::make_tuple(D, s, X.tag_number(b,s,k), f * term.scale(k)));
+            }
+        }
+
+    bond_t bond(D+1);
+    for (std::size_t b = 0; b < D; ++b)
+        bond.spins()[b] = W.rightBond().spin(b);
+    bond.spins()[D] = W.rightBond().spin(c);
+
+    ret[p-1] = tensor_t(W.row_dim(), D+1, w_terms, W.get_operator_table(), W.leftBond(), bond);
+    ret[p] = tensor_t(D+1, X.col_dim(), x_terms, X.get_operator_table(), bond, X.rightBond());
+    return ret;
+}
+
+BOOST_FIXTURE_TEST_CASE( su2_compress_folds_duplicated_bond, SU2CompressFixture )
+{
+    std::size_t p = L/2;
+    MPO<matrix, grp> dup = duplicate_bond(mpo, p, mpo[p].row_dim()-1);
+    double before = maquis::real(expval(mps, mpo));
+    BOOST_CHECK_CLOSE(before, maquis::real(expval(mps, dup)), 1e-8);
+    std::size_t dup_dim = dup[p].row_dim();
+
+    dup.compress(1e-12);
+
+    BOOST_CHECK_CLOSE(before, maquis::real(expval(mps, dup)), 1e-8);
+    BOOST_CHECK(dup[p].row_dim() < dup_dim);
+    BOOST_CHECK(dup[p].row_dim() <= mpo[p].row_dim());
+}
+
+BOOST_FIXTURE_TEST_CASE( su2_compress_twice_is_stable, SU2CompressFixture )
+{
+    MPO<matrix, grp> mpoc = mpo;
+    mpoc.compress(1e-12);
+    std::vector<std::size_t> dims;
+    for (int p = 1; p < L; ++p)
+        dims.push_back(mpoc[p].row_dim());
+
+    double once = maquis::real(expval(mps, mpoc));
+    mpoc.compress(1e-12);
+
+    BOOST_CHECK_CLOSE(once, maquis::real(expval(mps, mpoc)), 1e-8);
+    for (int p = 1; p < L; ++p)
+        BOOST_CHECK_EQUAL(mpoc[p].row_dim(), dims[p-1]);
+}
@@ -45,6 +45,7 @@ using std::endl;
 #include "dmrg/mp_tensors/mps.h"
 #include "dmrg/mp_tensors/mps_initializers.h"
 #include "dmrg/mp_tensors/mps_mpo_ops.h"
+#include "dmrg/mp_tensors/expval_cache.h"
 #include "dmrg/models/generate_mpo.hpp"
 #include "dmrg/models/coded/lattice.hpp"
 
@@ -150,3 +151,45 @@ BOOST_AUTO_TEST_CASE( obs_bosons_nmax2 )
     }
     
 }
+
+// a local density on every site of the chain, evaluated from a shared cache of left boundaries
+BOOST_AUTO_TEST_CASE( expval_cache_bounded )
+{
+    typedef operator_selector<matrix, SymmGroup>::type op_t;
+    typedef MPOTensor<matrix, SymmGroup>::prempo_t prempo_t;
+
+    int L = 10;
+    DmrgParameters parms;
+    parms.set("max_bond_dimension", 20);
+
+    Index<SymmGroup> phys;
+    phys.insert(std::make_pair(0, 1));
+    phys.insert(std::make_pair(1, 1));
+    phys.insert(std::make_pair(2, 1));
+
+    op_t densop;
+    densop.insert_block(matrix(1,1,1), 1,1);
+    densop.insert_block(matrix(1,1,2), 2,2);
+    op_t ident = identity_matrix<op_t>(phys);
+
+    default_mps_init<matrix, SymmGroup> initializer(parms, std::vector<Index<SymmGroup> >(1, phys), L/2, std::vector<int>(L,0));
+    MPS<matrix,SymmGroup> mps;
+    mps.resize(L); initializer(mps);
+    mps.normalize_left();
+
+    // all MPOs share one operator table, so equal tensors are recognised by the cache
+    boost::shared_ptr<OPTable<matrix, SymmGroup> > op_table(new OPTable<matrix, SymmGroup>());
+    MPOTensor<matrix, SymmGroup> id_tensor(1, 1, prempo_t(1, boost::make_tuple(0, 0, op_table->register_op(ident), 1.)), op_table);
+    MPOTensor<matrix, SymmGroup> dens_tensor(1, 1, prempo_t(1, boost::make_tuple(0, 0, op_table->register_op(densop), 1.)), op_table);
+
+    expval_cache<matrix, SymmGroup> full(mps, mps), tight(mps, mps, false, 0);
+    for (int q = L-1; q >= 0; --q) {
+        MPO<matrix, SymmGroup> mpo(L, id_tensor);
+        mpo[q] = dens_tensor;
+
+        double ref = maquis::real(expval(mps, mpo));
+        BOOST_CHECK_CLOSE(ref, maquis::real(full(mpo)), 1e-8);
+        BOOST_CHECK_CLOSE(ref, maquis::real(tight(mpo)), 1e-8);
+    }
+    BOOST_CHECK(tight.size_in_bytes() < full.size_in_bytes());
+}
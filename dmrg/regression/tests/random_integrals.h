@@ -0,0 +1,73 @@
+/*****************************************************************************
+ *
+ * ALPS MPS DMRG Project
+ *
+ * Copyright (C) 2014 Institute for Theoretical Physics, ETH Zurich
+ *
+ * This software is part of the ALPS Applications, published under the ALPS
+ * Application License; you can use, redistribute it and/or modify it under
+ * the terms of the license, either version 1 or (at your option) any later
+ * version.
+ *
+ * You should have received a copy of the ALPS Application License along with
+ * the ALPS Applications; see the file LICENSE.txt. If not, the license is also
+ * available from http://alps.comp-phys.org/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#ifndef REGRESSION_RANDOM_INTEGRALS_H
+#define REGRESSION_RANDOM_INTEGRALS_H
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+/// Random integrals in the packed binary format of the "integrals" parameter
+/// (chem::detail::parse_buffer): all elements, then 4 indices per element.
+/// A fraction density of the off-diagonal two-electron integrals (ij|kl) is kept,
+/// which sets the MPO bond dimension.
+inline std::string random_integrals(int L, int seed, double density = 1.)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> dist(-0.5, 0.5), coin(0., 1.);
+
+    std::vector<double> elements;
+    std::vector<int> indices;
+    auto add = [&](double v, int i, int j, int k, int l) {
+        elements.push_back(v);
+        indices.push_back(i); indices.push_back(j); indices.push_back(k); indices.push_back(l);
+    };
+
+    for (int i = 1; i <= L; ++i)
+    for (int j = 1; j <= i; ++j)
+    for (int k = 1; k <= i; ++k)
+    for (int l = 1; l <= (k == i ? j : k); ++l)
+    {
+        bool diagonal = (i == j && k == l);
+        if (!diagonal && density < 1. && coin(rng) >= density)
+            continue;
+        add(diagonal ? 1. + dist(rng) : 0.1 * dist(rng), i, j, k, l);
+    }
+
+    for (int i = 1; i <= L; ++i)
+        for (int j = 1; j <= i; ++j)
+            add(i == j ? -2. + dist(rng) : dist(rng), i, j, 0, 0);
+
+    add(1., 0, 0, 0, 0);
+
+    std::string ret(elements.size() * sizeof(double) + indices.size() * sizeof(int), '\0');
+    std::memcpy(&ret[0], &elements[0], elements.size() * sizeof(double));
+    std::memcpy(&ret[elements.size() * sizeof(double)], &indices[0], indices.size() * sizeof(int));
+    return ret;
+}
+
+#endif
@@ -0,0 +1,214 @@
+/*****************************************************************************
+ *
+ * ALPS MPS DMRG Project
+ *
+ * Copyright (C) 2026 Department of Chemistry and the PULSE Institute, Stanford University
+ *                    Laboratory for Physical Chemistry, ETH Zurich
+ *
+ * This software is part of the ALPS Applications, published under the ALPS
+ * Application License; you can use, redistribute it and/or modify it under
+ * the terms of the license, either version 1 or (at your option) any later
+ * version.
+ *
+ * You should have received a copy of the ALPS Application License along with
+ * the ALPS Applications; see the file LICENSE.txt. If not, the license is also
+ * available from http://alps.comp-phys.org/.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+ * SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+ * FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ *
+ *****************************************************************************/
+
+#define BOOST_TEST_MAIN
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <complex>
+
+#include "dmrg/solver/lanczos_expm.h"
+
+typedef std::vector<double> dense_matrix; // column major, n x n
+
+/// Minimal vector with the interface lanczos_expm expects from DavidsonVector
+struct Vec
+{
+    Vec(std::size_t n = 0) : x(n, 0.) {}
+
+    double scalar_norm() const { return std::sqrt(scalar_overlap(*this)); }
+    double scalar_overlap(Vec const & rhs) const
+    {
+        double r = 0.;
+        for (std::size_t i = 0; i < x.size(); ++i) r += x[i] * rhs.x[i];
+        return r;
+    }
+
+    Vec & operator+=(Vec const & rhs) { for (std::size_t i = 0; i < x.size(); ++i) x[i] += rhs.x[i]; return *this; }
+    Vec & operator-=(Vec const & rhs) { for (std::size_t i = 0; i < x.size(); ++i) x[i] -= rhs.x[i]; return *this; }
+    Vec & operator/=(double a) { for (std::size_t i = 0; i < x.size(); ++i) x[i] /= a; return *this; }
+
+    std::vector<double> x;
+};
+
+Vec operator*(double a, Vec v) { for (std::size_t i = 0; i < v.x.size(); ++i) v.x[i] *= a; return v; }
+Vec operator/(Vec v, double a) { v /= a; return v; }
+
+struct DenseMV
+{
+    DenseMV(dense_matrix const & m_, std::size_t n_) : m(m_), n(n_) {}
+
+    Vec operator()(Vec const & v) const
+    {
+        Vec r(n);
+        for (std::size_t j = 0; j < n; ++j)
+            for (std::size_t i = 0; i < n; ++i)
+                r.x[i] += m[i + j*n] * v.x[j];
+        return r;
+    }
+
+    dense_matrix const & m;
+    std::size_t n;
+};
+
+template <class T>
+std::vector<T> matmul(std::vector<T> const & a, std::vector<T> const & b, std::size_t n)
+{
+    std::vector<T> r(n*n, T(0.));
+    for (std::size_t j = 0; j < n; ++j)
+        for (std::size_t k = 0; k < n; ++k)
+            for (std::size_t i = 0; i < n; ++i)
+                r[i + j*n] += a[i + k*n] * b[k + j*n];
+    return r;
+}
+
+/// exp(A) by scaling and squaring of the Taylor series, independent of the Lanczos code
+template <class T>
+std::vector<T> dense_expm(std::vector<T> a, std::size_t n)
+{
+    double norm = 0.;
+    for (std::size_t i = 0; i < a.size(); ++i) norm = std::max(norm, std::abs(a[i]));
+    int squarings = std::max(0, int(std::ceil(std::log2(norm * n))) + 4);
+    for (std::size_t i = 0; i < a.size(); ++i) a[i] /= std::pow(2., squarings);
+
+    std::vector<T> ret(n*n, T(0.)), term(n*n, T(0.));
+    for (std::size_t i = 0; i < n; ++i) ret[i + i*n] = term[i + i*n] = T(1.);
+    for (int k = 1; k < 30; ++k) {
+        term = matmul(term, a, n);
+        for (std::size_t i = 0; i < term.size(); ++i) {
+            term[i] /= double(k);
+            ret[i] += term[i];
+        }
+    }
+    for (int s = 0; s < squarings; ++s)
+        ret = matmul(ret, ret, n);
+    return ret;
+}
+
+struct RandomProblem
+{
+    RandomProblem(std::size_t n_) : n(n_), h(n*n), v(n)
+    {
+        std::mt19937 gen(42);
+        std::uniform_real_distribution<double> dist(-1., 1.);
+        for (std::size_t j = 0; j < n; ++j)
+            for (std::size_t i = 0; i <= j; ++i)
+                h[i + j*n] = h[j + i*n] = dist(gen) / std::sqrt(double(n));
+        for (std::size_t i = 0; i < n; ++i)
+            v.x[i] = dist(gen);
+    }
+
+    std::size_t n;
+    dense_matrix h;
+    Vec v;
+};
+
+BOOST_AUTO_TEST_CASE( imaginary_time_matches_dense_expm )
+{
+    RandomProblem p(40);
+    double tau = 0.8;
+
+    Vec res = p.v;
+    int krylov_dim;
+    double energy = lanczos_expm(DenseMV(p.h, p.n), res, tau, false, 1e-13, 40, krylov_dim);
+
+    Vec hv = DenseMV(p.h, p.n)(p.v);
+    BOOST_CHECK_CLOSE(energy, p.v.scalar_overlap(hv) / p.v.scalar_overlap(p.v), 1e-8);
+
+    dense_matrix mh(p.h);
+    for (std::size_t i = 0; i < mh.size(); ++i) mh[i] *= -tau;
+    Vec ref = DenseMV(dense_expm(mh, p.n), p.n)(p.v);
+    ref /= ref.scalar_norm();
+
+    BOOST_CHECK(krylov_dim < 40);
+    for (std::size_t i = 0; i < p.n; ++i)
+        BOOST_CHECK_SMALL(res.x[i] - ref.x[i], 1e-9);
+}
+
+// the state (R, I) stands for R + iI, the generator K = [[0, H], [-H, 0]] for -iH
+BOOST_AUTO_TEST_CASE( real_time_matches_dense_expm )
+{
+    RandomProblem p(30);
+    std::size_t n = p.n, n2 = 2*n;
+    double t = 1.3;
+
+    dense_matrix k(n2*n2, 0.);
+    for (std::size_t j = 0; j < n; ++j)
+        for (std::size_t i = 0; i < n; ++i) {
+            k[i + (j+n)*n2] =  p.h[i + j*n];
+            k[(i+n) + j*n2] = -p.h[i + j*n];
+        }
+
+    // complex initial state with both parts set
+    Vec res(n2);
+    std::vector<std::complex<double> > psi(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        res.x[i] = p.v.x[i];
+        res.x[i+n] = p.v.x[n-1-i];
+        psi[i] = std::complex<double>(res.x[i], res.x[i+n]);
+    }
+    double norm = res.scalar_norm();
+
+    int krylov_dim;
+    double alpha0 = lanczos_expm(DenseMV(k, n2), res, t, true, 1e-13, 60, krylov_dim);
+    BOOST_CHECK_SMALL(alpha0, 1e-12);
+
+    std::vector<std::complex<double> > mh(n*n);
+    for (std::size_t i = 0; i < mh.size(); ++i) mh[i] = std::complex<double>(0., -t) * p.h[i];
+    std::vector<std::complex<double> > u = dense_expm(mh, n);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        std::complex<double> ref(0.);
+        for (std::size_t j = 0; j < n; ++j)
+            ref += u[i + j*n] * psi[j];
+        ref /= norm;
+        BOOST_CHECK_SMALL(res.x[i]   - ref.real(), 1e-9);
+        BOOST_CHECK_SMALL(res.x[i+n] - ref.imag(), 1e-9);
+    }
+}
+
+// a Krylov space of the full dimension is invariant, the result is exact up to rounding
+BOOST_AUTO_TEST_CASE( full_krylov_space_is_exact )
+{
+    RandomProblem p(6);
+    double tau = 2.;
+
+    Vec res = p.v;
+    int krylov_dim;
+    lanczos_expm(DenseMV(p.h, p.n), res, tau, false, 1e-14, 6, krylov_dim);
+    BOOST_CHECK_EQUAL(krylov_dim, 6);
+
+    dense_matrix mh(p.h);
+    for (std::size_t i = 0; i < mh.size(); ++i) mh[i] *= -tau;
+    Vec ref = DenseMV(dense_expm(mh, p.n), p.n)(p.v);
+    ref /= ref.scalar_norm();
+
+    for (std::size_t i = 0; i < p.n; ++i)
+        BOOST_CHECK_SMALL(res.x[i] - ref.x[i], 1e-11);
+}